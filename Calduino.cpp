@@ -1,2663 +1,5170 @@
-/*
-* Copyright (c) 2018 Daniel Macas Perea (dani.macias.perea@gmail.com)
-*
-* Permission is hereby granted, free of charge, to any person obtaining a copy
-* of this software and associated documentation files (the "Software"), to deal
-* in the Software without restriction, including without limitation the rights
-* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-* copies of the Software, and to permit persons to whom the Software is
-* furnished to do so, subject to the following conditions:
-*
-* The above copyright notice and this permission notice shall be included in all
-* copies or substantial portions of the Software.
-*
-* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-* SOFTWARE.
-*
-* Legal Notices
-* 'Bosch Group', 'Buderus', 'Nefit' and 'Worcester' are brands of Bosch Thermotechnology.
-* All other trademarks are the property of their respective owners.
-*/
-
-
-/**
-* @mainpage EMS Bus - Arduino library.
-*
-* This library provides functions to communicate through the EMS Bus with Buderus/Nefit/Worcester
-* (or any other EMS Bus compatible) boilers. It includes commands for both getting status information
-* (UBA Monitor, DHW Monitor, etc.) and setting new configurations (Set Day/Night Temperature,
-* Set Working Mode, etc.).
-*
-* @author	dani.macias.perea@gmail.com
-*/
-
-/**
-* @file Calduino.cpp
-* 		
-* @brief The Calduino class declaration including EMSSerial, CalduinoDebug, CalduinoSerial, Calduino Datagrams and Calduino Data Types.
-*
-*/
-
-#include "wiring_private.h"
-#include "Calduino.h"
-
-/* EMS max/min values and constants */
-#define MAX_HC_CIRCUIT 2
-#define MAX_WORKING_MODE 2
-#define MAX_SETBACK_MODE 3
-#define MAX_PROGRAM 10
-#define MAX_DHW_TEMPERATURE 80
-#define MIN_DHW_TEMPERATURE 40
-#define MAX_TEMPERATURE 29
-#define MIN_TEMPERATURE 6
-#define MAX_ROOM_TEMPERATURE_OFFSET 5
-#define MIN_ROOM_TEMPERATURE_OFFSET -5
-#define MAX_SUMMER_WINTER_THRESHOLD 30
-#define MIN_SUMMER_WINTER_THRESHOLD 10
-#define MAX_OUT_NIGHT_THRESHOLD 10
-#define MIN_OUT_NIGHT_THRESHOLD -20
-#define DHW_ONETIME_ON  39
-#define DHW_ONETIME_OFF 7
-#define SWITCHING_POINTS 42
-#define MAX_DAY 31
-#define MAX_DAY_WEEK 7
-#define MAX_MONTH 12
-#define MAX_HOUR_DAY 24
-#define MAX_MINUTE_HOUR 60
-
-/* EMS Bus Serial Parameters */
-#define INITIAL_OFFSET 4
-#define OUT_EMS_BUFFER_SIZE 7
-#define TEXT_BUFFER_SIZE 40
-#define EMS_DATAGRAM_OVERHEAD 6
-#define EMS_MAX_WAIT_TIME 1000
-#define RETRY_FACTOR 4
-
-/* Message size*/
-#define RC_DATETIME_VALUES_COUNT 6
-#define RC_DATETIME_MESSAGE_SIZE 8
-#define UBA_WORKING_TIME_VALUES_COUNT 1
-#define UBA_WORKING_TIME_MESSAGE_SIZE 3
-#define UBA_MONITOR_FAST_VALUES_COUNT 16
-#define UBA_MONITOR_FAST_MESSAGE_SIZE 27
-#define UBA_MONITOR_SLOW_VALUES_COUNT 6
-#define UBA_MONITOR_SLOW_MESSAGE_SIZE 25
-#define UBA_PARAMETER_DHW_VALUES_COUNT 2
-#define UBA_PARAMETER_DHW_MESSAGE_SIZE 11
-#define FLAGS_DHW_VALUES_COUNT 1
-#define FLAGS_DHW_MESSAGE_SIZE 1
-#define UBA_MONITOR_DHW_VALUES_COUNT 7
-#define UBA_MONITOR_DHW_MESSAGE_SIZE 16
-#define WORKING_MODE_DHW_VALUES_COUNT 7
-#define WORKING_MODE_DHW_MESSAGE_SIZE 10
-#define WORKING_MODE_HC_VALUES_COUNT 9
-#define WORKING_MODE_HC_MESSAGE_SIZE 42
-#define MONITOR_HC_VALUES_COUNT 5
-#define MONITOR_HC_MESSAGE_SIZE 16
-#define MONITOR_MM_10_VALUES_COUNT 3
-#define MONITOR_MM_10_MESSAGE_SIZE 8
-#define SWITCHING_PROGRAM_1_VALUES_COUNT 57
-#define SWITCHING_PROGRAM_1_MESSAGE_SIZE 99
-#define SWITCHING_PROGRAM_2_VALUES_COUNT 42
-#define SWITCHING_PROGRAM_2_MESSAGE_SIZE 84
-
-/** EMSSerial definition */
-#pragma region EMSSERIAL
-
-// on ATmega8, the uart and its bits are not numbered, so there is no "TXC0"
-// definition.
-#if !defined(TXC0)
-#if defined(TXC)
-#define TXC0 TXC
-#elif defined(TXC1)
-// Some devices have uart1 but no uart0
-#define TXC0 TXC1
-#else
-#error TXC0 not definable in Calduino.h
-#endif
-#endif
-
-
-/**
- * Stores a character in the EMS Serial Buffer.
- * This operation is called when a serial event is triggered
- *
- * @author	Administrator
- * @date	5/2/2018
- *
- * @param 		  	c 	Byte received.
- * @param 		  	fe	Wether the bit error is activated or not.
- * @param [in,out]	s 	The EMS Serial stream.
- */
-
-inline void store_char(unsigned char c, bool fe, EMSSerial *s)
-{
-	int i = (unsigned int)(s->_rx_buffer_head + 1) % SERIAL_BUFFER_SIZE;
-
-	// if we should be storing the received character into the location
-	// just before the tail (meaning that the head would advance to the
-	// current location of the tail), we're about to overflow the buffer
-	// and so we don't write the character or advance the head.
-	if (i != s->_rx_buffer_tail) {
-		s->_rx_buffer[s->_rx_buffer_head] = c;
-		s->_error_flag[s->_rx_buffer_head] = fe;
-		s->_rx_buffer_head = i;
-	}
-}
-
-#if !defined(USART0_RX_vect) && defined(USART1_RX_vect)
-// do nothing - on the 32u4 the first USART is USART1
-#else
-#if !defined(USART_RX_vect) && !defined(USART0_RX_vect) && \
-	!defined(USART_RXC_vect)
-#error "Don't know what the Data Received vector is called for the first UART"
-#else
-/** Ems serial event 0 */
-void EMSSerialEvent0() __attribute__((weak));
-/** Ems serial event 0 */
-void EMSSerialEvent0() {}
-#define EMSSerialEvent0_implemented
-#if defined(USART_RX_vect)
-ISR(USART_RX_vect)
-#elif defined(USART0_RX_vect)
-ISR(USART0_RX_vect)
-#elif defined(USART_RXC_vect)
-ISR(USART_RXC_vect) // ATmega8
-#endif
-{
-#if defined(UDR0)
-
-	bool fe = bitRead(UCSR0A, FE0);
-	unsigned char c = UDR0;
-	store_char(c, fe, &EMSSerial0);
-#elif defined(UDR)
-	bool fe = bitRead(UCSRA, FE);
-	unsigned char c = UDR;
-	store_char(c, fe, &EMSSerial0);
-
-#else
-#error UDR not defined
-#endif
-}
-#endif
-#endif
-
-#if defined(USART1_RX_vect)
-void EMSSerialEvent1() __attribute__((weak));
-void EMSSerialEvent1() {}
-#define EMSSerialEvent1_implemented
-ISR(USART1_RX_vect)
-{
-
-	bool fe = bitRead(UCSR1A, FE1);
-	unsigned char c = UDR1;
-
-	store_char(c, fe, &EMSSerial1);
-}
-#endif
-
-#if defined(USART2_RX_vect) && defined(UDR2)
-void EMSSerialEvent2() __attribute__((weak));
-void EMSSerialEvent2() {}
-#define EMSSerialEvent2_implemented
-ISR(USART2_RX_vect)
-{
-
-	bool fe = bitRead(UCSR2A, FE2);
-	unsigned char c = UDR2;
-
-	store_char(c, fe, &EMSSerial2);
-}
-#endif
-
-#if defined(USART3_RX_vect) && defined(UDR3)
-void EMSSerialEvent3() __attribute__((weak));
-void EMSSerialEvent3() {}
-#define EMSSerialEvent3_implemented
-ISR(USART3_RX_vect)
-{
-
-	bool fe = bitRead(UCSR3A, FE3);
-	unsigned char c = UDR3;
-
-	store_char(c, fe, &EMSSerial3);
-}
-#endif
-
-
-/**
- * EMS Serial event run
- *
- * @author	Administrator
- * @date	5/2/2018
- */
-
-void EMSSerialEventRun(void)
-{
-#ifdef EMSSerialEvent0_implemented
-	if (EMSSerial0.available()) EMSSerialEvent0();
-#endif
-#ifdef EMSSerialEvent1_implemented
-	if (EMSSerial1.available()) EMSSerialEvent1();
-#endif
-#ifdef EMSSerialEvent2_implemented
-	if (EMSSerial2.available()) EMSSerialEvent2();
-#endif
-#ifdef EMSSerialEvent3_implemented
-	if (EMSSerial3.available()) EMSSerialEvent3();
-#endif
-}
-
-
-/**
- * EMS Serial Constructor
- *
- * @param [in]	ubrrh	USART Baud Rate Register.
- * @param [in]	ubrrl	UBRRL contains the eight least significant bits of the USART baud rate.
- * @param [in]	ucsra	USART Control and Status Register A.
- * @param [in]	ucsrb	USART Control and Status Register B.
- * @param [in]	ucsrc	USART Control and Status Register C.
- * @param [in]	udr  	The transmit buffer.
- * @param 	  	rxen 	Receiver Enable.
- * @param 	  	txen 	Transmitter Enable.
- * @param 	  	rxcie	RX Complete Interrupt Enable.
- */
-
-EMSSerial::EMSSerial(
-	volatile uint8_t *ubrrh, volatile uint8_t *ubrrl,
-	volatile uint8_t *ucsra, volatile uint8_t *ucsrb,
-	volatile uint8_t *ucsrc, volatile uint8_t *udr,
-	uint8_t rxen, uint8_t txen, uint8_t rxcie)
-{
-	_rx_buffer_head = _rx_buffer_tail = 0;
-	_error = false;
-	_ubrrh = ubrrh;
-	_ubrrl = ubrrl;
-	_ucsra = ucsra;
-	_ucsrb = ucsrb;
-	_ucsrc = ucsrc;
-	_udr = udr;
-	_rxen = rxen;
-	_txen = txen;
-	_rxcie = rxcie;
-
-}
-
-
-/** Default constructor */
-
-EMSSerial::EMSSerial() {}
-
-
-/**
- * Start the communication with the EMS Bus  UART Interface Circuit
- *
- * @param	baud	- baud rate of the UART port.
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-bool EMSSerial::begin(unsigned long baud)
-{
-	uint16_t baud_setting;
-
-	*_ucsra = 0;
-	
-	_written = false;
-
-
-	baud_setting = (F_CPU / 8 / baud - 1) / 2;
-
-	// assign the baud_setting, ubbr (USART Baud Rate Register) and UBRRL (eight least significant
-	// bits of the USART baud rate). 
-	*_ubrrh = baud_setting >> 8;
-	*_ubrrl = baud_setting;
-
-	// set the bits in ucsrb port enabling reception, transmission and complete interrupt.
-	sbi(*_ucsrb, _rxen); 
-	sbi(*_ucsrb, _txen);
-	sbi(*_ucsrb, _rxcie);
-}
-
-
-/** Ends the EMS Serial communication */
-
-void EMSSerial::end()
-{
-	// clear the bits in ucsrb port disabling reception, transmission and complete interrupt.
-	cbi(*_ucsrb, _rxen); 
-	cbi(*_ucsrb, _txen);
-	cbi(*_ucsrb, _rxcie);
-	
-	// clear any received data
-	_rx_buffer_head = _rx_buffer_tail;
-}
-
-/**
- * Gets the bytes pending to be read
- *
- * @return	Available bytes in the EMS Serial Buffer.
- */
-
-int EMSSerial::available(void)
-{
-	return (unsigned int)(SERIAL_BUFFER_SIZE + _rx_buffer_head - _rx_buffer_tail) % SERIAL_BUFFER_SIZE;
-}
-
-
-/**
- * Returns the top-of-stack object without removing it, or -1 otherwise.
- *
- * @return	The current top-of-stack object. If there is no object, return -1.
- */
-
-int EMSSerial::peek(void)
-{
-	if (_rx_buffer_head == _rx_buffer_tail) {
-		return -1;
-	}
-	else {
-		return _rx_buffer[_rx_buffer_tail];
-	}
-}
-
-
-/**
- * Returns the top-of-stack object removing it.
- *
- * @return	The current top-of-stack object, if any. Return -1 otherwise.
- */
-
-int EMSSerial::read(void)
-{
-	// if the head isn't ahead of the tail, we don't have any characters
-	if (_rx_buffer_head == _rx_buffer_tail) {
-		return -1;
-	}
-	else {
-		unsigned char c = _rx_buffer[_rx_buffer_tail];
-		_error = _error_flag[_rx_buffer_tail];
-		_rx_buffer_tail = (unsigned int)(_rx_buffer_tail + 1) % SERIAL_BUFFER_SIZE;
-		return c;
-	}
-}
-
-
-/** Flushes the  EMS Serial by clearing the buffer contents */
-
-void EMSSerial::flush()
-{
-	// clear read buffer
-	_rx_buffer_head = _rx_buffer_tail;
-	_error = false;
-
-	// disable and enable reception in order to flush the receive buffer
-	cbi(*_ucsrb, _rxen);
-	sbi(*_ucsrb, _rxen);
-}
-
-
-/**
- * Writes the given character in the EMS Serial
- *
- * @param	c	The char to write.
- *
- * @return	The number of bytes written.
- */
-
-size_t EMSSerial::write(uint8_t c)
-{
-	_written = true;
-
-	// UDRE Flag indicates if the transmit buffer (UDR) is ready to receive new data. If UDRE is
-	// one, the buffer is empty, and therefore ready to be written. Wait therefore until buffer
-	// empty signal. 
-	while (!(bitRead(*_ucsra, UDRE0))) {}
-
-	// write value in the trasmit buffer
-	*_udr = c;
-
-	return 1;
-}
-
-
-/**
- * Write a EMS end-of-frame character to the port First halt temporarily reception, change
- * parity to even and then send a break-character. Then restore the settings and re-enable
- * reception
- */
-
-void EMSSerial::writeEOF() {
-	uint8_t t;
-	cbi(*_ucsrb, _rxen);   						//disable reception
-	while (!(bitRead(*_ucsra, UDRE0))) {}		// wait for data register empty
-	t = *_ucsrc;								// save settings
-	sbi(*_ucsrc, UPM01);						//set parity even
-	sbi(*_ucsra, TXC0);							//reset TX-complete (seems to be needed to get parity change)
-	*_udr = 0;									//directly write a break
-	while (!(bitRead(*_ucsra, TXC0))) {}		//wait for transmit complete
-	*_ucsrc = t;								//restore settings
-	sbi(*_ucsra, TXC0);							//reset TX-complete (seems to be needed to get parity change)
-	sbi(*_ucsrb, _rxen);   						//re-enable reception
-}
-
-
-/**
- * Cast that converts the given to a bool
- *
- * @return	The result of the operation.
- */
-
-EMSSerial::operator bool() {
-	return true;
-}
-
-#if defined(UBRRH) && defined(UBRRL)
-EMSSerial EMSSerial0(&UBRRH, &UBRRL, &UCSRA, &UCSRB, &UCSRC, &UDR, RXEN, TXEN, RXCIE);
-#elif defined(UBRR0H) && defined(UBRR0L)
-EMSSerial EMSSerial0(&UBRR0H, &UBRR0L, &UCSR0A, &UCSR0B, &UCSR0C, &UDR0, RXEN0, TXEN0, RXCIE0);
-#endif
-#if defined(UBRR1H)
-EMSSerial EMSSerial1(&UBRR1H, &UBRR1L, &UCSR1A, &UCSR1B, &UCSR1C, &UDR1, RXEN1, TXEN1, RXCIE1);
-#endif
-#if defined(UBRR2H)
-EMSSerial EMSSerial2(&UBRR2H, &UBRR2L, &UCSR2A, &UCSR2B, &UCSR2C, &UDR2, RXEN2, TXEN2, RXCIE2);
-#endif
-#if defined(UBRR3H)
-EMSSerial EMSSerial3(&UBRR3H, &UBRR3L, &UCSR3A, &UCSR3B, &UCSR3C, &UDR3, RXEN3, TXEN3, RXCIE3);
-#endif
-
-#pragma endregion EMSSerial
-
-/** CalduinoData definition */
-#pragma region CalduinoData
-
-/** Printf formatting options */
-prog_char decimal[] = { "%d" };
-prog_char unsignedLong[] = { "%lu" };
-prog_char returnTag[] = { "Return" };
-
-/** Units for formatting purposes. */
-prog_char noneUnit[] = { "" };
-prog_char celsiusUnit[] = { "\xC2\xB0\C" };
-prog_char yesNoUnit[] = { "Yes/No" };
-prog_char mAmperUnit[] = { "mAmper" };
-prog_char barUnit[] = { "bar" };
-prog_char minuteUnit[] = { "minutes" };
-prog_char timesUnit[] = { "times" };
-prog_char percentageUnit[] = { "%" };
-prog_char dayUnit[] = { "day" };
-prog_char switchPointUnit[] = { "" };
-prog_char secondUnit[] = { "seconds" };
-
-/** CalduinoUnits Array. */
-const prog_char *calduinoUnits[] = {
-	noneUnit,
-	celsiusUnit,
-	yesNoUnit,
-	mAmperUnit,
-	barUnit,
-	minuteUnit,
-	timesUnit,
-	percentageUnit,
-	switchPointUnit,
-	secondUnit
-};
-
-
-/**
- * Decode a Calduino Data of type byte.
- *
- * @param [in]	inEMSBuffer	- The EMS bytes received.
- *
- * @return	The value of the Calduino Data in the EMS Buffer received.
- */
-
-byte CalduinoData::decodeByteValue(byte* inEMSBuffer)
-{
-	return (uint8_t)inEMSBuffer[offset];
-}
-
-
-
-/**
-* Decode a Calduino Data of type bit.
-*
-* @param [in]	inEMSBuffer	- The EMS bytes received.
-*
-* @return	The value of the Calduino Data in the EMS Buffer received.
-*/
-
-bool CalduinoData::decodeBitValue(byte* inEMSBuffer)
-{
-	return (bool)bitRead((uint8_t)inEMSBuffer[offset], bitOffset);
-}
-
-/**
-* Decode a Calduino Data of type ULong.
-*
-* @param [in]	inEMSBuffer	- The EMS bytes received.
-*
-* @return	The value of the Calduino Data in the EMS Buffer received.
-*/
-
-unsigned long CalduinoData::decodeULongValue(byte* inEMSBuffer)
-{
-	return (((unsigned long)(uint8_t)inEMSBuffer[offset]) << 16) + (((unsigned long)(uint8_t)inEMSBuffer[offset + 1]) << 8) + ((uint8_t)inEMSBuffer[offset + 2]);
-}
-
-
-/**
- * Decode a Calduino Data of type float.
- *
- * @param [in]	inEMSBuffer	- The EMS bytes received.
- *
- * @return	The value of the Calduino Data in the EMS Buffer received.
- */
-
-float CalduinoData::decodeFloatValue(byte *inEMSBuffer)
-{
-	return ((floatBytes == 2) ? (((float)((((uint8_t)inEMSBuffer[offset] << 8) + (uint8_t)inEMSBuffer[offset + 1]))) / floatFactor) : ((float)(((int8_t)inEMSBuffer[offset])) / floatFactor));
-}
-
-/**
-* Decode a Calduino Data of type SwitchPoint.
-*
-* @param [in]	inEMSBuffer	- The EMS bytes received.
-*
-* @return	The SwitchPoint value contained in the EMS Buffer received.
-*/
-
-SwitchPoint CalduinoData::decodeSwitchPoint(byte *inEMSBuffer)
-{
-	SwitchPoint value = { (offset / 2) - 2, (uint8_t)(inEMSBuffer[offset] & 7), (uint8_t)(inEMSBuffer[offset] >> 5), (uint8_t)(inEMSBuffer[offset + 1] / 6), (uint8_t)((inEMSBuffer[offset + 1] % 6) * 10) };
-	return value;
-}
-
-
-/**
- * Decodes the Calduino Data with the bytes contained in the EMS Buffer and convert returns an
- * string containing this decoded value.
- *
- * @param [in] 	inEMSBuffer	- EMS bytes received.
- * @param [out]	value	   	- pointer to an array of char elements where the decoded value is
- * 							is stored.
- */
-
-void CalduinoData::decodeValue(byte* inEMSBuffer, char* value)
-{
-	// First decode the value of the CalduinoData contained in inEMSBuffer and convert it to an string in tempBuf
-	switch (encodeType)
-	{
-		case CalduinoEncodeType::Byte:
-		{
-			sprintf_P(value, decimal, decodeByteValue(inEMSBuffer));
-			break;
-		}
-		case CalduinoEncodeType::Bit:
-		{
-			sprintf_P(value, decimal, decodeBitValue(inEMSBuffer));
-			break;
-		}
-		case CalduinoEncodeType::ULong:
-		{
-			sprintf_P(value, unsignedLong, decodeULongValue(inEMSBuffer));
-			break;
-		}
-		case CalduinoEncodeType::Float:
-		{
-			dtostrf(decodeFloatValue(inEMSBuffer), 1, 1, value);
-			break;
-		}
-		case CalduinoEncodeType::SwithPoint:
-		{
-			SwitchPoint valueSP = decodeSwitchPoint(inEMSBuffer);
-			sprintf_P(value, PSTR("%d %d %d %d %d"), valueSP.id, valueSP.action, valueSP.day, valueSP.hour, valueSP.minute);
-		}
-	}
-}
-
-
-/**
- * Composes a formatted string with the CalduinoDataType name and its value. Depending on the
- * print format it will be encoded as an XML and will or not include units.
- *
- * @param [out]	str		   	- pointer to an array of char elements where the resulting string
- * 								is stored.
- * @param [in] 	value	   	- value of the current calduino data to be printed.
- * @param 	   	printFormat	- active printing format.
- */
-
-void CalduinoData::printfValue(char* str, char* value, PrintFormat printFormat)
-{
-	// Second compose the output string according to the printFormat
-	switch (printFormat)
-	{
-		case PrintFormat::NoUnit:
-		{
-			snprintf_P(str, TEXT_BUFFER_SIZE, PSTR("%S: %s"), dataName, value);
-			break;
-		}
-		case PrintFormat::XML:
-		{
-			snprintf_P(str, TEXT_BUFFER_SIZE, PSTR("<%S>%s</%S>"), dataName, value, dataName);
-			break;
-		}
-		case PrintFormat::Standard:
-		{
-			snprintf_P(str, TEXT_BUFFER_SIZE, PSTR("%S: %s %S"), dataName, value, calduinoUnits[unit]);
-			break;
-		}
-	}
-}
-
-#pragma endregion CalduinoData
-
-/** EMSDatagram definition */
-#pragma region EMSDatagram
-
-/** RC Datetime Datagram */
-prog_char rCDatetimeName[] = { "RCDatetime" };
-prog_char year[] = { "Year" };
-prog_char month[] = { "Month" };
-prog_char day[] = { "Day" };
-prog_char hour[] = { "Hour" };
-prog_char minute[] = { "Minute" };
-prog_char second[] = { "Second" };
-
-const PROGMEM CalduinoData rCDatetimeValues[] =
-{
-	{ year, CalduinoEncodeType::Byte, CalduinoUnit::None, 4 },
-	{ month, CalduinoEncodeType::Byte, CalduinoUnit::None, 5 },
-	{ day, CalduinoEncodeType::Byte, CalduinoUnit::None, 7 },
-	{ hour, CalduinoEncodeType::Byte, CalduinoUnit::None, 6 },
-	{ minute, CalduinoEncodeType::Byte, CalduinoUnit::None, 8 },
-	{ second, CalduinoEncodeType::Byte, CalduinoUnit::None, 9 }
-};
-
-const PROGMEM EMSDatagram rCDatetime = { rCDatetimeName, MessageID::RC_Datetime_ID, DeviceID::RC_35, RC_DATETIME_MESSAGE_SIZE, RC_DATETIME_VALUES_COUNT, rCDatetimeValues };
-
-/** UBA Working Time Datagram */
-prog_char uBAWorkingTimeName[] = { "UBAWorkingTime" };
-prog_char uBAWorkingMin[] = { "UBAWorkMin" };
-
-const PROGMEM CalduinoData uBAWorkingTimeValues[] = {
-	{uBAWorkingMin, CalduinoEncodeType::ULong, CalduinoUnit::Minute, 4}
-};
-
-const PROGMEM EMSDatagram uBAWorkingTime = { uBAWorkingTimeName, MessageID::UBA_Working_Time_ID, DeviceID::UBA, UBA_WORKING_TIME_MESSAGE_SIZE, UBA_WORKING_TIME_VALUES_COUNT, uBAWorkingTimeValues };
-
-/** UBA Monitor Fast Datagram */
-prog_char uBAMonitorFastName[] = { "UBAMonitorFast" };
-prog_char selImpTemp[] = { "SelImpTemp" };
-prog_char curImpTemp[] = { "CurImpTemp" };
-prog_char retTemp[] = { "RetTemp" };
-prog_char selBurnPow[] = { "SelBurnPow" };
-prog_char curBurnPow[] = { "CurBurnPow" };
-prog_char flameCurr[] = { "FlameCurr" };
-prog_char sysPress[] = { "SysPress" };
-prog_char burnGas[] = { "BurnGas" };
-prog_char fanWork[] = { "FanWork" };
-prog_char ignWork[] = { "IgnWork" };
-prog_char heatPmp[] = { "HeatPmp" };
-prog_char threeWayValveDHW[] = { "Way3ValveDHW" };
-prog_char circDHW[] = { "CircDHW" };
-prog_char srvCode1[] = { "SrvCode1" };
-prog_char srvCode2[] = { "SrvCode2" };
-prog_char errCode[] = { "ErrCode" };
-
-const PROGMEM CalduinoData uBAMonitorFastValues[] = {
-	{selImpTemp, CalduinoEncodeType::Byte, CalduinoUnit::Celsius, 4},
-	{curImpTemp, CalduinoEncodeType::Float, CalduinoUnit::Celsius, 5, 0, 2, 10},
-	{selBurnPow, CalduinoEncodeType::Byte, CalduinoUnit::Percentage, 7},
-	{curBurnPow, CalduinoEncodeType::Byte, CalduinoUnit::Percentage, 8},
-	{burnGas, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 11, 0},
-	{fanWork, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 11, 2},
-	{ignWork, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 11, 3},
-	{heatPmp, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 11, 5},
-	{threeWayValveDHW, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 11, 6},
-	{circDHW, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 11, 7},
-	{retTemp, CalduinoEncodeType::Float, CalduinoUnit::Celsius, 17, 0, 2, 10},
-	{flameCurr, CalduinoEncodeType::Float, CalduinoUnit::MAmper, 19, 0, 2, 10},
-	{sysPress, CalduinoEncodeType::Float, CalduinoUnit::Bar, 21, 0, 1, 10},
-	{srvCode1, CalduinoEncodeType::Byte, CalduinoUnit::None, 22},
-	{srvCode2, CalduinoEncodeType::Byte, CalduinoUnit::None, 23},
-	{errCode, CalduinoEncodeType::Float, CalduinoUnit::None, 24, 0, 2, 1}
-};
-
-const PROGMEM EMSDatagram uBAMonitorFast = { uBAMonitorFastName, MessageID::UBA_Monitor_Fast_ID, DeviceID::UBA, UBA_MONITOR_FAST_MESSAGE_SIZE, UBA_MONITOR_FAST_VALUES_COUNT, uBAMonitorFastValues };
-
-/** UBA Monitor Slow Datagram */
-prog_char uBAMonitorSlowName[] = { "UBAMonitorSlow" };
-prog_char extTemp[] = { "ExtTemp" };
-prog_char boilTemp[] = { "BoilTemp" };
-prog_char pumpMod[] = { "PumpMod" };
-prog_char burnStarts[] = { "BurnStarts" };
-prog_char burnWorkMin[] = { "BurnWorkMin" };
-prog_char burnWorkMinH[] = { "BurnWorkMinH" };
-
-const PROGMEM CalduinoData uBAMonitorSlowValues[] = {
-	{extTemp, CalduinoEncodeType::Float, CalduinoUnit::Celsius, 4, 0, 2, 10},
-	{boilTemp, CalduinoEncodeType::Float, CalduinoUnit::Celsius, 6, 0, 2, 10},
-	{pumpMod, CalduinoEncodeType::Byte, CalduinoUnit::Percentage, 13},
-	{burnStarts, CalduinoEncodeType::ULong, CalduinoUnit::Times, 14},
-	{burnWorkMin, CalduinoEncodeType::ULong, CalduinoUnit::Minute, 17},
-	{burnWorkMinH, CalduinoEncodeType::ULong, CalduinoUnit::Minute, 23}
-};
-
-const PROGMEM EMSDatagram uBAMonitorSlow = { uBAMonitorSlowName, MessageID::UBA_Monitor_Slow_ID, DeviceID::UBA, UBA_MONITOR_SLOW_MESSAGE_SIZE, UBA_MONITOR_SLOW_VALUES_COUNT, uBAMonitorSlowValues };
-
-/** UBA Parameter DHW Datagram */
-prog_char uBAParameterDHWName[] = { "UBAParameterDHW" };
-prog_char selTempDHW[] = { "SelTempDHW" };
-prog_char tempTDDHW[] = { "SelTempTDDHW" };
-
-const PROGMEM CalduinoData uBAParameterDHWValues[] = {
-	{selTempDHW, CalduinoEncodeType::Byte, CalduinoUnit::Celsius, 6},
-	{tempTDDHW, CalduinoEncodeType::Byte, CalduinoUnit::Celsius, 12}
-};
-
-const PROGMEM EMSDatagram uBAParameterDHW = { uBAParameterDHWName, MessageID::UBA_Parameter_DHW_ID, DeviceID::UBA, UBA_PARAMETER_DHW_MESSAGE_SIZE, UBA_PARAMETER_DHW_VALUES_COUNT, uBAParameterDHWValues };
-
-/** UBA Monitor DHW Datagram */
-prog_char uBAMonitorDHWName[] = { "UBAMonitorDHW" };
-prog_char curTempDHW[] = { "CurTempDHW" };
-prog_char dayModeDHW[] = { "DayModeDHW" };
-prog_char oneTimeDHW[] = { "OneTimeDHW" };
-prog_char desDHW[] = { "DesDHW" };
-prog_char prepareDHW[] = { "PrepareDHW" };
-prog_char burnWorkMinDHW[] = { "BurnWorkMinDHW" };
-prog_char burnStartsDHW[] = { "BurnStartsDHW" };
-
-const PROGMEM CalduinoData uBAMonitorDHWValues[] = {
-	{curTempDHW, CalduinoEncodeType::Float, CalduinoUnit::Celsius, 5, 0, 2, 10},
-	{dayModeDHW, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 9, 0},
-	{oneTimeDHW, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 9, 1},
-	{desDHW, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 9, 2},
-	{prepareDHW, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 9, 3},
-	{burnWorkMinDHW, CalduinoEncodeType::ULong, CalduinoUnit::Minute, 14},
-	{burnStartsDHW, CalduinoEncodeType::ULong, CalduinoUnit::Times, 17}
-};
-
-const PROGMEM EMSDatagram uBAMonitorDHW = { uBAMonitorDHWName, MessageID::UBA_Monitor_DHW_ID, DeviceID::UBA, UBA_MONITOR_DHW_MESSAGE_SIZE, UBA_MONITOR_DHW_VALUES_COUNT, uBAMonitorDHWValues };
-
-/** UBA Flags DHW Datagram */
-prog_char flagsDHWName[] = { "FlagsDHW" };
-
-const PROGMEM CalduinoData uBAflagsDHWValues[] = {
-	{ oneTimeDHW, CalduinoEncodeType::Byte, CalduinoUnit::Celsius, 4 }
-};
-
-const PROGMEM EMSDatagram uBAFlagsDHW = { flagsDHWName, MessageID::Flags_DHW_ID, DeviceID::UBA, FLAGS_DHW_MESSAGE_SIZE, FLAGS_DHW_VALUES_COUNT, uBAflagsDHWValues };
-
-/** Working Mode DHW Datagram */
-prog_char workingModeDHWName[] = { "WorkingModeDHW" };
-prog_char progDHW[] = { "ProgDHW" };
-prog_char progPumpDHW[] = { "ProgPumpDHW" };
-prog_char workModeDHW[] = { "WorkModeDHW" };
-prog_char workModePumpDHW[] = { "WorkModePumpDHW" };
-prog_char workModeTDDHW[] = { "WorkModeTDDHW" };
-prog_char dayTDDHW[] = { "DayTDDHW" };
-prog_char hourTDDHW[] = { "HourTDDHW" };
-
-const PROGMEM CalduinoData workingModeDHWValues[] = {
-	{progDHW, CalduinoEncodeType::Byte, CalduinoUnit::None, 4},
-	{progPumpDHW, CalduinoEncodeType::Byte, CalduinoUnit::None, 5},
-	{workModeDHW, CalduinoEncodeType::Byte, CalduinoUnit::None, 6},
-	{workModePumpDHW, CalduinoEncodeType::Byte, CalduinoUnit::None, 7},
-	{workModeTDDHW, CalduinoEncodeType::Byte, CalduinoUnit::YesNo, 8},
-	{dayTDDHW, CalduinoEncodeType::Byte, CalduinoUnit::None, 9},
-	{hourTDDHW, CalduinoEncodeType::Byte, CalduinoUnit::None, 10}
-};
-
-const PROGMEM EMSDatagram workingModeDHW = { workingModeDHWName, MessageID::Working_Mode_DHW_ID, DeviceID::RC_35, WORKING_MODE_DHW_MESSAGE_SIZE, WORKING_MODE_DHW_VALUES_COUNT, workingModeDHWValues };
-
-/** Working Mode HC Datagram */
-prog_char workingModeHC1Name[] = { "WorkingModeHC1" };
-prog_char workingModeHC2Name[] = { "WorkingModeHC2" };
-prog_char workingModeHC3Name[] = { "WorkingModeHC3" };
-prog_char workingModeHC4Name[] = { "WorkingModeHC4" };
-prog_char selNightTempHC[] = { "SelNightTempHC" };
-prog_char selDayTempHC[] = { "SelDayTempHC" };
-prog_char selHoliTempHC[] = { "SelHoliTempHC" };
-prog_char roomTempInfHC[] = { "RoomTempInfHC" };
-prog_char roomTempOffHC[] = { "RoomTempOffHC" };
-prog_char workModeHC[] = { "WorkModeHC" };
-prog_char sWThresTempHC[] = { "SWThresTempHC" };
-prog_char nightSetbackHC[] = { "NightSetbackHC" };
-prog_char nightOutTempHC[] = { "NightOutTempHC" };
-
-const PROGMEM CalduinoData workingModeHCValues[] = {
-	{selNightTempHC, CalduinoEncodeType::Float, CalduinoUnit::Celsius, 5, 0, 1, 2},
-	{selDayTempHC, CalduinoEncodeType::Float, CalduinoUnit::Celsius, 6, 0, 1, 2},
-	{selHoliTempHC, CalduinoEncodeType::Float, CalduinoUnit::Celsius, 7, 0, 1, 2},
-	{roomTempInfHC, CalduinoEncodeType::Float, CalduinoUnit::Celsius, 8, 0, 1, 2},
-	{roomTempOffHC, CalduinoEncodeType::Float, CalduinoUnit::Celsius, 10, 0, 1, 2},
-	{workModeHC, CalduinoEncodeType::Byte, CalduinoUnit::None, 11},
-	{sWThresTempHC, CalduinoEncodeType::Byte, CalduinoUnit::Celsius, 26},
-	{nightSetbackHC, CalduinoEncodeType::Byte, CalduinoUnit::None, 29},
-	{nightOutTempHC, CalduinoEncodeType::Float, CalduinoUnit::Celsius, 43, 0, 1, 1}
-};
-
-const PROGMEM EMSDatagram workingModeHC1 = { workingModeHC1Name, MessageID::Working_Mode_HC_1_ID, DeviceID::RC_35, WORKING_MODE_HC_MESSAGE_SIZE, WORKING_MODE_HC_VALUES_COUNT, workingModeHCValues };
-const PROGMEM EMSDatagram workingModeHC2 = { workingModeHC2Name, MessageID::Working_Mode_HC_2_ID, DeviceID::RC_35, WORKING_MODE_HC_MESSAGE_SIZE, WORKING_MODE_HC_VALUES_COUNT, workingModeHCValues };
-const PROGMEM EMSDatagram workingModeHC3 = { workingModeHC3Name, MessageID::Working_Mode_HC_3_ID, DeviceID::RC_35, WORKING_MODE_HC_MESSAGE_SIZE, WORKING_MODE_HC_VALUES_COUNT, workingModeHCValues };
-const PROGMEM EMSDatagram workingModeHC4 = { workingModeHC4Name, MessageID::Working_Mode_HC_4_ID, DeviceID::RC_35, WORKING_MODE_HC_MESSAGE_SIZE, WORKING_MODE_HC_VALUES_COUNT, workingModeHCValues };
-
-/** Monitor HC Datagram */
-prog_char monitorHC1Name[] = { "MonitorHC1" };
-prog_char monitorHC2Name[] = { "MonitorHC2" };
-prog_char monitorHC3Name[] = { "MonitorHC3" };
-prog_char monitorHC4Name[] = { "MonitorHC4" };
-prog_char holiModHC[] = { "HoliModHC" };
-prog_char summerModHC[] = { "SummerModHC" };
-prog_char dayModHC[] = { "DayModHC" };
-prog_char pauseModHC[] = { "PauseModHC" };
-prog_char selRoomTempHC[] = { "SelRoomTempHC" };
-
-const PROGMEM CalduinoData monitorHCValues[] = {
-	{holiModHC, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 4, 5},
-	{summerModHC, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 5, 0},
-	{dayModHC, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 5, 1},
-	{pauseModHC, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 5, 7},
-	{selRoomTempHC, CalduinoEncodeType::Float, CalduinoUnit::Celsius, 6, 0, 1, 2}
-};
-
-const PROGMEM EMSDatagram monitorHC1 = { monitorHC1Name, MessageID::Monitor_HC_1_ID, DeviceID::RC_35, MONITOR_HC_MESSAGE_SIZE, MONITOR_HC_VALUES_COUNT, monitorHCValues };
-const PROGMEM EMSDatagram monitorHC2 = { monitorHC2Name, MessageID::Monitor_HC_2_ID, DeviceID::RC_35, MONITOR_HC_MESSAGE_SIZE, MONITOR_HC_VALUES_COUNT, monitorHCValues };
-const PROGMEM EMSDatagram monitorHC3 = { monitorHC3Name, MessageID::Monitor_HC_3_ID, DeviceID::RC_35, MONITOR_HC_MESSAGE_SIZE, MONITOR_HC_VALUES_COUNT, monitorHCValues };
-const PROGMEM EMSDatagram monitorHC4 = { monitorHC4Name, MessageID::Monitor_HC_4_ID, DeviceID::RC_35, MONITOR_HC_MESSAGE_SIZE, MONITOR_HC_VALUES_COUNT, monitorHCValues };
-
-/** Switching Program Datagram */
-prog_char programDHWName[] = { "ProgramDHW" };
-prog_char programPumpDHWName[] = { "ProgramPumpDHW" };
-prog_char program1HC1Name[] = { "Program1HC1" };
-prog_char program1HC2Name[] = { "Program1HC2" };
-prog_char program1HC3Name[] = { "Program1HC3" };
-prog_char program1HC4Name[] = { "Program1HC4" };
-prog_char program2HC1Name[] = { "Program2HC1" };
-prog_char program2HC2Name[] = { "Program2HC2" };
-prog_char program2HC3Name[] = { "Program2HC3" };
-prog_char program2HC4Name[] = { "Program2HC4" };
-prog_char switchPoint[] = { "SwitchPoint" };
-prog_char programName[] = { "ProgramName" };
-prog_char pauseTime[] = { "PauseTime" };
-prog_char partyTime[] = { "PartyTime" };
-prog_char startHolidayDay[] = { "StartHoliDay" };
-prog_char startHolidayMonth[] = { "StartHoliMonth" };
-prog_char startHolidayYear[] = { "StartHoliYear" };
-prog_char endHolidayDay[] = { "EndHoliDay" };
-prog_char endHolidayMonth[] = { "EndHoliMonth" };
-prog_char endHolidayYear[] = { "EndHoliYear" };
-prog_char startHomeHolidayDay[] = { "StartHHolDay" };
-prog_char startHomeHolidayMonth[] = { "StartHHoliMonth" };
-prog_char startHomeHolidayYear[] = { "StartHHoliYear" };
-prog_char endHomeHolidayDay[] = { "EndHHoliDay" };
-prog_char endHomeHolidayMonth[] = { "EndHHoliMonth" };
-prog_char endHomeHolidayYear[] = { "EndHHoliYear" };
-
-const PROGMEM CalduinoData switchingProgramValues[] = {
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 4},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 6},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 8},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 10}, 
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 12},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 14},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 16},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 18},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 20},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 22},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 24},	//10
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 26},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 28},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 30},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 32},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 34},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 36},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 38},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 40},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 42},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 44},	//20
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 46},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 48},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 50},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 52},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 54},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 56},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 58},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 60},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 62},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 64},	//30
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 66},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 68},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 70},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 72},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 74},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 76},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 78},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 80},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 82},
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 84},	//40
-	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 86},
-	{programName, CalduinoEncodeType::Byte, CalduinoUnit::None, 88},
-	{pauseTime, CalduinoEncodeType::Byte, CalduinoUnit::None, 89},			
-	{partyTime, CalduinoEncodeType::Byte, CalduinoUnit::None, 90},
-	{startHolidayDay, CalduinoEncodeType::Byte, CalduinoUnit::None, 91},
-	{startHolidayMonth, CalduinoEncodeType::Byte, CalduinoUnit::None, 92},
-	{startHolidayYear, CalduinoEncodeType::Byte, CalduinoUnit::None, 93},
-	{endHolidayDay, CalduinoEncodeType::Byte, CalduinoUnit::None, 94},
-	{endHolidayMonth, CalduinoEncodeType::Byte, CalduinoUnit::None, 95},
-	{endHolidayYear, CalduinoEncodeType::Byte, CalduinoUnit::None, 96},		//50
-	{startHomeHolidayDay, CalduinoEncodeType::Byte, CalduinoUnit::None, 97},
-	{startHomeHolidayMonth, CalduinoEncodeType::Byte, CalduinoUnit::None, 98},
-	{startHomeHolidayYear, CalduinoEncodeType::Byte, CalduinoUnit::None, 99},
-	{endHomeHolidayDay, CalduinoEncodeType::Byte, CalduinoUnit::None, 100},
-	{endHomeHolidayMonth, CalduinoEncodeType::Byte, CalduinoUnit::None, 101},
-	{endHomeHolidayYear, CalduinoEncodeType::Byte, CalduinoUnit::None, 102}
-};
-
-const PROGMEM EMSDatagram program1HC1 = { program1HC1Name, MessageID::Program_1_HC_1_ID, DeviceID::RC_35, SWITCHING_PROGRAM_1_MESSAGE_SIZE, SWITCHING_PROGRAM_1_VALUES_COUNT, switchingProgramValues };
-const PROGMEM EMSDatagram program1HC2 = { program1HC2Name, MessageID::Program_1_HC_2_ID, DeviceID::RC_35, SWITCHING_PROGRAM_1_MESSAGE_SIZE, SWITCHING_PROGRAM_1_VALUES_COUNT, switchingProgramValues };
-const PROGMEM EMSDatagram program1HC3 = { program1HC3Name, MessageID::Program_1_HC_3_ID, DeviceID::RC_35, SWITCHING_PROGRAM_1_MESSAGE_SIZE, SWITCHING_PROGRAM_1_VALUES_COUNT, switchingProgramValues };
-const PROGMEM EMSDatagram program1HC4 = { program1HC4Name, MessageID::Program_1_HC_4_ID, DeviceID::RC_35, SWITCHING_PROGRAM_1_MESSAGE_SIZE, SWITCHING_PROGRAM_1_VALUES_COUNT, switchingProgramValues };
-const PROGMEM EMSDatagram program2HC1 = { program2HC1Name, MessageID::Program_2_HC_1_ID, DeviceID::RC_35, SWITCHING_PROGRAM_2_MESSAGE_SIZE, SWITCHING_PROGRAM_2_VALUES_COUNT, switchingProgramValues };
-const PROGMEM EMSDatagram program2HC2 = { program2HC2Name, MessageID::Program_2_HC_2_ID, DeviceID::RC_35, SWITCHING_PROGRAM_2_MESSAGE_SIZE, SWITCHING_PROGRAM_2_VALUES_COUNT, switchingProgramValues };
-const PROGMEM EMSDatagram program2HC3 = { program2HC3Name, MessageID::Program_2_HC_3_ID, DeviceID::RC_35, SWITCHING_PROGRAM_2_MESSAGE_SIZE, SWITCHING_PROGRAM_2_VALUES_COUNT, switchingProgramValues };
-const PROGMEM EMSDatagram program2HC4 = { program2HC4Name, MessageID::Program_2_HC_4_ID, DeviceID::RC_35, SWITCHING_PROGRAM_2_MESSAGE_SIZE, SWITCHING_PROGRAM_2_VALUES_COUNT, switchingProgramValues };
-const PROGMEM EMSDatagram programDHW = { programDHWName, MessageID::Program_DHW_ID, DeviceID::RC_35, SWITCHING_PROGRAM_1_MESSAGE_SIZE, SWITCHING_PROGRAM_1_VALUES_COUNT, switchingProgramValues };
-const PROGMEM EMSDatagram programPumpDHW = { programPumpDHWName, MessageID::Program_Pump_DHW_ID, DeviceID::RC_35, SWITCHING_PROGRAM_1_MESSAGE_SIZE, SWITCHING_PROGRAM_1_VALUES_COUNT, switchingProgramValues };
-
-/** Monitor MM10 Datagram */
-prog_char monitorMM10Name[] = { "MonitorMM10" };
-prog_char selImpTempMM10[] = { "SelImpTempMM10" };
-prog_char curImpTempMM10[] = { "CurImpTempMM10" };
-prog_char statusMM10[] = { "ModMM10" };
-
-const PROGMEM CalduinoData monitorMM10Values[] = {
-	{selImpTempMM10, CalduinoEncodeType::Byte, CalduinoUnit::Celsius, 4},
-	{curImpTempMM10, CalduinoEncodeType::Float, CalduinoUnit::Celsius, 5, 0, 2, 10},
-	{statusMM10, CalduinoEncodeType::Byte, CalduinoUnit::Percentage, 7}
-};
-
-const PROGMEM EMSDatagram monitorMM10  = { monitorMM10Name, MessageID::Monitor_MM_10_ID, DeviceID::MM_10, MONITOR_MM_10_MESSAGE_SIZE, MONITOR_MM_10_VALUES_COUNT, monitorMM10Values };
-
-/** EMS Datagram Array , pointer to the defined EMS Datagrams */
-EMSDatagram* eMSDatagramIDs[]  =
-{
-	&rCDatetime,
-	&uBAWorkingTime,
-	&uBAMonitorFast,
-	&uBAMonitorSlow,
-	&uBAParameterDHW,
-	&uBAMonitorDHW,
-	&uBAFlagsDHW,
-	&workingModeDHW,
-	&programDHW,
-	&programPumpDHW,
-	&workingModeHC1,
-	&monitorHC1,
-	&program1HC1,
-	&program2HC1,
-	&workingModeHC2,
-	&monitorHC2,
-	&program1HC2,
-	&program2HC2,
-	&workingModeHC3,
-	&monitorHC3,
-	&program1HC3,
-	&program2HC3,
-	&workingModeHC4,
-	&monitorHC4,
-	&program1HC4,
-	&program2HC4,
-	&monitorMM10
-};
-
-
- /**
-  * Structure that contains a Calduino Data and the EMS Datagram where it is contained. It is
-  * used in order to print single values contained in a EMS Buffer.
-  */
-
- struct CalduinoDataRequest
-{
-	CalduinoData* dataType;
-	EMSDatagram* eMSDatagram;
-};
-
-/** Array with all the Calduino Data of type bytes. Is referenced by ByteRequest enumeration. */
-const PROGMEM CalduinoDataRequest byteRequests[] =
-{
-	{ &rCDatetimeValues[yearIdx],				&rCDatetime },		//0
-	{ &rCDatetimeValues[monthIdx],				&rCDatetime },
-	{ &rCDatetimeValues[dayIdx],				&rCDatetime },
-	{ &rCDatetimeValues[hourIdx],				&rCDatetime },
-	{ &rCDatetimeValues[minuteIdx],				&rCDatetime },
-	{ &rCDatetimeValues[secondIdx],				&rCDatetime },		//5
-	{ &uBAMonitorFastValues[selImpTempIdx],		&uBAMonitorFast },
-	{ &uBAMonitorFastValues[selBurnPowIdx],		&uBAMonitorFast },
-	{ &uBAMonitorFastValues[curBurnPowIdx],		&uBAMonitorFast },
-	{ &uBAMonitorFastValues[srvCode1Idx],		&uBAMonitorFast },
-	{ &uBAMonitorFastValues[srvCode2Idx],		&uBAMonitorFast },	//10
-	{ &uBAMonitorSlowValues[pumpModIdx],		&uBAMonitorSlow },
-	{ &uBAParameterDHWValues[selTempDHWIdx],	&uBAParameterDHW },	
-	{ &uBAParameterDHWValues[tempTDDHWIdx],		&uBAParameterDHW },
-	{ &uBAflagsDHWValues[oneTimeDHW2Idx],		&uBAFlagsDHW },
-	{ &workingModeDHWValues[progDHWIdx],		&workingModeDHW },	//15
-	{ &workingModeDHWValues[progPumpDHWIdx],	&workingModeDHW },
-	{ &workingModeDHWValues[workModeDHWIdx],	&workingModeDHW },
-	{ &workingModeDHWValues[workModePumpDHWIdx],&workingModeDHW },
-	{ &workingModeDHWValues[dayTDDHWIdx],		&workingModeDHW },
-	{ &workingModeDHWValues[hourTDDHWIdx],		&workingModeDHW },	//20
-	{ &workingModeHCValues[workModeHCIdx],		&workingModeHC1 },
-	{ &workingModeHCValues[sWThresTempHCIdx],	&workingModeHC1 },
-	{ &workingModeHCValues[nightSetbackHCIdx],	&workingModeHC1 },
-	{ &workingModeHCValues[workModeHCIdx],		&workingModeHC2 },
-	{ &workingModeHCValues[sWThresTempHCIdx],	&workingModeHC2 },	//25
-	{ &workingModeHCValues[nightSetbackHCIdx],	&workingModeHC2 },
-	{ &workingModeHCValues[workModeHCIdx],		&workingModeHC3 },
-	{ &workingModeHCValues[sWThresTempHCIdx],	&workingModeHC3 },
-	{ &workingModeHCValues[nightSetbackHCIdx],	&workingModeHC3 },
-	{ &workingModeHCValues[workModeHCIdx],		&workingModeHC4 },	//30
-	{ &workingModeHCValues[sWThresTempHCIdx],	&workingModeHC4 },
-	{ &workingModeHCValues[nightSetbackHCIdx],	&workingModeHC4 },
-	{ &switchingProgramValues[programNameIdx],	&program1HC1 },
-	{ &switchingProgramValues[pauseTimeIdx],	&program1HC1 },
-	{ &switchingProgramValues[partyTimeIdx],	&program1HC1 },		//35
-	{ &switchingProgramValues[programNameIdx],	&program1HC2 },
-	{ &switchingProgramValues[pauseTimeIdx],	&program1HC2 },
-	{ &switchingProgramValues[partyTimeIdx],	&program1HC2 },
-	{ &switchingProgramValues[programNameIdx],	&program1HC3 },
-	{ &switchingProgramValues[pauseTimeIdx],	&program1HC3 },		//40
-	{ &switchingProgramValues[partyTimeIdx],	&program1HC3 },
-	{ &switchingProgramValues[programNameIdx],	&program1HC4 },
-	{ &switchingProgramValues[pauseTimeIdx],	&program1HC4 },
-	{ &switchingProgramValues[partyTimeIdx],	&program1HC4 },		//44
-};
-
-/** Array with all the Calduino Data of type float. Is referenced by FloatRequest enumeration. */
-const PROGMEM CalduinoDataRequest floatRequests[] =
-{
-	{ &uBAMonitorFastValues[curImpTempIdx],	&uBAMonitorFast },		//0
-	{ &uBAMonitorFastValues[retTempIdx],	&uBAMonitorFast },
-	{ &uBAMonitorFastValues[flameCurrIdx],	&uBAMonitorFast },
-	{ &uBAMonitorFastValues[sysPressIdx],	&uBAMonitorFast },
-	{ &uBAMonitorFastValues[errCodeIdx],	&uBAMonitorFast },
-	{ &uBAMonitorSlowValues[extTempIdx],	&uBAMonitorSlow },		//5
-	{ &uBAMonitorSlowValues[boilTempIdx],	&uBAMonitorSlow },
-	{ &uBAMonitorDHWValues[curTempDHWIdx],	&uBAMonitorDHW },
-	{ &workingModeHCValues[selNightTempHCIdx],	&workingModeHC1 },
-	{ &workingModeHCValues[selDayTempHCIdx],	&workingModeHC1 },
-	{ &workingModeHCValues[selHoliTempHCIdx],	&workingModeHC1 },	//10
-	{ &workingModeHCValues[roomTempInfHCIdx],	&workingModeHC1 },
-	{ &workingModeHCValues[roomTempOffHCIdx],	&workingModeHC1 },
-	{ &workingModeHCValues[nightOutTempHCIdx],	&workingModeHC1 },
-	{ &workingModeHCValues[selNightTempHCIdx],	&workingModeHC2 },
-	{ &workingModeHCValues[selDayTempHCIdx],	&workingModeHC2 },	//15
-	{ &workingModeHCValues[selHoliTempHCIdx],	&workingModeHC2 },
-	{ &workingModeHCValues[roomTempInfHCIdx],	&workingModeHC2 },
-	{ &workingModeHCValues[roomTempOffHCIdx],	&workingModeHC2 },
-	{ &workingModeHCValues[nightOutTempHCIdx],	&workingModeHC2 },
-	{ &workingModeHCValues[selNightTempHCIdx],	&workingModeHC3 },	//20
-	{ &workingModeHCValues[selDayTempHCIdx],	&workingModeHC3 },
-	{ &workingModeHCValues[selHoliTempHCIdx],	&workingModeHC3 },
-	{ &workingModeHCValues[roomTempInfHCIdx],	&workingModeHC3 },
-	{ &workingModeHCValues[roomTempOffHCIdx],	&workingModeHC3 },
-	{ &workingModeHCValues[nightOutTempHCIdx],	&workingModeHC3 },	//25
-	{ &workingModeHCValues[selNightTempHCIdx],	&workingModeHC4 },
-	{ &workingModeHCValues[selDayTempHCIdx],	&workingModeHC4 },
-	{ &workingModeHCValues[selHoliTempHCIdx],	&workingModeHC4 },
-	{ &workingModeHCValues[roomTempInfHCIdx],	&workingModeHC4 },
-	{ &workingModeHCValues[roomTempOffHCIdx],	&workingModeHC4 },	//30
-	{ &workingModeHCValues[nightOutTempHCIdx],	&workingModeHC4 },
-	{ &workingModeHCValues[selRoomTempHCIdx],	&workingModeHC1 },
-	{ &workingModeHCValues[selRoomTempHCIdx],	&workingModeHC2 },
-	{ &workingModeHCValues[selRoomTempHCIdx],	&workingModeHC3 },
-	{ &workingModeHCValues[selRoomTempHCIdx],	&workingModeHC4 },	//35
-	{ &monitorMM10Values[curImpTempMM10Idx],	&monitorMM10 },		//36
-};
-
-/** Array with all the Calduino Data of type bit. Is referenced by BitRequest enumeration. */
-const PROGMEM CalduinoDataRequest bitRequests[] =
-{
-	{ &uBAMonitorFastValues[burnGasIdx],			&uBAMonitorFast },	//0
-	{ &uBAMonitorFastValues[fanWorkIdx],			&uBAMonitorFast },
-	{ &uBAMonitorFastValues[ignWorkIdx],			&uBAMonitorFast },
-	{ &uBAMonitorFastValues[heatPmpIdx],			&uBAMonitorFast },
-	{ &uBAMonitorFastValues[threeWayValveDHWIdx],	&uBAMonitorFast },
-	{ &uBAMonitorFastValues[circDHWIdx],			&uBAMonitorFast },	//5
-	{ &uBAMonitorDHWValues[dayModeDHWIdx],			&uBAMonitorDHW },
-	{ &uBAMonitorDHWValues[oneTimeDHW1Idx],			&uBAMonitorDHW },
-	{ &uBAMonitorDHWValues[desDHWIdx],				&uBAMonitorDHW },
-	{ &uBAMonitorDHWValues[prepareDHWIdx],			&uBAMonitorDHW },
-	{ &uBAMonitorDHWValues[holiModHCIdx],			&monitorHC1 },		//10
-	{ &uBAMonitorDHWValues[summerModHCIdx],			&monitorHC1 },
-	{ &uBAMonitorDHWValues[dayModHCIdx],			&monitorHC1 },
-	{ &uBAMonitorDHWValues[pauseModHCIdx],			&monitorHC1 },
-	{ &uBAMonitorDHWValues[holiModHCIdx],			&monitorHC2 },
-	{ &uBAMonitorDHWValues[summerModHCIdx],			&monitorHC2 },		//15
-	{ &uBAMonitorDHWValues[dayModHCIdx],			&monitorHC2 },
-	{ &uBAMonitorDHWValues[pauseModHCIdx],			&monitorHC2 },
-	{ &uBAMonitorDHWValues[holiModHCIdx],			&monitorHC3 },
-	{ &uBAMonitorDHWValues[summerModHCIdx],			&monitorHC3 },
-	{ &uBAMonitorDHWValues[dayModHCIdx],			&monitorHC3 },		//20
-	{ &uBAMonitorDHWValues[pauseModHCIdx],			&monitorHC3 },
-	{ &uBAMonitorDHWValues[holiModHCIdx],			&monitorHC4 },
-	{ &uBAMonitorDHWValues[summerModHCIdx],			&monitorHC4 },
-	{ &uBAMonitorDHWValues[dayModHCIdx],			&monitorHC4 },
-	{ &uBAMonitorDHWValues[pauseModHCIdx],			&monitorHC4 },		//25
-};
-
-/** Array with all the Calduino Data of type ulong. Is referenced by uLongRequest enumeration. */
-const PROGMEM CalduinoDataRequest uLongRequests[] =
-{
-	{ &uBAWorkingTimeValues[uBAWorkingMinIdx], &uBAWorkingTime },
-	{ &uBAMonitorSlowValues[burnStartsIdx], &uBAMonitorSlow },
-	{ &uBAMonitorSlowValues[burnWorkMinIdx], &uBAMonitorSlow },
-	{ &uBAMonitorSlowValues[burnWorkMinHIdx], &uBAMonitorSlow },
-	{ &uBAMonitorDHWValues[burnStartsDHWIdx], &uBAMonitorDHW },
-	{ &uBAMonitorDHWValues[burnWorkMinDHWIdx], &uBAMonitorDHW },
-};
-
-
-/**
- * Composes a formatted string with the EMSDatagram name sending the output to a char array
- * pointed by str.
- *
- * @param [out]	str		   	- pointer to an array of char elements where the resulting string
- * 								is stored.
- * @param 	   	header	   	- whether the current operation is a header or tail message.
- * @param 	   	printFormat	- selected printing format.
- */
-
-void EMSDatagram::printMessageName(char* str, boolean header, PrintFormat printFormat)
-{
-	// compose the output string according to the printFormat
-	switch (printFormat)
-	{
-		case PrintFormat::NoUnit: 
-		case PrintFormat::Standard:
-		{
-			snprintf_P(str, TEXT_BUFFER_SIZE, PSTR("--- %S ---"), messageName);
-			break;
-		}
-		case PrintFormat::XML:
-		{
-			snprintf_P(str, TEXT_BUFFER_SIZE, (header ? PSTR("<%S>") : PSTR("</%S>")), messageName);
-			break;
-		}
-	}
-}
-
-/**
- * Composes a formatted string with the EMS Datagram error status sending the output to a char
- * array pointed by str.
- *
- * @param [out]	str		   	- pointer to an array of char elements where the resulting
- * 								string is stored.
- * @param 	   	printFormat	- selected printing format.
- */
-
-void EMSDatagram::printErrorTag(char* str, PrintFormat printFormat)
-{
-	// compose the output string according to the printFormat
-	switch (printFormat)
-		{
-		case PrintFormat::NoUnit:
-		{
-			snprintf_P(str, TEXT_BUFFER_SIZE, PSTR("%S: %d"), returnTag, 0);
-			break;
-		}
-		case PrintFormat::XML:
-		{
-			snprintf_P(str, TEXT_BUFFER_SIZE, PSTR("<%S>%d</%S>"), returnTag, 0, returnTag);
-			break;
-		}
-		case PrintFormat::Standard:
-		{
-			snprintf_P(str, TEXT_BUFFER_SIZE, PSTR("%S: %d"), returnTag, 0);
-			break;
-		}
-	}
-}
-
-
-#pragma endregion EMSDatagram
-
-/* CalduinoDebug definition */
-#pragma region CalduinoDebug
-
-/** Default constructor */
-CalduinoDebug::CalduinoDebug()
-{
-	debugSerial = NULL;
-}
-
-
-/**
- * Begins the given debug serial
- *
- * @param [in,out]	_debugSerial	The stream to be used as debug serial.
- */
-
-void CalduinoDebug::begin(Stream *_debugSerial)
-{
-	debugSerial = _debugSerial;
-}
-
-
-/**
- * Writes the given data in the debug serial
- *
- * @param	data	The data to write.
- *
- * @return	The number of bytes written.
- */
-
-size_t CalduinoDebug::write(uint8_t data)
-{
-	if (debugSerial != NULL) {
-		return debugSerial->write(data);
-	}
-
-	return 0;
-}
-
-#pragma endregion CalduinoDebug
-
-/* CalduinoSerial definition */
-#pragma region CalduinoSerial
-
-/** Default constructor */
-CalduinoSerial::CalduinoSerial()
-{
-	calduinoSerial = NULL;
-}
-
-
-/**
- * Begins the given calduino serial
- *
- * @param [in,out]	_calduinoSerial	The stream to be used as calduino serial.
- */
-
-void CalduinoSerial::begin(EMSSerial *_calduinoSerial)
-{
-	calduinoSerial = _calduinoSerial;
-}
-#pragma endregion CalduinoSerial
-
-/* Calduino definition */
-#pragma region Calduino
-
-/** Calduino constructor method. Initialize variables. */
-Calduino::Calduino()
-{
-	EMSMaxWaitTime = EMS_MAX_WAIT_TIME;
-	printFormat = PrintFormat::Standard;
-}
-
-
-/**
- * Start the Calduino device assigning the serial streams used.
- *
- * @param [in,out]	_calduinoSerial	- UART port used to communicate with the EMS Serial.
- * @param [in,out]	_debugSerial   	- Optional stream to report errors and status.
- *
- * @return	True if there is communication with the EMS Buffer, false otherwise.
- */
-
-boolean Calduino::begin(EMSSerial *_calduinoSerial, Stream *_debugSerial)
-{
-	calduinoSerial.begin(_calduinoSerial);
-	debugSerial.begin(_debugSerial);
-
-	// Define DEBUG FUNCTIONS
-	if (_debugSerial != NULL)
-	{
-#ifndef DEBUG
-#define DEBUG
-#define DPRINT(item) debugSerial.print(item)
-#define DPRINTLN(item) debugSerial.println(item)
-#define DPRINTVALUE(item1, item2) debugSerial.print(item1);debugSerial.print(": ");debugSerial.println(item2)
-#endif
-	}
-
-	return getCalduinoByteValue(ByteRequest::second_b);
-}
-
-
-/**
- * Calculate the CRC code of the buffer passed as parameter.
- *
- * @param [in]	eMSBuffer	Buffer for which the CRC is calculated.
- * @param 	  	len		 	Length of the buffer.
- *
- * @return	CRC code.
- */
-
-uint8_t Calduino::crcCalculator(byte * eMSBuffer, int len)
-{
-	uint8_t i, crc = 0x0;
-	uint8_t d;
-	for (i = 0; i < len - 2; i++)
-	{
-		d = 0;
-		if (crc & 0x80)
-		{
-			crc ^= 12;
-			d = 1;
-		}
-		crc = (crc << 1) & 0xfe;
-		crc |= d;
-		crc ^= eMSBuffer[i];
-	}
-	return crc;
-}
-
-
-/**
- * Check if the CRC code calculated for the buffer corresponds with the CRC value received in
- * the buffer (second to last position).
- *
- * @param [in]	inEMSBuffer	Buffer for which the CRC is calculated.
- * @param 	  	len		   	The length of the buffer.
- *
- * @return	If the CRC received and the calculated are equal.
- */
-
-boolean Calduino::crcCheckOK(byte * inEMSBuffer, int len)
-{
-	int crc = crcCalculator(inEMSBuffer, len);
-	boolean crcOK = (crc == (uint8_t)inEMSBuffer[len - 2]);
-	return crcOK;
-}
-
-
-/**
- * Read one bus frame and return number of read bytes. Includes a timeout in order not to block
- * the program if there is no communication with the EMS Bus
- *
- * @param [in,out]	inEMSBuffer	Buffer where the income data will be stored.
- * @param 		  	len		   	The maximum length of the read datagram expected.
- * @param 		  	eMSTimeout 	Operation timeout in milliseconds.
- *
- * @return	Number of read bytes.
- */
-
-int Calduino::readBytes(byte * inEMSBuffer, byte len, unsigned long eMSTimeout)
-{
-	int ptr = 0;
-
-	// while there is available data and no timeout, skip the 0's in the buffer
-	while (calduinoSerial.available() && (millis() < eMSTimeout))
-	{
-		// if the first byte to be read is 0x00 (break)
-		if ((uint8_t)calduinoSerial.peek() == 0)
-		{
-			// skip breaks
-			calduinoSerial.read();
-		}
-		else
-		{
-			// break the loop
-			break;
-		}
-	}
-
-	// read data until frame-error, max bytes are read or timeout
-	while ((!calduinoSerial.frameError()) && (ptr < len) && (millis() < eMSTimeout))
-	{
-		if (calduinoSerial.available())
-		{
-			// store the information in inEMSBuffer and update the number of bytes read
-			inEMSBuffer[ptr] = calduinoSerial.read();
-			ptr++;
-		}
-	}
-
-	// flush the possible pending information left to be read (garbage)
-	calduinoSerial.flush();
-
-	// return the number of bytes read
-	return ptr;
-}
-
-
-/**
- * Send a data frame to the EMS BUS.
- *
- * @param [in]	outEMSBuffer	Buffer where the output data is stored.
- * @param 	  	len				The length of the buffer.
- */
-
-void Calduino::sendBuffer(byte * outEMSBuffer, int len)
-{
-	for (byte j = 0; j < len - 1; j++)
-	{
-		calduinoSerial.write(outEMSBuffer[j]);
-		delay(3);
-	}
-
-	// write a EMS end - of - frame character to the serial buffer
-	calduinoSerial.writeEOF();
-	delay(2);
-	calduinoSerial.flush();
-}
-
-
-/**
- * Wait until Calduino is polled and send the content of the buffer. If the connection with the
- * EMS Serial is not working properly, the function will timeout and return false.
- *
- * @param [in,out]	outEMSBuffer	Buffer where the output data is stored.
- *
- * @return	Whether the datagram has been sent in the available time or not.
- */
-
-boolean Calduino::sendRequest(byte *outEMSBuffer)
-{
-	// calculate the CRC value in the sIdxth position of the buffer
-	outEMSBuffer[5] = crcCalculator(outEMSBuffer, OUT_EMS_BUFFER_SIZE);
-
-	// last polled address (wait until this is 0x0B)
-	byte pollAddress = 0;
-
-	// flush the EMS Serial Stream by clearing (if any) current buffer contents
-	calduinoSerial.flush();
-
-	// watchdog (maximum polling waiting time)
-	unsigned long eMSTimeout = millis() + EMSMaxWaitTime * RETRY_FACTOR;
-
-	byte auxBuffer[MAX_EMS_READ];
-
-	// wait until being polled by the Bus Master
-	// Loop unitl PollAddress is the device ID that Calduino simulates (PC)
-	while ((pollAddress & 0x7F) != DeviceID::PC)
-	{
-		// end the operation without sending the request if the timeout expires
-		if (millis() > eMSTimeout) return false;
-		
-		// Read next datagram without limits of size (do not force 2 bytes read, in case UBA sends a monitor)
-		// Assign the first  read byte to pollAddress only if two bytes are read (bus master polls:
-		// pollAddress + Break) 
-		if (readBytes(auxBuffer, MAX_EMS_READ, eMSTimeout) == 2)
-		{
-			pollAddress = auxBuffer[0];
-		}
-	}
-
-	// wait two milliseconds and send the 7 bytes buffer (6 bytes + break) 
-	delay(2);
-	sendBuffer(outEMSBuffer, OUT_EMS_BUFFER_SIZE);
-
-	return true;
-
-}
-
-
-/**
- * Generic method to send an EMS get command and save the response in a buffer passed as
- * parameter. If the message length is greater than the MAX_EMS_READ, the command will be
- * splitted in shorter requests.
- *
- * @param [out]	inEMSBuffer  	Pointer to the buffer where the EMS Datagram received will be
- * 								saved. It will always have the size of the whole EMS Message, no
- * 								matter if only a Calduino Data is requested.
- * @param 	   	destinationID	The destinationID of the EMS device.
- * @param 	   	messageID	 	The messageID requested.
- * @param 	   	length		 	Expected length of the receiving EMS Datagram.
- * @param 	   	offset		 	(Optional) Only used in order to recieve a unique Calduino Data
- * 								and not whole EMS Message. Length parameter should be adapted to
- * 								the size of the Calduino Data.
- *
- * @return	True if it succeeds, false otherwise.
- */
-
-boolean Calduino::getEMSCommand(byte *inEMSBuffer, byte destinationID, byte messageID, byte length, byte offset = 0)
-{
-	byte outEMSBuffer[OUT_EMS_BUFFER_SIZE];
-	unsigned long timeout;
-
-	// load outEMSBuffer with corresponding values.
-	// first position is the transmitterID. Ox0B is the ComputerID (Calduino address)
-	outEMSBuffer[0] = DeviceID::PC;
-
-	// second position is destinationID. Masked with 0x80 as a read command
-	outEMSBuffer[1] = destinationID | 0x80;
-
-	// third position is the messageID
-	outEMSBuffer[2] = messageID;
-	
-	// assign this fake value in offset position just to force a first loop
-	outEMSBuffer[3] = -1;
-
-	// while there are still bytes pending to be read and the last EMS Command was correctly executed (offset has been increased)
-	while (length > 0 && (offset > (char)outEMSBuffer[3]))
-	{
-		// fourth position is the offset in the buffer. If the message is split in different commands,
-		// the offset contains the byte required from the EMS Datagram
-		outEMSBuffer[3] = offset;
-
-		// fifth position is the length of the data requested. If it is greater than the maximum utile bytes read (MAX_EMS_READ - EMS_DATAGRAM_OVERHEAD), read then only this quantity
-		outEMSBuffer[4] = (length > (MAX_EMS_READ - EMS_DATAGRAM_OVERHEAD) ? (MAX_EMS_READ - EMS_DATAGRAM_OVERHEAD) : length);
-
-		// once the buffer is loaded, send the request.
-		if (sendRequest(outEMSBuffer))
-		{
-			// check if the requested query is answered in the next EMSMaxWaitTime milliseconds
-			timeout = millis() + EMSMaxWaitTime;
-
-			// wait until timeout or there is some new data in the EMS-Bus
-			while ((millis() < timeout) && (!calduinoSerial.available())) {}
-
-			// if there is data to be read
-			if (calduinoSerial.available())
-			{
-				// auxiliar buffer with a length long enough to capture current EMS Datagram
-				byte auxBuffer[outEMSBuffer[4] + EMS_DATAGRAM_OVERHEAD];
-
-				// read in auxiliar buffer the information received in EMS Serial
-				int ptr = readBytes(auxBuffer, outEMSBuffer[4] + EMS_DATAGRAM_OVERHEAD, timeout);
-
-				// if more than 4 bytes are read (datagram received)
-				// check if the CRC of the information received is correct and the operation type returned corresponds with the one requested
-				if ((ptr > 4) && crcCheckOK(auxBuffer, ptr) && (auxBuffer[2] == messageID))
-				{
-					// copy the bytes read from auxiliarBuffer to inEMSBuffer taking into account the internal offset (reconstruct the EMS Datagram)
-					for (int i = 0; i < outEMSBuffer[4]; i++)
-					{
-						inEMSBuffer[i + 4 + auxBuffer[3]] = auxBuffer[i + 4];
-					}
-
-					// update the length and offset values to prepare the read of the next block
-					length -= (length >(MAX_EMS_READ - EMS_DATAGRAM_OVERHEAD) ? (MAX_EMS_READ - EMS_DATAGRAM_OVERHEAD) : length);
-					offset += (MAX_EMS_READ - EMS_DATAGRAM_OVERHEAD);
-				}
-			}
-		}
-	}
-
-	return (length == 0);
-}
-
-
-/**
- * Generic method to send an EMS set command with 1 data byte and check if the configuration
- * change request has been correctly performed.
- *
- * @param	destinationID	The destinationID of the EMS device.
- * @param	messageID	 	The messageID where the configuration is.
- * @param	offset		 	The offset of the data inside the message.
- * @param	data		 	The data/configuration to be set.
- *
- * @return	True if it succeeds, false otherwise.
- */
-
-boolean Calduino::setEMSCommand(byte destinationID, byte messageID, byte offset, byte data)
-{
-	boolean operationStatus = false;
-
-	byte outEMSBuffer[OUT_EMS_BUFFER_SIZE];
-	byte inEMSBuffer[OUT_EMS_BUFFER_SIZE];
-
-	unsigned long timeout;
-
-	// First load outEMSBuffer with corresponding values for a SET Command
-	// first position is the transmitterID. Ox0b is the ComputerID (our address)
-	outEMSBuffer[0] = DeviceID::PC;
-
-	// second position is destinationID.
-	outEMSBuffer[1] = destinationID;
-
-	// third position is the messageID
-	outEMSBuffer[2] = messageID;
-
-	// fourth position is the offset in the buffer.
-	outEMSBuffer[3] = offset;
-
-	// fifth position is the data to send
-	outEMSBuffer[4] = data;
-
-	// once the buffer is loaded, send the request.
-	if (sendRequest(outEMSBuffer))
-	{
-		// check if the requested query is answered in the next EMSMaxWaitTime milliseconds
-		timeout = millis() + EMSMaxWaitTime;
-
-		// wait until timeout or some new data in the EMS-Bus
-		while ((millis() < timeout) && (!calduinoSerial.available())) {}
-
-		// if there is data to be read
-		if (calduinoSerial.available())
-		{
-			// search confirmation datagram
-			int ptr = readBytes(inEMSBuffer, 1, timeout);
-
-			// if the answer received is 0x01, the value has been correctly sent, return with false otherwise
-			if (inEMSBuffer[0] != 0x01)
-			{
-				return false;
-			}
-		}
-		else
-		{
-			return false;
-		}
-	}
-	else
-	{
-		return false;
-	}
-	// Second Load outEMSBuffer with corresponding values for a GET Command and check if value received matches
-	// second position is destinationID. Masked with 0x80 as a read command
-	outEMSBuffer[1] = destinationID | 0x80;
-
-	// fifth position is the length of the data requested.
-	outEMSBuffer[4] = 1;
-
-	// once the buffer is loaded, send the request.
-	if (sendRequest(outEMSBuffer))
-	{
-		// check if the requested query is answered in the next EMSMaxWaitTime milliseconds
-		timeout = millis() + EMSMaxWaitTime;
-
-		// wait until timeout or some new data in the EMS-Bus
-		while ((millis() < timeout) && (!calduinoSerial.available())) {}
-
-		// if there is data to be read
-		if (calduinoSerial.available())
-		{
-			// read the information sent
-			int ptr = readBytes(inEMSBuffer, OUT_EMS_BUFFER_SIZE, timeout);
-
-			// if more than 4 bytes are read (datagram received)
-			// the CRC of the information received is correct
-			// and the operation type returned corresponds with the one requested
-			if ((ptr > 4) && crcCheckOK(inEMSBuffer, ptr) && (inEMSBuffer[2] == messageID))
-			{
-				// check if the data received corresponds with the change requested
-				operationStatus = ((data == (uint8_t)inEMSBuffer[4]));
-			}
-		}
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Generic method to get an EMS Datagram. By default will obtain the whole EMSDatagram message
- * Length bytes. To obtain only a Calduino Data, set accordingly length and offset parameters.
- *
- * @param [out]	inEMSBuffer	Pointer to the buffer where the EMS Datagram received will be saved.
- * 							It will always have the size of the whole EMS Message, no matter if
- * 							only a Calduino Data is requested.
- * @param 	   	eMSDatagram	The EMSDatagram to obtain.
- * @param 	   	length	   	(Optional) The length of the Calduino Data.
- * @param 	   	offset	   	(Optional) The offset of the Calduino Data in the EMSBuffer.
- *
- * @return	True if it succeeds, false otherwise.
- */
-
-boolean Calduino::getEMSBuffer(byte* inEMSBuffer, EMSDatagram eMSDatagram, byte length = 0, byte offset = 0)
-{
-	boolean operationStatus;
-
-	// configure a timeout
-	unsigned long timeout = (long)millis() + EMSMaxWaitTime * RETRY_FACTOR * 2;
-
-	// get the EMS Datagram Bytes, repeat operation if failed until timeout
-	do
-	{
-		operationStatus = getEMSCommand(inEMSBuffer, eMSDatagram.destinationID, eMSDatagram.messageID, (length == 0 ? eMSDatagram.messageLength : length), (offset == 0 ? offset : offset - INITIAL_OFFSET));
-	} while ((millis() < timeout) && (!operationStatus));
-
-	return operationStatus;
-}
-
-/**
- * Get a Calduino Data of type Byte.
- *
- * @param	typeIdx	Identifier of the Calduino Data Byte requested.
- *
- * @return	The value of the Calduino Data requested, ERROR_VALUE otherwise.
- */
-
-byte Calduino::getCalduinoByteValue(ByteRequest typeIdx)
-{
-	byte result = ERROR_VALUE;
-
-	// get from program memory the CalduinoDataRequest
-	CalduinoDataRequest calduinoDataType;
-	memcpy_P(&calduinoDataType, &byteRequests[typeIdx], sizeof(CalduinoDataRequest));
-
-	// get from program memory the EMSDatagram
-	EMSDatagram eMSDatagram;
-	memcpy_P(&eMSDatagram, calduinoDataType.eMSDatagram, sizeof(EMSDatagram));
-
-	// get from program memory the CalduinoData 
-	CalduinoData calduinoData;
-	memcpy_P(&calduinoData, calduinoDataType.dataType, sizeof(CalduinoData));
-
-	// buffer where the EMS Datagram will be saved (size is message size plus EMS_DATAGRAM_OVERHEAD bytes to store the headers, CRC and break)
-	byte inEMSBuffer[eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD];
-
-	// get an EMS Buffer with the parameters requested. Length is 1 (byte) and offset is the position of the data type in the EMSBuffer
-	boolean operationStatus = getEMSBuffer(inEMSBuffer, eMSDatagram, 1, calduinoData.offset);
-
-	if (operationStatus)
-	{
-		result = calduinoData.decodeByteValue(inEMSBuffer);
-	}
-
-	return result;
-}
-
-
-/**
- * Get a Calduino Data of type Float.
- *
- * @param	typeIdx	Identifier of the Calduino Data Float requested.
- *
- * @return	The value of the Calduino Data requested, NAN otherwise.
- */
-
-float Calduino::getCalduinoFloatValue(FloatRequest typeIdx)
-{
-	float result = NAN;
-
-	// get from program memory the CalduinoDataRequest
-	CalduinoDataRequest calduinoDataType;
-	memcpy_P(&calduinoDataType, &floatRequests[typeIdx], sizeof(CalduinoDataRequest));
-
-	// get from program memory the EMSDatagram
-	EMSDatagram eMSDatagram;
-	memcpy_P(&eMSDatagram, calduinoDataType.eMSDatagram, sizeof(EMSDatagram));
-
-	// get from program memory the CalduinoData 
-	CalduinoData calduinoData;
-	memcpy_P(&calduinoData, calduinoDataType.dataType, sizeof(CalduinoData));
-
-	// buffer where the EMS Datagram will be saved (size is message size plus EMS_DATAGRAM_OVERHEAD bytes to store the headers, CRC and break)
-	byte inEMSBuffer[eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD];
-
-	// get an EMS Buffer with the parameters requested. Length is 1 or 2 (bytes) and offset is the position of the data type in the EMSBuffer
-	boolean operationStatus = getEMSBuffer(inEMSBuffer, eMSDatagram, calduinoData.floatBytes, calduinoData.offset);
-
-	if (operationStatus)
-	{
-		result = calduinoData.decodeFloatValue(inEMSBuffer);
-	}
-
-	return result;
-}
-
-
-/**
- * Get a Calduino Data of type ULong.
- *
- * @param	typeIdx	Identifier of the Calduino Data ULong requested.
- *
- * @return	The value of the Calduino Data requested, NAN otherwise.
- */
-
-unsigned long Calduino::getCalduinoUlongValue(ULongRequest typeIdx)
-{
-	unsigned long result = NAN;
-
-	// get from program memory the CalduinoDataRequest
-	CalduinoDataRequest calduinoDataType;
-	memcpy_P(&calduinoDataType, &uLongRequests[typeIdx], sizeof(CalduinoDataRequest));
-
-	// get from program memory the EMSDatagram
-	EMSDatagram eMSDatagram;
-	memcpy_P(&eMSDatagram, calduinoDataType.eMSDatagram, sizeof(EMSDatagram));
-
-	// get from program memory the CalduinoData 
-	CalduinoData calduinoData;
-	memcpy_P(&calduinoData, calduinoDataType.dataType, sizeof(CalduinoData));
-
-	// buffer where the EMS Datagram will be saved (size is message size plus EMS_DATAGRAM_OVERHEAD bytes to store the headers, CRC and break)
-	byte inEMSBuffer[eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD];
-
-	// get an EMS Buffer with the parameters requested. Length is 3 (bytes) and offset is the position of the data type in the EMSBuffer
-	boolean operationStatus = getEMSBuffer(inEMSBuffer, eMSDatagram, 3, calduinoData.offset);
-
-	if (operationStatus)
-	{
-		result = calduinoData.decodeULongValue(inEMSBuffer);
-	}
-
-	return result;
-}
-
-
-/**
- * Get a Calduino Data of type Bit.
- *
- * @param	typeIdx	Identifier of the Calduino Data Bit requested.
- *
- * @return	The value of the Calduino Data requested, false otherwise.
- */
-
-boolean Calduino::getCalduinoBitValue(BitRequest typeIdx)
-{
-	boolean result = NAN;
-
-	// get from program memory the CalduinoDataRequest
-	CalduinoDataRequest calduinoDataType;
-	memcpy_P(&calduinoDataType, &bitRequests[typeIdx], sizeof(CalduinoDataRequest));
-
-	// get from program memory the EMSDatagram
-	EMSDatagram eMSDatagram;
-	memcpy_P(&eMSDatagram, calduinoDataType.eMSDatagram, sizeof(EMSDatagram));
-
-	// get from program memory the CalduinoData 
-	CalduinoData calduinoData;
-	memcpy_P(&calduinoData, calduinoDataType.dataType, sizeof(CalduinoData));
-
-	// buffer where the EMS Datagram will be saved (size is message size plus EMS_DATAGRAM_OVERHEAD bytes to store the headers, CRC and break)
-	byte inEMSBuffer[eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD];
-
-	// get an EMS Buffer with the parameters requested. Length is 1 (byte) and offset is the position of the data type in the EMSBuffer
-	boolean operationStatus = getEMSBuffer(inEMSBuffer, eMSDatagram, 1, calduinoData.offset);
-
-	if (operationStatus)
-	{
-		result = calduinoData.decodeBitValue(inEMSBuffer);
-	}
-
-	return result;
-}
-
-
-/**
- * Get a Calduino Data of type Switch Point.
- *
- * @param	selProgram   	Identifier of the Calduino Data Bit requested.
- * @param	switchPointID	Identifier for the switch point.
- *
- * @return	The value of the Calduino Data requested, false otherwise.
- */
-
-SwitchPoint Calduino::getCalduinoSwitchPoint(EMSDatagramID selProgram, byte switchPointID)
-{
-	SwitchPoint result;
-	
-	if (((selProgram == EMSDatagramID::Program_1_HC_1) || (selProgram == EMSDatagramID::Program_2_HC_1) ||
-		(selProgram == EMSDatagramID::Program_1_HC_2) || (selProgram == EMSDatagramID::Program_2_HC_2) ||
-		(selProgram == EMSDatagramID::Program_1_HC_3) || (selProgram == EMSDatagramID::Program_2_HC_3) ||
-		(selProgram == EMSDatagramID::Program_1_HC_4) || (selProgram == EMSDatagramID::Program_2_HC_4) ||
-		(selProgram == EMSDatagramID::Program_DHW) || (selProgram == EMSDatagramID::Program_Pump_DHW)) &&
-		(switchPointID < SWITCHING_POINTS))
-	{
-		// get from program memory the EMSDatagram
-		EMSDatagram eMSDatagram;
-		memcpy_P(&eMSDatagram, eMSDatagramIDs[selProgram], sizeof(EMSDatagram));
-
-		// get from program memory the CalduinoData 
-		CalduinoData calduinoData;
-		memcpy_P(&calduinoData, &eMSDatagram.data[switchPointID], sizeof(CalduinoData));
-
-		// buffer where the EMS Datagram will be saved (size is message size plus EMS_DATAGRAM_OVERHEAD bytes to store the headers, CRC and break)
-		byte inEMSBuffer[eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD];
-
-		// get an EMS Buffer with the parameters requested. Length is 2 (bytes) and offset is the position of the data type in the EMSBuffer
-		boolean operationStatus = getEMSBuffer(inEMSBuffer, eMSDatagram, 2, calduinoData.offset);
-
-		if (operationStatus)
-		{
-			result = calduinoData.decodeSwitchPoint(inEMSBuffer);
-		}
-	}
-
-	return result;
-}
-
-/**
- * Get the EMS Datagram passed as parameter by sending a get EMS command and parsing the bytes
- * obtained. If datagramDataIndex is ERROR_VALUE, get the whole datagram. Get only the Data
- * Index otherwise. If debug is activated the results will be sent to the Debug Serial Stream
- * following the print format activated.
- *
- * @param	eMSDatagramID	 	- The EMS Datagram ID to be obtained.
- * @param	datagramDataIndex	- (Optional) If not ERROR_VALUE, the position that the data to be
- * 								recovered occupies in the calduinoDataValues array.
- *
- * @return	True if it succeeds, false otherwise.
- */
-
-boolean Calduino::printEMSDatagram(EMSDatagramID eMSDatagramID, DatagramDataIndex datagramDataIndex = ERROR_VALUE)
-{
-	// buffer where the char buffer will be saved
-	char textBuffer[TEXT_BUFFER_SIZE];
-
-	// get from program memory the EMS Datagram passed as parameter
-	EMSDatagram eMSDatagram;
-	memcpy_P(&eMSDatagram, eMSDatagramIDs[eMSDatagramID], sizeof(EMSDatagram));
-
-	// print the EMS Datagram Header Tag
-	eMSDatagram.printMessageName(textBuffer, true, printFormat);
-	DPRINTLN(textBuffer);
-
-	// if only one data is requested, obtain the calduinoData
-	CalduinoData calduinoData;
-	if (datagramDataIndex != ERROR_VALUE)
-	{
-		memcpy_P(&calduinoData, &eMSDatagram.data[datagramDataIndex], sizeof(CalduinoData));
-	}
-	
-	// buffer where the EMS Datagram will be saved (size is message size plus 5 bytes to store the headers, CRC and break)
-	byte inEMSBuffer[eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD];
-
-	// launch the get EMS Buffer operation. Depending on the datagramDataIndex value it will
-	// require the whole datagram (length = 0) or just 3 bytes (maximum size of a Data Type). 
-	boolean operationStatus = getEMSBuffer(inEMSBuffer, eMSDatagram, (datagramDataIndex == ERROR_VALUE ? 0 : 3), (datagramDataIndex == ERROR_VALUE ? 0 : calduinoData.offset));
-
-	if (operationStatus)
-	{
-		// Print all the values of the datagram or just the requested, depending on datagramDataIndex
-		// value. 
-		if (datagramDataIndex == ERROR_VALUE)
-		{
-			// decode and print each value contained in the EMS Datagram
-			for (int i = 0; i < eMSDatagram.dataSize; i++)
-			{
-				memcpy_P(&calduinoData, &eMSDatagram.data[i], sizeof(CalduinoData));
-
-				char value[15];
-				calduinoData.decodeValue(inEMSBuffer, value);
-				calduinoData.printfValue(textBuffer, value, printFormat);
-				DPRINTLN(textBuffer);
-			}
-		}
-		else
-		{
-			// decode and print only the value requested
-			char value[15];
-			calduinoData.decodeValue(inEMSBuffer, value);
-			calduinoData.printfValue(textBuffer, value, printFormat);
-			DPRINTLN(textBuffer);
-
-		}
-
-	}
-	else
-	{
-		// print the EMS Datagram Error Tag
-		eMSDatagram.printErrorTag(textBuffer, printFormat);
-		DPRINTLN(textBuffer);
-	}
-
-	// print the EMS Datagram Tail Tag
-	eMSDatagram.printMessageName(textBuffer, false, printFormat);
-	DPRINTLN(textBuffer);
-
-	return operationStatus;
-}
-
-
-/**
- * Send a Set Command updating the value of the data situaded in CalduinoDataValuesIndex of
- * eMSDatagramID. If debug is activated the result of the operation will be sent to the Debug
- * Serial Stream following the selected print format.
- *
- * @param	eMSDatagramID	 	- The EMSDatagram to be updated.
- * @param	calduinoDataIndex	- The position that the value to be updated occupies in the
- * 									calduinoDataValues array.
- * @param	data			 	- The data/value to be assigned.
- * @param	extraOffset		 	(Optional) - An extra offset to apply to the EMS Command offset,
- * 								in case this data type uses two or more bytes (Switch Point).
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::updateEMSDatagram(EMSDatagramID eMSDatagramID, DatagramDataIndex datagramDataIndex, byte data, byte extraOffset = 0)
-{
-	boolean operationStatus = false;
-
-	// buffer where the char buffer str will be saved
-	char textBuffer[TEXT_BUFFER_SIZE];
-
-	// get from program memory the EMS Datagram passed as parameter
-	EMSDatagram eMSDatagram;
-	memcpy_P(&eMSDatagram, eMSDatagramIDs[eMSDatagramID], sizeof(EMSDatagram));
-
-	// print the EMS Datagram Header Tag
-	eMSDatagram.printMessageName(textBuffer, true, printFormat);
-	DPRINTLN(textBuffer);
-
-	// get from program memory the Calduino Data  of the configuration to be changed 
-	CalduinoData calduinoData;
-	memcpy_P(&calduinoData, &eMSDatagram.data[datagramDataIndex], sizeof(CalduinoData));
-
-	// get the EMS Datagram Bytes, repeat operation if failed until timeout
-	unsigned long timeout = millis() + EMSMaxWaitTime * RETRY_FACTOR;
-
-	// get the EMS Datagram Bytes, repeat operation if failed until timeout
-	do
-	{
-		operationStatus = setEMSCommand(eMSDatagram.destinationID, eMSDatagram.messageID, calduinoData.offset - INITIAL_OFFSET + extraOffset, data);
-	} while ((millis() < timeout) && (!operationStatus));
-
-	// if success and debug activated, print the set value
-	if (operationStatus)
-	{
-		char value[10];
-		// consider floats as signed values
-		sprintf_P(value, decimal, (calduinoData.encodeType == CalduinoEncodeType::Byte ? (uint8_t)data : (int8_t)data));
-		calduinoData.printfValue(textBuffer, value, printFormat);
-		DPRINTLN(textBuffer);
-	}
-	else
-	{
-		// print the EMS Datagram Error Tag
-		eMSDatagram.printErrorTag(textBuffer, printFormat);
-		DPRINTLN(textBuffer);
-	}
-
-	// print the EMS Datagram Tail Tag
-	eMSDatagram.printMessageName(textBuffer, false, printFormat);
-	DPRINTLN(textBuffer);
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to set the selected RC35 heating circuit to the desired Mode
- *
- * @param	selHC  	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
- * @param	selMode	The selected working mode to be configured (0-night, 1-day, 2-auto/program).
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setWorkModeHC(byte selHC, byte selMode)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected heating circuit exists
-	// evaluate if the selected mode exists
-	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (selMode <= MAX_WORKING_MODE))
-	{
-		// Working Mode is in position 5 of eMSDatagram.Values array in Working_Mode_HC_selHC
-		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_HC_1 + (selHC - 1) * 4, 5, selMode);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to set in the selected RC35 heating circuit and Mode, the desired
- * temperature.
- *
- * @param	selHC  	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
- * @param	selMode	The working mode to be configured (0-night, 1-day, 2-holidays).
- * @param	selTmp 	The desired temperature (multiplied by two, originally in increments of 0,5).
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setTemperatureHC(byte selHC, byte selMode, byte selTmp)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected heating circuit exists
-	// evaluate if the selected mode exists
-	// evaluate if the selected temperature is inside limits
-	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (selMode <= MAX_WORKING_MODE) && (selTmp <= MAX_TEMPERATURE * 2) && (selTmp >= MIN_TEMPERATURE * 2))
-	{
-		// Data Type SelNight/Day/Holi Temp is in position 0 to 2 (selMode) of EMS Datagram Values array in EMS Datagram Working_Mode_HC_selHC
-		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_HC_1 + (selHC - 1) * 4, selMode, selTmp);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to set the selected RC35 heating circuit to the desired program.
- * @selHC the heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
- * @selProgram the working program to set (0x00 = User 1, 0x01 = Family, 0x02 = Morning, 0x03 =
- * Early morning, 0x04 = Evening, 0x05 = Midmorning, 0x06 = Afternoon, 0x07 = Midday, 0x08 =
- * Single, 0x09 = Senioren, 0x0A User2).
- *
- * @param	selHC	  	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
- * @param	selProgram	The the working program to set (0x00 = User 1, 0x01 = Family, 0x02 =
- * 						Morning, 0x03 = Early morning, 0x04 = Evening, 0x05 = Midmorning, 0x06 =
- * 						Afternoon, 0x07 = Midday, 0x08 = Single, 0x09 = Senioren, 0x0A User2).
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setProgramHC(byte selHC, byte selProgram)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected heating circuit exists
-	// evaluate if the selected program exists
-	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (selProgram <= MAX_PROGRAM))
-	{
-		// Data Type programName is in position 42 of eMSDatagram.Values array in EMS Datagram Program_1_HC_selHC
-		operationStatus = updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::programNameIdx, selProgram);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to configure the temperature for summer / winter threshold switchpoint in
- * the selected heating circuit.
- *
- * @param	selHC 	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
- * @param	selTmp	The desired Summer / Winter Threshold temperature.
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setSWThresholdTempHC(byte selHC, byte selTmp)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected heating circuit exists
-	// evaluate if the selected program exists
-	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (selTmp <= MAX_SUMMER_WINTER_THRESHOLD) && (selTmp >= MIN_SUMMER_WINTER_THRESHOLD))
-	{
-		// Data Type sWThresTempHC is in position 6 of eMSDatagram.Values array in EMS Datagram Working_Mode_HC_selHC
-		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_HC_1 + (selHC - 1) * 4, DatagramDataIndex::sWThresTempHCIdx, selTmp);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to configure the night setback mode in the selected heating circuit.
- *
- * @param	selHC  	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
- * @param	selMode	The desired setback mode (0 - Shutdown, 1 - Reduced Operation, 2 - Room
- * 					Setback, 3 - Outdoor Setback).
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setNightSetbackModeHC(byte selHC, byte selMode)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected heating circuit exists
-	// evaluate if the selected program exists
-	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (selMode <= MAX_SETBACK_MODE))
-	{
-		// Data Type nightSetbackMode is in position 7 of eMSDatagram.Values array in EMS Datagram Working_Mode_HC_selHC
-		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_HC_1 + (selHC - 1) * 4, DatagramDataIndex::nightSetbackHCIdx, selMode);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to configure the night setback outside temperature threshold in the
- * selected heating circuit. This temperature is only considered if night setback mode is set to
- * 3 (Outdoor Setback).
- *
- * @param	selHC 	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
- * @param	selTmp	The desired outside temperature to switch between shutdown and reduced mode.
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setNightThresholdOutTempHC(byte selHC, int8_t selTmp)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected heating circuit exists
-	// evaluate if the temperature is inside limits
-	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (selTmp <= MAX_OUT_NIGHT_THRESHOLD) && (selTmp >= MIN_OUT_NIGHT_THRESHOLD))
-	{
-		// Data Type sWThresTempHC is in position 8 of eMSDatagram.Values array in EMS Datagram Working_Mode_HC_selHC
-		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_HC_1 + (selHC - 1) * 4, DatagramDataIndex::nightOutTempHCIdx, selTmp);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to configure the room temperature offset in the selected heating circuit.
- * This value shifts left and right the heating characteristic curve.
- *
- * @param	selHC 	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
- * @param	selTmp	The desired offset temperature.
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setRoomTempOffsetHC(byte selHC, int8_t selTmp)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected heating circuit exists
-	// evaluate if the temperature is inside limits
-	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (selTmp <= MAX_ROOM_TEMPERATURE_OFFSET * 2) && (selTmp >= MIN_ROOM_TEMPERATURE_OFFSET * 2))
-	{
-		// Data Type roomTempOffHC is in position 4 of eMSDatagram.Values array in EMS Datagram Working_Mode_HC_selHC
-		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_HC_1 + (selHC - 1) * 4, DatagramDataIndex::roomTempOffHCIdx, selTmp);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to configure pause mode in duration hours in the selected heating circuit.
- *
- * @param	selHC   	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
- * @param	duration	The desired duration of the pause mode.
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setPauseModeHC(byte selHC, byte duration)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected heating circuit exists
-	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT))
-	{
-		// Data Type pauseTime is in position 43 of eMSDatagram.Values array in EMS Datagram Program_1_HC_selHC
-		operationStatus = updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::pauseTimeIdx, duration);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to configure party mode in duration hours in the selected heating circuit.
- * @selHC the heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
- * @duration the desired duration of the party mode.
- *
- * @param	selHC   	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
- * @param	duration	The desired duration of the party mode.
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setPartyModeHC(byte selHC, byte duration)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected heating circuit exists
-	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT))
-	{
-		// Data Type party is in position 44 of eMSDatagram.Values array in EMS Datagram Program_1_HC_selHC
-		operationStatus = updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::partyTimeIdx, duration);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to configure Holidays mode between start and end daySwitchPoint.
- *
- * @param	selHC			  	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4
- * 								is HC4).
- * @param	startHolidayDay   	The start holiday day.
- * @param	startHoldidayMonth	The start holdiday month.
- * @param	startHolidayYear  	The start holiday year.
- * @param	endHolidayDay	  	The end holiday dat.
- * @param	endHoldidayMonth  	The end holdiday month.
- * @param	endHolidayYear	  	The end holiday year.
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setHolidayModeHC(byte selHC, byte startHolidayDay, byte startHoldidayMonth, byte startHolidayYear, byte endHolidayDay, byte endHoldidayMonth, byte endHolidayYear)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected heating circuit exists
-	// evaluate if the selected daySwitchPoint and month exists
-	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (startHolidayDay <= MAX_DAY) && (endHolidayDay <= MAX_DAY) && (startHoldidayMonth <= MAX_MONTH) && (endHoldidayMonth <= MAX_MONTH))
-	{
-		// Data Type startHolidayDay is in position 45, startHoldidayMonth 46, startHolidayYear 47 of eMSDatagram.Values array in EMS Datagram Program_1_HC_selHC
-		operationStatus = updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::startHolidayDayIdx, startHolidayDay);
-		operationStatus &= updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::startHolidayMonthIdx, startHoldidayMonth);
-		operationStatus &= updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::startHolidayYearIdx, startHolidayYear);
-
-		// Data Type endHolidayDay is in position 48, endHoldidayMonth 49, endHolidayYear 50 of eMSDatagram.Values array in EMS Datagram Program_1_HC_selHC
-		operationStatus &= updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::endHolidayDayIdx, endHolidayDay);
-		operationStatus &= updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::endHolidayMonthIdx, endHoldidayMonth);
-		operationStatus &= updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::endHolidayYearIdx, endHolidayYear);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to configure Home Holiday mode (saturday configuration) between start and
- * end daySwitchPoint.
- *
- * @param	selHC				  	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3
- * 									and 4 is HC4).
- * @param	startHomeHolidayDay   	The start home holiday day.
- * @param	startHomeHoldidayMonth	The start home holdiday month.
- * @param	startHomeHolidayYear  	The start home holiday year.
- * @param	endHomeHolidayDay	  	The end home holiday.
- * @param	endHomeHoldidayMonth  	The end home holdiday month.
- * @param	endHomeHolidayYear	  	The end home holiday year.
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setHomeHolidayModeHC(byte selHC, byte startHomeHolidayDay, byte startHomeHoldidayMonth, byte startHomeHolidayYear, byte endHomeHolidayDay, byte endHomeHoldidayMonth, byte endHomeHolidayYear)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected heating circuit exists
-	// evaluate if the selected daySwitchPoint and month exists
-	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (startHomeHolidayDay <= MAX_DAY) && (endHomeHolidayDay <= MAX_DAY) && (startHomeHoldidayMonth <= MAX_MONTH) && (endHomeHoldidayMonth <= MAX_MONTH))
-	{
-		// Data Type startHomeHolidayDay is in position 51, startHomeHoldidayMonth 52, startHomeHolidayYear 53 of eMSDatagram.Values array in EMS Datagram Program_1_HC_selHC
-		operationStatus = updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::startHomeHolidayDayIdx, startHomeHolidayDay);
-		operationStatus &= updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::startHomeHolidayMonthIdx, startHomeHoldidayMonth);
-		operationStatus &= updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::startHomeHolidayYearIdx, startHomeHolidayYear);
-
-		// Data Type endHomeHolidayDay is in position 54, endHomeHoldidayMonth 55, endHomeHolidayYear 56 of eMSDatagram.Values array in EMS Datagram Program_1_HC_selHC
-		operationStatus &= updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::endHomeHolidayDayIdx, endHomeHolidayDay);
-		operationStatus &= updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::endHomeHolidayMonthIdx, endHomeHoldidayMonth);
-		operationStatus &= updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::endHomeHolidayYearIdx, endHomeHolidayYear);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to set the DHW working mode.
- * @selMode the working mode to be configured (0-off, 1-on, 2-auto)
- *
- * @param	selMode	The working mode to be configured (0-off, 1-on, 2-auto).
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setWorkModeDHW(byte selMode)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected mode exists
-	if (selMode <= MAX_WORKING_MODE)
-	{
-		// Working Mode is in position 2 of eMSDatagram.Values array in Working_Mode_DHW
-		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_DHW, 2, selMode);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to set the DHW Pump working mode.
- *
- * @param	selMode	The working mode to be configured (0-off, 1-on, 2-auto)
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setWorkModePumpDHW(byte selMode)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected mode exists
-	if (selMode <= MAX_WORKING_MODE)
-	{
-		// Working Mode is in position 3 of eMSDatagram.Values array in Working_Mode_DHW
-		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_DHW, DatagramDataIndex::workModePumpDHWIdx, selMode);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to set the desired temperature in the Domestic How Water System.
- *
- * @param	selTmp	The desired temperature to be configured.
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setTemperatureDHW(byte selTmp)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected temperature is inside limits
-	if ((selTmp <= MAX_DHW_TEMPERATURE) && (selTmp >= MIN_DHW_TEMPERATURE))
-	{
-		// Data Type selTempDHW is in position 0 of EMS Datagram Values array in EMS Datagram UBA_Parameter_DHW
-		operationStatus = updateEMSDatagram(EMSDatagramID::UBA_Parameter_DHW, DatagramDataIndex::selTempDHWIdx, selTmp);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to set the desired disinfection temperature in the Domestic How Water
- * System.
- *
- * @param	selTmp	The desired temperature to be configured.
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setTemperatureTDDHW(byte selTmp)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected temperature is inside limits
-	if ((selTmp <= MAX_DHW_TEMPERATURE) && (selTmp >= MIN_DHW_TEMPERATURE))
-	{
-		// Data Type disinfTempDHW is in position 1 of EMS Datagram Values array in EMS Datagram UBA_Parameter_DHW
-		operationStatus = updateEMSDatagram(EMSDatagramID::UBA_Parameter_DHW, DatagramDataIndex::tempTDDHWIdx, selTmp);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to change the DHW program.
- *
- * @param	selProgram	The working program to be set (0 = like the heating circuit, 255 = own
- * 						program).
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setProgramDHW(byte selProgram)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected mode exists (0 or 255)
-	if ((selProgram == 0) || (selProgram == ERROR_VALUE))
-	{
-		// progDHW is in position 0 of eMSDatagram.Values array in Working_Mode_DHW
-		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_DHW, DatagramDataIndex::progDHWIdx, selProgram);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to change the Pump DHW program.
- *
- * @param	selProgram	The working program to be set (0 = like the heating circuit, 255 = own
- * 						program).
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setProgramPumpDHW(byte selProgram)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected mode exists (0 or 255)
-	if ((selProgram == 0) || (selProgram == ERROR_VALUE))
-	{
-		// progPumpDHW is in position 1 of eMSDatagram.Values array in Working_Mode_DHW
-		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_DHW, DatagramDataIndex::progPumpDHWIdx, selProgram);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to change the thermal disinfection DHW working mode.
- *
- * @param	selMode	255 to enable thermal disinfection DHW function, 0 to disable it.
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setWorkModeTDDHW(byte selMode)
-{
-	boolean operationStatus = false;
-	
-	// evaluate if the selected mode exists (0 or 255)
-	if ((selMode == 0) || (selMode == ERROR_VALUE))
-	{
-		// workModeTDDHW is in position 4 of eMSDatagram.Values array in Working_Mode_DHW
-		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_DHW, DatagramDataIndex::workModeTDDHWIdx, selMode);
-	}
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to change the thermal disinfection DHW running day. It will run once per week
- * at the selected daySwitchPoint and hour, or once per day if dayTDDHW is 7.
- *
- * @param	dayTDDHW 	Day of the week to run the thermal disinfection (7 is everyday).
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setDayTDDHW(byte dayTDDHW)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected dayTDDHW is correct
-	if (dayTDDHW <= MAX_DAY_WEEK)
-	{
-		// dayTDDHW is in position 5 of eMSDatagram.Values array in Working_Mode_DHW
-		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_DHW, DatagramDataIndex::dayTDDHWIdx, dayTDDHW);
-	}
-
-	return operationStatus;
-}
-
-/**
-* Send an EMS command to change the thermal disinfection DHW program. It will run once per week
-* at the selected daySwitchPoint and hour, or once per day if dayTDDHW is 7.
-*
-* @param	hourTDDHW	Hour of the week to run the thermal disinfection.
-*
-* @return	True if it succeeds, false if it fails.
-*/
-
-boolean Calduino::setHourTDDHW(byte hourTDDHW)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected hourTDDHW is2 correct
-	if (hourTDDHW < MAX_HOUR_DAY)
-	{
-		// desHourDHW is in position 6 of eMSDatagram.Values array in Working_Mode_DHW
-		operationStatus &= updateEMSDatagram(EMSDatagramID::Working_Mode_DHW, DatagramDataIndex::hourTDDHWIdx, hourTDDHW);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to change an specific switch point in the program passed as parameter.
- *
- * @param	selProgram				The selected program to be updated.
- * @param	switchPointID			Identifier for the switch point.
- * @param	operationSwitchPoint	The operation to be performed in the switch point (0 -
- * 									off/night, 1 - on/day, 7 - undefined).
- * @param	daySwitchPoint			Day of the week (0 - monday, ..., 6 - sunday).
- * @param	hourSwitchPoint			Hour of the day (0 to 23).
- * @param	minuteSwitchPoint   	Minute (The minimum time between switching points is 10 min).
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setProgramSwitchPoint(EMSDatagramID selProgram, byte switchPointID, byte operationSwitchPoint, byte daySwitchPoint, byte hourSwitchPoint, byte minuteSwitchPoint)
-{
-	boolean operationStatus = false;
-
-	// evaluate if the selected selProgram is correct
-	// evaluate if the switch point is inside limits
-	// evaluate if the operationSwitchPoint is correct
-	// evaluate if the daySwitchPoint time is correct
-	if (((selProgram == EMSDatagramID::Program_DHW) || (selProgram == EMSDatagramID::Program_Pump_DHW) ||
-		(selProgram == EMSDatagramID::Program_1_HC_1) || (selProgram == EMSDatagramID::Program_2_HC_1) ||
-		(selProgram == EMSDatagramID::Program_1_HC_2) || (selProgram == EMSDatagramID::Program_2_HC_2) ||
-		(selProgram == EMSDatagramID::Program_1_HC_3) || (selProgram == EMSDatagramID::Program_2_HC_3) ||
-		(selProgram == EMSDatagramID::Program_1_HC_4) || (selProgram == EMSDatagramID::Program_2_HC_4)) &&
-		(switchPointID < SWITCHING_POINTS) &&
-		((operationSwitchPoint == 0) || (operationSwitchPoint == 1) || (operationSwitchPoint == 7)) &&
-		(daySwitchPoint < MAX_DAY_WEEK) &&
-		(hourSwitchPoint < MAX_HOUR_DAY) &&
-		((minuteSwitchPoint < MAX_MINUTE_HOUR) && (minuteSwitchPoint % 10 == 0)))
-	{
-		byte byte1 = (operationSwitchPoint == 7) ? 0xE7 : (0x00 | (daySwitchPoint << 5) | (operationSwitchPoint));
-		byte byte2 = (operationSwitchPoint == 7) ? 0x90 : ((hourSwitchPoint * 6) + (minuteSwitchPoint / 10));
-		
-		operationStatus = updateEMSDatagram(selProgram, switchPointID, byte1);
-		operationStatus = updateEMSDatagram(selProgram, switchPointID, byte2 , 1);
-	}
-
-	return operationStatus;
-}
-
-
-/**
- * Send an EMS command to set the warm watter one time function on or off.
- *
- * @param	selMode	True to enable one time function, false to disable it.
- *
- * @return	True if it succeeds, false if it fails.
- */
-
-boolean Calduino::setOneTimeDHW(boolean selMode)
-{
-	boolean operationStatus;
-
-	operationStatus = updateEMSDatagram(EMSDatagramID::Flags_DHW, DatagramDataIndex::oneTimeDHW2Idx, selMode ? DHW_ONETIME_ON: DHW_ONETIME_OFF);
-	operationStatus |= getCalduinoBitValue(BitRequest::oneTimeDHW_t);
-	return operationStatus;
-}
-
-#pragma endregion Calduino
-
-
+/*
+* Copyright (c) 2018 Daniel Macías Perea (dani.macias.perea@gmail.com)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+* Legal Notices
+* 'Bosch Group', 'Buderus', 'Nefit' and 'Worcester' are brands of Bosch Thermotechnology.
+* All other trademarks are the property of their respective owners.
+*/
+
+
+/**
+* @mainpage EMS Bus - Arduino library.
+*
+* This library provides functions to communicate through the EMS Bus with Buderus/Nefit/Worcester
+* (or any other EMS Bus compatible) boilers. It includes commands for both getting status information
+* (UBA Monitor, DHW Monitor, etc.) and setting new configurations (Set Day/Night Temperature,
+* Set Working Mode, etc.).
+*
+* @author	dani.macias.perea@gmail.com
+*/
+
+/**
+* @file Calduino.cpp
+* 		
+* @brief The Calduino class declaration including EMSSerial, CalduinoDebug, CalduinoSerial, Calduino Datagrams and Calduino Data Types.
+*
+*/
+
+#include "wiring_private.h"
+#include "Calduino.h"
+
+/* EMS max/min values and constants */
+#define MAX_HC_CIRCUIT 2
+#define MAX_WORKING_MODE 2
+#define MAX_SETBACK_MODE 3
+#define MAX_PROGRAM 10
+#define MAX_DHW_TEMPERATURE 80
+#define MIN_DHW_TEMPERATURE 40
+#define MAX_TEMPERATURE 29
+#define MIN_TEMPERATURE 6
+#define MAX_ROOM_TEMPERATURE_OFFSET 5
+#define MIN_ROOM_TEMPERATURE_OFFSET -5
+#define MAX_SUMMER_WINTER_THRESHOLD 30
+#define MIN_SUMMER_WINTER_THRESHOLD 10
+#define MAX_OUT_NIGHT_THRESHOLD 10
+#define MIN_OUT_NIGHT_THRESHOLD -20
+#define DHW_ONETIME_ON  39
+#define DHW_ONETIME_OFF 7
+#define MAX_DAY 31
+#define MAX_DAY_WEEK 7
+#define MAX_MONTH 12
+#define MAX_HOUR_DAY 24
+#define MAX_MINUTE_HOUR 60
+
+/* EMS Bus Serial Parameters */
+#define INITIAL_OFFSET 4
+#define OUT_EMS_BUFFER_SIZE 7
+#define EMS_DATAGRAM_OVERHEAD 6
+#define EMS_MAX_WAIT_TIME 1000
+#define RETRY_FACTOR 4
+#define EMS_POLL_SLOT_COST 16
+#define EMS_CHUNK_SIZE (MAX_EMS_READ - EMS_DATAGRAM_OVERHEAD)
+#define EMS_MAX_CHUNKS 16
+#define DISCOVERY_RETRY_FACTOR 2
+
+/* Adaptive Timeout Parameters */
+#define MIN_ADAPTIVE_TIMEOUT 100
+#define MAX_TIMEOUT_BACKOFF 4
+
+/* Circuit Breaker Parameters */
+#define BREAKER_FAILURES 3
+#define BREAKER_BACKOFF 10000
+#define BREAKER_MAX_BACKOFF 320000
+#define BREAKER_JITTER_DIVISOR 4
+
+/* Delta Reporting Parameters */
+#define CELSIUS_DEADBAND 5
+
+/* Message size*/
+#define RC_DATETIME_VALUES_COUNT 6
+#define RC_DATETIME_MESSAGE_SIZE 8
+#define UBA_WORKING_TIME_VALUES_COUNT 1
+#define UBA_WORKING_TIME_MESSAGE_SIZE 3
+#define UBA_MONITOR_FAST_VALUES_COUNT (0 UBA_MONITOR_FAST_VALUES(CALDUINO_DATA_COUNT))
+#define UBA_MONITOR_FAST_MESSAGE_SIZE 27
+#define UBA_MONITOR_SLOW_VALUES_COUNT (0 UBA_MONITOR_SLOW_VALUES(CALDUINO_DATA_COUNT))
+#define UBA_MONITOR_SLOW_MESSAGE_SIZE 25
+#define UBA_PARAMETER_DHW_VALUES_COUNT 2
+#define UBA_PARAMETER_DHW_MESSAGE_SIZE 11
+#define FLAGS_DHW_VALUES_COUNT 1
+#define FLAGS_DHW_MESSAGE_SIZE 1
+#define UBA_MONITOR_DHW_VALUES_COUNT 7
+#define UBA_MONITOR_DHW_MESSAGE_SIZE 16
+#define WORKING_MODE_DHW_VALUES_COUNT 7
+#define WORKING_MODE_DHW_MESSAGE_SIZE 10
+#define WORKING_MODE_HC_VALUES_COUNT (0 WORKING_MODE_HC_VALUES(CALDUINO_DATA_COUNT))
+#define WORKING_MODE_HC_MESSAGE_SIZE 42
+#define MONITOR_HC_VALUES_COUNT (0 MONITOR_HC_VALUES(CALDUINO_DATA_COUNT))
+#define MONITOR_HC_MESSAGE_SIZE 16
+#define MONITOR_MM_10_VALUES_COUNT 3
+#define MONITOR_MM_10_MESSAGE_SIZE 8
+#define SWITCHING_PROGRAM_1_VALUES_COUNT 57
+#define SWITCHING_PROGRAM_1_MESSAGE_SIZE 99
+#define SWITCHING_PROGRAM_2_VALUES_COUNT 42
+#define SWITCHING_PROGRAM_2_MESSAGE_SIZE 84
+
+/** EMSSerial definition */
+#pragma region EMSSERIAL
+
+// on ATmega8, the uart and its bits are not numbered, so there is no "TXC0"
+// definition.
+#if !defined(TXC0)
+#if defined(TXC)
+#define TXC0 TXC
+#elif defined(TXC1)
+// Some devices have uart1 but no uart0
+#define TXC0 TXC1
+#else
+#error TXC0 not definable in Calduino.h
+#endif
+#endif
+
+
+/**
+ * EMS CRC lookup table. Entry n is the CRC n shifted one position to the left, with the EMS
+ * polynomial (0x0C) applied when the most significant bit is set. Adding a byte to the CRC is
+ * then a lookup followed by an XOR with the byte.
+ */
+
+const uint8_t PROGMEM eMSCRCTable[256] = {
+	0x00, 0x02, 0x04, 0x06, 0x08, 0x0A, 0x0C, 0x0E, 0x10, 0x12, 0x14, 0x16, 0x18, 0x1A, 0x1C, 0x1E,
+	0x20, 0x22, 0x24, 0x26, 0x28, 0x2A, 0x2C, 0x2E, 0x30, 0x32, 0x34, 0x36, 0x38, 0x3A, 0x3C, 0x3E,
+	0x40, 0x42, 0x44, 0x46, 0x48, 0x4A, 0x4C, 0x4E, 0x50, 0x52, 0x54, 0x56, 0x58, 0x5A, 0x5C, 0x5E,
+	0x60, 0x62, 0x64, 0x66, 0x68, 0x6A, 0x6C, 0x6E, 0x70, 0x72, 0x74, 0x76, 0x78, 0x7A, 0x7C, 0x7E,
+	0x80, 0x82, 0x84, 0x86, 0x88, 0x8A, 0x8C, 0x8E, 0x90, 0x92, 0x94, 0x96, 0x98, 0x9A, 0x9C, 0x9E,
+	0xA0, 0xA2, 0xA4, 0xA6, 0xA8, 0xAA, 0xAC, 0xAE, 0xB0, 0xB2, 0xB4, 0xB6, 0xB8, 0xBA, 0xBC, 0xBE,
+	0xC0, 0xC2, 0xC4, 0xC6, 0xC8, 0xCA, 0xCC, 0xCE, 0xD0, 0xD2, 0xD4, 0xD6, 0xD8, 0xDA, 0xDC, 0xDE,
+	0xE0, 0xE2, 0xE4, 0xE6, 0xE8, 0xEA, 0xEC, 0xEE, 0xF0, 0xF2, 0xF4, 0xF6, 0xF8, 0xFA, 0xFC, 0xFE,
+	0x19, 0x1B, 0x1D, 0x1F, 0x11, 0x13, 0x15, 0x17, 0x09, 0x0B, 0x0D, 0x0F, 0x01, 0x03, 0x05, 0x07,
+	0x39, 0x3B, 0x3D, 0x3F, 0x31, 0x33, 0x35, 0x37, 0x29, 0x2B, 0x2D, 0x2F, 0x21, 0x23, 0x25, 0x27,
+	0x59, 0x5B, 0x5D, 0x5F, 0x51, 0x53, 0x55, 0x57, 0x49, 0x4B, 0x4D, 0x4F, 0x41, 0x43, 0x45, 0x47,
+	0x79, 0x7B, 0x7D, 0x7F, 0x71, 0x73, 0x75, 0x77, 0x69, 0x6B, 0x6D, 0x6F, 0x61, 0x63, 0x65, 0x67,
+	0x99, 0x9B, 0x9D, 0x9F, 0x91, 0x93, 0x95, 0x97, 0x89, 0x8B, 0x8D, 0x8F, 0x81, 0x83, 0x85, 0x87,
+	0xB9, 0xBB, 0xBD, 0xBF, 0xB1, 0xB3, 0xB5, 0xB7, 0xA9, 0xAB, 0xAD, 0xAF, 0xA1, 0xA3, 0xA5, 0xA7,
+	0xD9, 0xDB, 0xDD, 0xDF, 0xD1, 0xD3, 0xD5, 0xD7, 0xC9, 0xCB, 0xCD, 0xCF, 0xC1, 0xC3, 0xC5, 0xC7,
+	0xF9, 0xFB, 0xFD, 0xFF, 0xF1, 0xF3, 0xF5, 0xF7, 0xE9, 0xEB, 0xED, 0xEF, 0xE1, 0xE3, 0xE5, 0xE7
+};
+
+
+/**
+ * Updates an EMS CRC with a new byte.
+ *
+ * @param	crc	The CRC of the previous bytes.
+ * @param	c  	The new byte.
+ *
+ * @return	The CRC including the new byte.
+ */
+
+uint8_t crc_update(uint8_t crc, uint8_t c)
+{
+	return pgm_read_byte(&eMSCRCTable[crc]) ^ c;
+}
+
+/**
+ * Stores a character in the EMS Serial Buffer.
+ * This operation is called when a serial event is triggered. The CRC of the frame is updated
+ * with every data byte received and, when the break (frame error) arrives, the frame is closed
+ * and published in the frame queue. Frames containing only a break, frames that overflowed the
+ * buffer and frames that do not fit in the frame queue are discarded.
+ * While a frame is being transmitted, the bytes received are the echo of the bytes sent and are
+ * not stored: each echo triggers the transmission of the next byte, or of the break after the
+ * last one. A different echo (or a break) means another device is using the bus, so the
+ * transmission is aborted and a collision is reported.
+ *
+ * @author	Administrator
+ * @date	5/2/2018
+ *
+ * @param 		  	c 	Byte received.
+ * @param 		  	fe	Wether the bit error is activated or not.
+ * @param [in,out]	s 	The EMS Serial stream.
+ */
+
+void store_char(unsigned char c, bool fe, EMSSerial *s)
+{
+	PROFILE_SCOPE(ProfileSection::StoreChar);
+
+	if (s->_tx_busy)
+	{
+		if (fe || (c != s->_tx_buffer[s->_tx_index]))
+		{
+			s->_tx_collision = true;
+			s->_tx_busy = false;
+		}
+		else if (++s->_tx_index < s->_tx_length)
+		{
+			// echo received, send the next byte
+			*s->_udr = s->_tx_buffer[s->_tx_index];
+		}
+		else
+		{
+			// last echo received, halt temporarily reception, change parity to even and send a
+			// break-character. Settings are restored by the TX complete interrupt
+			cbi(*s->_ucsrb, s->_rxen);
+			s->_tx_ucsrc = *s->_ucsrc;
+			sbi(*s->_ucsrc, UPM01);
+			sbi(*s->_ucsra, TXC0);
+			sbi(*s->_ucsrb, s->_txcie);
+			*s->_udr = 0;
+		}
+		return;
+	}
+
+	int i = (unsigned int)(s->_rx_buffer_head + 1) % SERIAL_BUFFER_SIZE;
+
+	// if we should be storing the received character into the location
+	// just before the tail (meaning that the head would advance to the
+	// current location of the tail), we're about to overflow the buffer
+	// and so we don't write the character or advance the head.
+	if (i != s->_rx_buffer_tail) {
+		s->_rx_buffer[s->_rx_buffer_head] = c;
+		s->_error_flag[s->_rx_buffer_head] = fe;
+		s->_rx_buffer_head = i;
+		s->_frame_length++;
+	}
+	else {
+		s->_frame_overflow = true;
+	}
+
+	if (!fe)
+	{
+		// update the CRC of the frame, keeping the value calculated before this byte (if this is
+		// the last byte before the break, it is the CRC of the frame)
+		s->_frame_prev_crc = s->_frame_crc;
+		s->_frame_crc = crc_update(s->_frame_crc, c);
+		return;
+	}
+
+	// break received, close the current frame
+	uint8_t nextFrame = (s->_frame_head + 1) % EMS_FRAME_QUEUE_SIZE;
+
+	if ((s->_frame_length > 1) && (!s->_frame_overflow) && (nextFrame != s->_frame_tail))
+	{
+		// CRC is the last data byte, just before the break
+		uint8_t crcPosition = (s->_frame_start + s->_frame_length - 2) % SERIAL_BUFFER_SIZE;
+
+		s->_frames[s->_frame_head].start = s->_frame_start;
+		s->_frames[s->_frame_head].length = s->_frame_length;
+		s->_frames[s->_frame_head].crcOK = (s->_frame_length > 2) && (s->_frame_prev_crc == s->_rx_buffer[crcPosition]);
+		s->_frame_head = nextFrame;
+	}
+	else
+	{
+		// discard the bytes of the frame (a break alone is not a frame)
+		s->_rx_buffer_head = s->_frame_start;
+		if (s->_frame_length > 1) s->_rx_overflows++;
+	}
+
+	// start a new frame
+	s->_frame_start = s->_rx_buffer_head;
+	s->_frame_length = 0;
+	s->_frame_crc = 0;
+	s->_frame_prev_crc = 0;
+	s->_frame_overflow = false;
+}
+
+
+/**
+ * Ends the transmission of a frame once the break has been sent. This operation is called when
+ * the TX complete event is triggered. Restore the settings and re-enable reception.
+ *
+ * @param [in,out]	s	The EMS Serial stream.
+ */
+
+void tx_complete(EMSSerial *s)
+{
+	PROFILE_SCOPE(ProfileSection::TxISR);
+
+	*s->_ucsrc = s->_tx_ucsrc;
+	sbi(*s->_ucsra, TXC0);
+	cbi(*s->_ucsrb, s->_txcie);
+	sbi(*s->_ucsrb, s->_rxen);
+	s->_tx_busy = false;
+}
+
+#if !defined(USART0_RX_vect) && defined(USART1_RX_vect)
+// do nothing - on the 32u4 the first USART is USART1
+#else
+#if !defined(USART_RX_vect) && !defined(USART0_RX_vect) && \
+	!defined(USART_RXC_vect)
+#error "Don't know what the Data Received vector is called for the first UART"
+#else
+/** Ems serial event 0 */
+void EMSSerialEvent0() __attribute__((weak));
+/** Ems serial event 0 */
+void EMSSerialEvent0() {}
+#define EMSSerialEvent0_implemented
+#if defined(USART_RX_vect)
+ISR(USART_RX_vect)
+#elif defined(USART0_RX_vect)
+ISR(USART0_RX_vect)
+#elif defined(USART_RXC_vect)
+ISR(USART_RXC_vect) // ATmega8
+#endif
+{
+	PROFILE_SCOPE(ProfileSection::RxISR);
+
+#if defined(UDR0)
+
+	bool fe = bitRead(UCSR0A, FE0);
+	unsigned char c = UDR0;
+	store_char(c, fe, &EMSSerial0);
+#elif defined(UDR)
+	bool fe = bitRead(UCSRA, FE);
+	unsigned char c = UDR;
+	store_char(c, fe, &EMSSerial0);
+
+#else
+#error UDR not defined
+#endif
+}
+
+#if defined(USART_TX_vect)
+ISR(USART_TX_vect)
+#elif defined(USART0_TX_vect)
+ISR(USART0_TX_vect)
+#elif defined(USART_TXC_vect)
+ISR(USART_TXC_vect) // ATmega8
+#endif
+{
+	tx_complete(&EMSSerial0);
+}
+#endif
+#endif
+
+#if defined(USART1_RX_vect)
+void EMSSerialEvent1() __attribute__((weak));
+void EMSSerialEvent1() {}
+#define EMSSerialEvent1_implemented
+ISR(USART1_RX_vect)
+{
+	PROFILE_SCOPE(ProfileSection::RxISR);
+
+	bool fe = bitRead(UCSR1A, FE1);
+	unsigned char c = UDR1;
+
+	store_char(c, fe, &EMSSerial1);
+}
+#endif
+
+#if defined(USART1_TX_vect)
+ISR(USART1_TX_vect)
+{
+	tx_complete(&EMSSerial1);
+}
+#endif
+
+#if defined(USART2_RX_vect) && defined(UDR2)
+void EMSSerialEvent2() __attribute__((weak));
+void EMSSerialEvent2() {}
+#define EMSSerialEvent2_implemented
+ISR(USART2_RX_vect)
+{
+	PROFILE_SCOPE(ProfileSection::RxISR);
+
+	bool fe = bitRead(UCSR2A, FE2);
+	unsigned char c = UDR2;
+
+	store_char(c, fe, &EMSSerial2);
+}
+#endif
+
+#if defined(USART2_TX_vect)
+ISR(USART2_TX_vect)
+{
+	tx_complete(&EMSSerial2);
+}
+#endif
+
+#if defined(USART3_RX_vect) && defined(UDR3)
+void EMSSerialEvent3() __attribute__((weak));
+void EMSSerialEvent3() {}
+#define EMSSerialEvent3_implemented
+ISR(USART3_RX_vect)
+{
+	PROFILE_SCOPE(ProfileSection::RxISR);
+
+	bool fe = bitRead(UCSR3A, FE3);
+	unsigned char c = UDR3;
+
+	store_char(c, fe, &EMSSerial3);
+}
+#endif
+
+#if defined(USART3_TX_vect)
+ISR(USART3_TX_vect)
+{
+	tx_complete(&EMSSerial3);
+}
+#endif
+
+
+/**
+ * EMS Serial event run
+ *
+ * @author	Administrator
+ * @date	5/2/2018
+ */
+
+void EMSSerialEventRun(void)
+{
+#ifdef EMSSerialEvent0_implemented
+	if (EMSSerial0.available()) EMSSerialEvent0();
+#endif
+#ifdef EMSSerialEvent1_implemented
+	if (EMSSerial1.available()) EMSSerialEvent1();
+#endif
+#ifdef EMSSerialEvent2_implemented
+	if (EMSSerial2.available()) EMSSerialEvent2();
+#endif
+#ifdef EMSSerialEvent3_implemented
+	if (EMSSerial3.available()) EMSSerialEvent3();
+#endif
+}
+
+
+/**
+ * EMS Serial Constructor
+ *
+ * @param [in]	ubrrh	USART Baud Rate Register.
+ * @param [in]	ubrrl	UBRRL contains the eight least significant bits of the USART baud rate.
+ * @param [in]	ucsra	USART Control and Status Register A.
+ * @param [in]	ucsrb	USART Control and Status Register B.
+ * @param [in]	ucsrc	USART Control and Status Register C.
+ * @param [in]	udr  	The transmit buffer.
+ * @param 	  	rxen 	Receiver Enable.
+ * @param 	  	txen 	Transmitter Enable.
+ * @param 	  	rxcie	RX Complete Interrupt Enable.
+ * @param 	  	txcie	TX Complete Interrupt Enable.
+ */
+
+EMSSerial::EMSSerial(
+	volatile uint8_t *ubrrh, volatile uint8_t *ubrrl,
+	volatile uint8_t *ucsra, volatile uint8_t *ucsrb,
+	volatile uint8_t *ucsrc, volatile uint8_t *udr,
+	uint8_t rxen, uint8_t txen, uint8_t rxcie, uint8_t txcie)
+{
+	_rx_buffer_head = _rx_buffer_tail = 0;
+	_frame_head = _frame_tail = 0;
+	_frame_start = _frame_length = 0;
+	_frame_crc = _frame_prev_crc = 0;
+	_frame_overflow = false;
+	_rx_overflows = 0;
+	_tx_length = _tx_index = 0;
+	_tx_busy = _tx_collision = false;
+	_error = false;
+	_ubrrh = ubrrh;
+	_ubrrl = ubrrl;
+	_ucsra = ucsra;
+	_ucsrb = ucsrb;
+	_ucsrc = ucsrc;
+	_udr = udr;
+	_rxen = rxen;
+	_txen = txen;
+	_rxcie = rxcie;
+	_txcie = txcie;
+}
+
+
+/** Default constructor */
+
+EMSSerial::EMSSerial() {}
+
+
+/**
+ * Start the communication with the EMS Bus  UART Interface Circuit
+ *
+ * @param	baud	- baud rate of the UART port.
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+bool EMSSerial::begin(unsigned long baud)
+{
+	uint16_t baud_setting;
+
+	*_ucsra = 0;
+	
+	_written = false;
+
+
+	baud_setting = (F_CPU / 8 / baud - 1) / 2;
+
+	// assign the baud_setting, ubbr (USART Baud Rate Register) and UBRRL (eight least significant
+	// bits of the USART baud rate). 
+	*_ubrrh = baud_setting >> 8;
+	*_ubrrl = baud_setting;
+
+	// set the bits in ucsrb port enabling reception, transmission and complete interrupt.
+	sbi(*_ucsrb, _rxen); 
+	sbi(*_ucsrb, _txen);
+	sbi(*_ucsrb, _rxcie);
+}
+
+
+/** Ends the EMS Serial communication */
+
+void EMSSerial::end()
+{
+	// clear the bits in ucsrb port disabling reception, transmission and complete interrupt.
+	cbi(*_ucsrb, _rxen); 
+	cbi(*_ucsrb, _txen);
+	cbi(*_ucsrb, _rxcie);
+	
+	// clear any received data and frames
+	_rx_buffer_head = _rx_buffer_tail;
+	_frame_head = _frame_tail;
+	_frame_start = _rx_buffer_head;
+	_frame_length = 0;
+}
+
+/**
+ * Gets the bytes pending to be read
+ *
+ * @return	Available bytes in the EMS Serial Buffer.
+ */
+
+int EMSSerial::available(void)
+{
+	return (unsigned int)(SERIAL_BUFFER_SIZE + _rx_buffer_head - _rx_buffer_tail) % SERIAL_BUFFER_SIZE;
+}
+
+
+/**
+ * Returns the top-of-stack object without removing it, or -1 otherwise.
+ *
+ * @return	The current top-of-stack object. If there is no object, return -1.
+ */
+
+int EMSSerial::peek(void)
+{
+	if (_rx_buffer_head == _rx_buffer_tail) {
+		return -1;
+	}
+	else {
+		return _rx_buffer[_rx_buffer_tail];
+	}
+}
+
+
+/**
+ * Returns the top-of-stack object removing it.
+ *
+ * @return	The current top-of-stack object, if any. Return -1 otherwise.
+ */
+
+int EMSSerial::read(void)
+{
+	// if the head isn't ahead of the tail, we don't have any characters
+	if (_rx_buffer_head == _rx_buffer_tail) {
+		return -1;
+	}
+	else {
+		unsigned char c = _rx_buffer[_rx_buffer_tail];
+		_error = _error_flag[_rx_buffer_tail];
+		_rx_buffer_tail = (unsigned int)(_rx_buffer_tail + 1) % SERIAL_BUFFER_SIZE;
+		return c;
+	}
+}
+
+
+/**
+ * Gets the number of complete frames pending to be read
+ *
+ * @return	Available frames in the EMS Serial frame queue.
+ */
+
+int EMSSerial::frameAvailable(void)
+{
+	return (unsigned int)(EMS_FRAME_QUEUE_SIZE + _frame_head - _frame_tail) % EMS_FRAME_QUEUE_SIZE;
+}
+
+
+/**
+ * Reads the oldest complete frame in the frame queue, removing it. If the frame is longer than
+ * the buffer, only the first len bytes are copied and the rest of the frame is discarded.
+ *
+ * @param [out]	buffer	Buffer where the frame will be copied.
+ * @param 	   	len   	The maximum number of bytes to copy.
+ * @param [out]	crcOK 	(Optional) Whether the CRC of the frame is correct.
+ *
+ * @return	Number of bytes copied, 0 if there is no frame available.
+ */
+
+int EMSSerial::readFrame(byte *buffer, byte len, bool *crcOK)
+{
+	if (_frame_head == _frame_tail) {
+		return 0;
+	}
+
+	EMSFrame *frame = &_frames[_frame_tail];
+	byte ptr;
+
+	for (ptr = 0; (ptr < frame->length) && (ptr < len); ptr++)
+	{
+		buffer[ptr] = _rx_buffer[(frame->start + ptr) % SERIAL_BUFFER_SIZE];
+	}
+
+	if (crcOK != NULL) *crcOK = frame->crcOK;
+
+	// release the bytes of the frame and the frame itself
+	_rx_buffer_tail = (unsigned int)(frame->start + frame->length) % SERIAL_BUFFER_SIZE;
+	_frame_tail = (_frame_tail + 1) % EMS_FRAME_QUEUE_SIZE;
+
+	return ptr;
+}
+
+
+/** Flushes the  EMS Serial by clearing the buffer contents and the frame queue */
+
+void EMSSerial::flush()
+{
+	// abort the transmission in progress (if any) and restore the settings changed to send the break
+	if (_tx_busy)
+	{
+		cbi(*_ucsrb, _txcie);
+		if (_tx_index >= _tx_length) *_ucsrc = _tx_ucsrc;
+		_tx_busy = false;
+	}
+
+	// disable reception in order to flush the receive buffer
+	cbi(*_ucsrb, _rxen);
+
+	// clear read buffer and frames
+	_rx_buffer_head = _rx_buffer_tail;
+	_frame_head = _frame_tail;
+	_frame_start = _rx_buffer_head;
+	_frame_length = 0;
+	_frame_crc = _frame_prev_crc = 0;
+	_frame_overflow = false;
+	_error = false;
+
+	// enable reception again
+	sbi(*_ucsrb, _rxen);
+}
+
+
+/**
+ * Writes the given character in the EMS Serial
+ *
+ * @param	c	The char to write.
+ *
+ * @return	The number of bytes written.
+ */
+
+size_t EMSSerial::write(uint8_t c)
+{
+	_written = true;
+
+	// UDRE Flag indicates if the transmit buffer (UDR) is ready to receive new data. If UDRE is
+	// one, the buffer is empty, and therefore ready to be written. Wait therefore until buffer
+	// empty signal. 
+	while (!(bitRead(*_ucsra, UDRE0))) {}
+
+	// write value in the trasmit buffer
+	*_udr = c;
+
+	return 1;
+}
+
+
+/**
+ * Start the transmission of a frame driven by the interrupts. The first byte is written now and
+ * the following ones as their previous echo is received. The last byte of the buffer is replaced
+ * by the break. Check txBusy() to know when the frame has been sent and collision() to know if
+ * it was aborted.
+ *
+ * @param [in]	buffer	Buffer where the output data is stored.
+ * @param 	  	len   	The length of the buffer, including the position of the break.
+ *
+ * @return	True if the transmission has started, false if there is a transmission in progress
+ * 			or the frame does not fit in the transmission buffer.
+ */
+
+bool EMSSerial::writeFrame(const byte *buffer, byte len)
+{
+	if (_tx_busy || (len < 2) || (len - 1 > EMS_TX_BUFFER_SIZE)) return false;
+
+	memcpy(_tx_buffer, buffer, len - 1);
+	_tx_length = len - 1;
+	_tx_index = 0;
+	_tx_collision = false;
+	_written = true;
+
+	// wait until the transmit buffer is empty (it already is, unless a byte was written with write)
+	while (!(bitRead(*_ucsra, UDRE0))) {}
+
+	_tx_busy = true;
+	*_udr = _tx_buffer[0];
+
+	return true;
+}
+
+
+/**
+ * Write a EMS end-of-frame character to the port First halt temporarily reception, change
+ * parity to even and then send a break-character. Then restore the settings and re-enable
+ * reception
+ */
+
+void EMSSerial::writeEOF() {
+	uint8_t t;
+	cbi(*_ucsrb, _rxen);   						//disable reception
+	while (!(bitRead(*_ucsra, UDRE0))) {}		// wait for data register empty
+	t = *_ucsrc;								// save settings
+	sbi(*_ucsrc, UPM01);						//set parity even
+	sbi(*_ucsra, TXC0);							//reset TX-complete (seems to be needed to get parity change)
+	*_udr = 0;									//directly write a break
+	while (!(bitRead(*_ucsra, TXC0))) {}		//wait for transmit complete
+	*_ucsrc = t;								//restore settings
+	sbi(*_ucsra, TXC0);							//reset TX-complete (seems to be needed to get parity change)
+	sbi(*_ucsrb, _rxen);   						//re-enable reception
+}
+
+
+/**
+ * Cast that converts the given to a bool
+ *
+ * @return	The result of the operation.
+ */
+
+EMSSerial::operator bool() {
+	return true;
+}
+
+#if defined(UBRRH) && defined(UBRRL)
+EMSSerial EMSSerial0(&UBRRH, &UBRRL, &UCSRA, &UCSRB, &UCSRC, &UDR, RXEN, TXEN, RXCIE, TXCIE);
+#elif defined(UBRR0H) && defined(UBRR0L)
+EMSSerial EMSSerial0(&UBRR0H, &UBRR0L, &UCSR0A, &UCSR0B, &UCSR0C, &UDR0, RXEN0, TXEN0, RXCIE0, TXCIE0);
+#endif
+#if defined(UBRR1H)
+EMSSerial EMSSerial1(&UBRR1H, &UBRR1L, &UCSR1A, &UCSR1B, &UCSR1C, &UDR1, RXEN1, TXEN1, RXCIE1, TXCIE1);
+#endif
+#if defined(UBRR2H)
+EMSSerial EMSSerial2(&UBRR2H, &UBRR2L, &UCSR2A, &UCSR2B, &UCSR2C, &UDR2, RXEN2, TXEN2, RXCIE2, TXCIE2);
+#endif
+#if defined(UBRR3H)
+EMSSerial EMSSerial3(&UBRR3H, &UBRR3L, &UCSR3A, &UCSR3B, &UCSR3C, &UDR3, RXEN3, TXEN3, RXCIE3, TXCIE3);
+#endif
+
+#pragma endregion EMSSerial
+
+/** CalduinoData definition */
+#pragma region CalduinoData
+
+/** Tag of the operation status printed when an EMS Datagram fails. */
+prog_char returnTag[] = { "Return" };
+
+/** Units for formatting purposes. */
+prog_char noneUnit[] = { "" };
+prog_char celsiusUnit[] = { "\xC2\xB0\C" };
+prog_char yesNoUnit[] = { "Yes/No" };
+prog_char mAmperUnit[] = { "mAmper" };
+prog_char barUnit[] = { "bar" };
+prog_char minuteUnit[] = { "minutes" };
+prog_char timesUnit[] = { "times" };
+prog_char percentageUnit[] = { "%" };
+prog_char dayUnit[] = { "day" };
+prog_char switchPointUnit[] = { "" };
+prog_char secondUnit[] = { "seconds" };
+
+/** CalduinoUnits Array. */
+const prog_char *calduinoUnits[] = {
+	noneUnit,
+	celsiusUnit,
+	yesNoUnit,
+	mAmperUnit,
+	barUnit,
+	minuteUnit,
+	timesUnit,
+	percentageUnit,
+	switchPointUnit,
+	secondUnit
+};
+
+
+/**
+ * Get the number of bytes that the Calduino Data occupies in the EMS Buffer.
+ *
+ * @return	The length in bytes of the Calduino Data.
+ */
+
+byte CalduinoData::getLength()
+{
+	switch (encodeType)
+	{
+		case CalduinoEncodeType::Float: return floatBytes;
+		case CalduinoEncodeType::Fixed: return floatBytes;
+		case CalduinoEncodeType::ULong: return 3;
+		case CalduinoEncodeType::SwithPoint: return 2;
+		case CalduinoEncodeType::UInt: return 2;
+		default: return 1;
+	}
+}
+
+
+/**
+ * Decode a Calduino Data of type byte.
+ *
+ * @param [in]	inEMSBuffer	- The EMS bytes received.
+ *
+ * @return	The value of the Calduino Data in the EMS Buffer received.
+ */
+
+byte CalduinoData::decodeByteValue(byte* inEMSBuffer)
+{
+	return decodeEMSByte(inEMSBuffer, offset);
+}
+
+
+
+/**
+* Decode a Calduino Data of type bit.
+*
+* @param [in]	inEMSBuffer	- The EMS bytes received.
+*
+* @return	The value of the Calduino Data in the EMS Buffer received.
+*/
+
+bool CalduinoData::decodeBitValue(byte* inEMSBuffer)
+{
+	return decodeEMSBit(inEMSBuffer, offset, bitOffset);
+}
+
+/**
+* Decode a Calduino Data of type ULong.
+*
+* @param [in]	inEMSBuffer	- The EMS bytes received.
+*
+* @return	The value of the Calduino Data in the EMS Buffer received.
+*/
+
+unsigned long CalduinoData::decodeULongValue(byte* inEMSBuffer)
+{
+	return decodeEMSULong(inEMSBuffer, offset);
+}
+
+
+/**
+ * Decode a Calduino Data of type UInt.
+ *
+ * @param [in]	inEMSBuffer	- The EMS bytes received.
+ *
+ * @return	The value of the Calduino Data in the EMS Buffer received.
+ */
+
+uint16_t CalduinoData::decodeUIntValue(byte *inEMSBuffer)
+{
+	return decodeEMSUInt(inEMSBuffer, offset);
+}
+
+
+/**
+ * Decode a Calduino Data of type float in fixed point.
+ *
+ * @param [in]	inEMSBuffer	- The EMS bytes received.
+ *
+ * @return	The value of the Calduino Data in the EMS Buffer received, in tenths.
+ */
+
+int16_t CalduinoData::decodeFixedValue(byte *inEMSBuffer)
+{
+	return decodeEMSFixed(inEMSBuffer, offset, floatBytes, floatFactor);
+}
+
+#ifdef CALDUINO_FLOAT
+/**
+ * Decode a Calduino Data of type float.
+ *
+ * @param [in]	inEMSBuffer	- The EMS bytes received.
+ *
+ * @return	The value of the Calduino Data in the EMS Buffer received.
+ */
+
+float CalduinoData::decodeFloatValue(byte *inEMSBuffer)
+{
+	return decodeEMSFloat(inEMSBuffer, offset, floatBytes, floatFactor);
+}
+#endif
+
+/**
+* Decode a Calduino Data of type SwitchPoint.
+*
+* @param [in]	inEMSBuffer	- The EMS bytes received.
+*
+* @return	The SwitchPoint value contained in the EMS Buffer received.
+*/
+
+SwitchPoint CalduinoData::decodeSwitchPoint(byte *inEMSBuffer)
+{
+	SwitchPoint value = { (offset / 2) - 2, (uint8_t)(inEMSBuffer[offset] & 7), (uint8_t)(inEMSBuffer[offset] >> 5), (uint8_t)(inEMSBuffer[offset + 1] / 6), (uint8_t)((inEMSBuffer[offset + 1] % 6) * 10) };
+	return value;
+}
+
+
+/**
+ * Composes a string with a fixed-point value with one decimal, without using float.
+ *
+ * @param [out]	str  	- pointer to an array of char elements where the value is stored.
+ * @param 	   	value	- value in tenths, FIXED_ERROR_VALUE is printed as nan.
+ */
+
+void formatFixedValue(char *str, int16_t value)
+{
+	if (value == FIXED_ERROR_VALUE)
+	{
+		strcpy_P(str, PSTR("nan"));
+		return;
+	}
+
+	unsigned int magnitude = (value < 0) ? -value : value;
+	sprintf_P(str, PSTR("%s%u.%u"), (value < 0) ? "-" : "", magnitude / FIXED_POINT_SCALE, magnitude % FIXED_POINT_SCALE);
+}
+
+#pragma endregion CalduinoData
+
+/** EMSDatagram definition */
+#pragma region EMSDatagram
+
+/** RC Datetime Datagram */
+prog_char rCDatetimeName[] = { "RCDatetime" };
+prog_char year[] = { "Year" };
+prog_char month[] = { "Month" };
+prog_char day[] = { "Day" };
+prog_char hour[] = { "Hour" };
+prog_char minute[] = { "Minute" };
+prog_char second[] = { "Second" };
+
+const PROGMEM CalduinoData rCDatetimeValues[] =
+{
+	{ year, CalduinoEncodeType::Byte, CalduinoUnit::None, 4 },
+	{ month, CalduinoEncodeType::Byte, CalduinoUnit::None, 5 },
+	{ day, CalduinoEncodeType::Byte, CalduinoUnit::None, 7 },
+	{ hour, CalduinoEncodeType::Byte, CalduinoUnit::None, 6 },
+	{ minute, CalduinoEncodeType::Byte, CalduinoUnit::None, 8 },
+	{ second, CalduinoEncodeType::Byte, CalduinoUnit::None, 9 }
+};
+
+const PROGMEM EMSDatagram rCDatetime = { rCDatetimeName, MessageID::RC_Datetime_ID, DeviceID::RC_35, RC_DATETIME_MESSAGE_SIZE, RC_DATETIME_VALUES_COUNT, rCDatetimeValues };
+
+/** Expand the value lists of Calduino.h to the names and the Calduino Data arrays. */
+#define CALDUINO_DATA_NAME(name, label, ...) prog_char name[] = { label };
+#define CALDUINO_DATA(name, label, encodeType, unit, offset, bitOffset, floatBytes, floatFactor) { name, CalduinoEncodeType::encodeType, CalduinoUnit::unit, offset, bitOffset, floatBytes, floatFactor },
+
+/** UBA Working Time Datagram */
+prog_char uBAWorkingTimeName[] = { "UBAWorkingTime" };
+prog_char uBAWorkingMin[] = { "UBAWorkMin" };
+
+const PROGMEM CalduinoData uBAWorkingTimeValues[] = {
+	{uBAWorkingMin, CalduinoEncodeType::ULong, CalduinoUnit::Minute, 4}
+};
+
+const PROGMEM EMSDatagram uBAWorkingTime = { uBAWorkingTimeName, MessageID::UBA_Working_Time_ID, DeviceID::UBA, UBA_WORKING_TIME_MESSAGE_SIZE, UBA_WORKING_TIME_VALUES_COUNT, uBAWorkingTimeValues };
+
+/** UBA Monitor Fast Datagram */
+prog_char uBAMonitorFastName[] = { "UBAMonitorFast" };
+
+UBA_MONITOR_FAST_VALUES(CALDUINO_DATA_NAME)
+
+const PROGMEM CalduinoData uBAMonitorFastValues[] = { UBA_MONITOR_FAST_VALUES(CALDUINO_DATA) };
+
+const PROGMEM EMSDatagram uBAMonitorFast = { uBAMonitorFastName, MessageID::UBA_Monitor_Fast_ID, DeviceID::UBA, UBA_MONITOR_FAST_MESSAGE_SIZE, UBA_MONITOR_FAST_VALUES_COUNT, uBAMonitorFastValues };
+
+/** UBA Monitor Slow Datagram */
+prog_char uBAMonitorSlowName[] = { "UBAMonitorSlow" };
+
+UBA_MONITOR_SLOW_VALUES(CALDUINO_DATA_NAME)
+
+const PROGMEM CalduinoData uBAMonitorSlowValues[] = { UBA_MONITOR_SLOW_VALUES(CALDUINO_DATA) };
+
+const PROGMEM EMSDatagram uBAMonitorSlow = { uBAMonitorSlowName, MessageID::UBA_Monitor_Slow_ID, DeviceID::UBA, UBA_MONITOR_SLOW_MESSAGE_SIZE, UBA_MONITOR_SLOW_VALUES_COUNT, uBAMonitorSlowValues };
+
+/** UBA Parameter DHW Datagram */
+prog_char uBAParameterDHWName[] = { "UBAParameterDHW" };
+prog_char selTempDHW[] = { "SelTempDHW" };
+prog_char tempTDDHW[] = { "SelTempTDDHW" };
+
+const PROGMEM CalduinoData uBAParameterDHWValues[] = {
+	{selTempDHW, CalduinoEncodeType::Byte, CalduinoUnit::Celsius, 6},
+	{tempTDDHW, CalduinoEncodeType::Byte, CalduinoUnit::Celsius, 12}
+};
+
+const PROGMEM EMSDatagram uBAParameterDHW = { uBAParameterDHWName, MessageID::UBA_Parameter_DHW_ID, DeviceID::UBA, UBA_PARAMETER_DHW_MESSAGE_SIZE, UBA_PARAMETER_DHW_VALUES_COUNT, uBAParameterDHWValues };
+
+/** UBA Monitor DHW Datagram */
+prog_char uBAMonitorDHWName[] = { "UBAMonitorDHW" };
+prog_char curTempDHW[] = { "CurTempDHW" };
+prog_char dayModeDHW[] = { "DayModeDHW" };
+prog_char oneTimeDHW[] = { "OneTimeDHW" };
+prog_char desDHW[] = { "DesDHW" };
+prog_char prepareDHW[] = { "PrepareDHW" };
+prog_char burnWorkMinDHW[] = { "BurnWorkMinDHW" };
+prog_char burnStartsDHW[] = { "BurnStartsDHW" };
+
+const PROGMEM CalduinoData uBAMonitorDHWValues[] = {
+	{curTempDHW, CalduinoEncodeType::Float, CalduinoUnit::Celsius, 5, 0, 2, 10},
+	{dayModeDHW, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 9, 0},
+	{oneTimeDHW, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 9, 1},
+	{desDHW, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 9, 2},
+	{prepareDHW, CalduinoEncodeType::Bit, CalduinoUnit::YesNo, 9, 3},
+	{burnWorkMinDHW, CalduinoEncodeType::ULong, CalduinoUnit::Minute, 14},
+	{burnStartsDHW, CalduinoEncodeType::ULong, CalduinoUnit::Times, 17}
+};
+
+const PROGMEM EMSDatagram uBAMonitorDHW = { uBAMonitorDHWName, MessageID::UBA_Monitor_DHW_ID, DeviceID::UBA, UBA_MONITOR_DHW_MESSAGE_SIZE, UBA_MONITOR_DHW_VALUES_COUNT, uBAMonitorDHWValues };
+
+/** UBA Flags DHW Datagram */
+prog_char flagsDHWName[] = { "FlagsDHW" };
+
+const PROGMEM CalduinoData uBAflagsDHWValues[] = {
+	{ oneTimeDHW, CalduinoEncodeType::Byte, CalduinoUnit::Celsius, 4 }
+};
+
+const PROGMEM EMSDatagram uBAFlagsDHW = { flagsDHWName, MessageID::Flags_DHW_ID, DeviceID::UBA, FLAGS_DHW_MESSAGE_SIZE, FLAGS_DHW_VALUES_COUNT, uBAflagsDHWValues };
+
+/** Working Mode DHW Datagram */
+prog_char workingModeDHWName[] = { "WorkingModeDHW" };
+prog_char progDHW[] = { "ProgDHW" };
+prog_char progPumpDHW[] = { "ProgPumpDHW" };
+prog_char workModeDHW[] = { "WorkModeDHW" };
+prog_char workModePumpDHW[] = { "WorkModePumpDHW" };
+prog_char workModeTDDHW[] = { "WorkModeTDDHW" };
+prog_char dayTDDHW[] = { "DayTDDHW" };
+prog_char hourTDDHW[] = { "HourTDDHW" };
+
+const PROGMEM CalduinoData workingModeDHWValues[] = {
+	{progDHW, CalduinoEncodeType::Byte, CalduinoUnit::None, 4},
+	{progPumpDHW, CalduinoEncodeType::Byte, CalduinoUnit::None, 5},
+	{workModeDHW, CalduinoEncodeType::Byte, CalduinoUnit::None, 6},
+	{workModePumpDHW, CalduinoEncodeType::Byte, CalduinoUnit::None, 7},
+	{workModeTDDHW, CalduinoEncodeType::Byte, CalduinoUnit::YesNo, 8},
+	{dayTDDHW, CalduinoEncodeType::Byte, CalduinoUnit::None, 9},
+	{hourTDDHW, CalduinoEncodeType::Byte, CalduinoUnit::None, 10}
+};
+
+const PROGMEM EMSDatagram workingModeDHW = { workingModeDHWName, MessageID::Working_Mode_DHW_ID, DeviceID::RC_35, WORKING_MODE_DHW_MESSAGE_SIZE, WORKING_MODE_DHW_VALUES_COUNT, workingModeDHWValues };
+
+/** Working Mode HC Datagram */
+prog_char workingModeHC1Name[] = { "WorkingModeHC1" };
+prog_char workingModeHC2Name[] = { "WorkingModeHC2" };
+prog_char workingModeHC3Name[] = { "WorkingModeHC3" };
+prog_char workingModeHC4Name[] = { "WorkingModeHC4" };
+
+WORKING_MODE_HC_VALUES(CALDUINO_DATA_NAME)
+
+const PROGMEM CalduinoData workingModeHCValues[] = { WORKING_MODE_HC_VALUES(CALDUINO_DATA) };
+
+const PROGMEM EMSDatagram workingModeHC1 = { workingModeHC1Name, MessageID::Working_Mode_HC_1_ID, DeviceID::RC_35, WORKING_MODE_HC_MESSAGE_SIZE, WORKING_MODE_HC_VALUES_COUNT, workingModeHCValues };
+const PROGMEM EMSDatagram workingModeHC2 = { workingModeHC2Name, MessageID::Working_Mode_HC_2_ID, DeviceID::RC_35, WORKING_MODE_HC_MESSAGE_SIZE, WORKING_MODE_HC_VALUES_COUNT, workingModeHCValues };
+const PROGMEM EMSDatagram workingModeHC3 = { workingModeHC3Name, MessageID::Working_Mode_HC_3_ID, DeviceID::RC_35, WORKING_MODE_HC_MESSAGE_SIZE, WORKING_MODE_HC_VALUES_COUNT, workingModeHCValues };
+const PROGMEM EMSDatagram workingModeHC4 = { workingModeHC4Name, MessageID::Working_Mode_HC_4_ID, DeviceID::RC_35, WORKING_MODE_HC_MESSAGE_SIZE, WORKING_MODE_HC_VALUES_COUNT, workingModeHCValues };
+
+/** Monitor HC Datagram */
+prog_char monitorHC1Name[] = { "MonitorHC1" };
+prog_char monitorHC2Name[] = { "MonitorHC2" };
+prog_char monitorHC3Name[] = { "MonitorHC3" };
+prog_char monitorHC4Name[] = { "MonitorHC4" };
+
+MONITOR_HC_VALUES(CALDUINO_DATA_NAME)
+
+const PROGMEM CalduinoData monitorHCValues[] = { MONITOR_HC_VALUES(CALDUINO_DATA) };
+
+const PROGMEM EMSDatagram monitorHC1 = { monitorHC1Name, MessageID::Monitor_HC_1_ID, DeviceID::RC_35, MONITOR_HC_MESSAGE_SIZE, MONITOR_HC_VALUES_COUNT, monitorHCValues };
+const PROGMEM EMSDatagram monitorHC2 = { monitorHC2Name, MessageID::Monitor_HC_2_ID, DeviceID::RC_35, MONITOR_HC_MESSAGE_SIZE, MONITOR_HC_VALUES_COUNT, monitorHCValues };
+const PROGMEM EMSDatagram monitorHC3 = { monitorHC3Name, MessageID::Monitor_HC_3_ID, DeviceID::RC_35, MONITOR_HC_MESSAGE_SIZE, MONITOR_HC_VALUES_COUNT, monitorHCValues };
+const PROGMEM EMSDatagram monitorHC4 = { monitorHC4Name, MessageID::Monitor_HC_4_ID, DeviceID::RC_35, MONITOR_HC_MESSAGE_SIZE, MONITOR_HC_VALUES_COUNT, monitorHCValues };
+
+/** Switching Program Datagram */
+prog_char programDHWName[] = { "ProgramDHW" };
+prog_char programPumpDHWName[] = { "ProgramPumpDHW" };
+prog_char program1HC1Name[] = { "Program1HC1" };
+prog_char program1HC2Name[] = { "Program1HC2" };
+prog_char program1HC3Name[] = { "Program1HC3" };
+prog_char program1HC4Name[] = { "Program1HC4" };
+prog_char program2HC1Name[] = { "Program2HC1" };
+prog_char program2HC2Name[] = { "Program2HC2" };
+prog_char program2HC3Name[] = { "Program2HC3" };
+prog_char program2HC4Name[] = { "Program2HC4" };
+prog_char switchPoint[] = { "SwitchPoint" };
+prog_char programName[] = { "ProgramName" };
+prog_char pauseTime[] = { "PauseTime" };
+prog_char partyTime[] = { "PartyTime" };
+prog_char startHolidayDay[] = { "StartHoliDay" };
+prog_char startHolidayMonth[] = { "StartHoliMonth" };
+prog_char startHolidayYear[] = { "StartHoliYear" };
+prog_char endHolidayDay[] = { "EndHoliDay" };
+prog_char endHolidayMonth[] = { "EndHoliMonth" };
+prog_char endHolidayYear[] = { "EndHoliYear" };
+prog_char startHomeHolidayDay[] = { "StartHHolDay" };
+prog_char startHomeHolidayMonth[] = { "StartHHoliMonth" };
+prog_char startHomeHolidayYear[] = { "StartHHoliYear" };
+prog_char endHomeHolidayDay[] = { "EndHHoliDay" };
+prog_char endHomeHolidayMonth[] = { "EndHHoliMonth" };
+prog_char endHomeHolidayYear[] = { "EndHHoliYear" };
+
+const PROGMEM CalduinoData switchingProgramValues[] = {
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 4},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 6},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 8},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 10}, 
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 12},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 14},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 16},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 18},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 20},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 22},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 24},	//10
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 26},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 28},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 30},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 32},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 34},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 36},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 38},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 40},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 42},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 44},	//20
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 46},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 48},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 50},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 52},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 54},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 56},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 58},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 60},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 62},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 64},	//30
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 66},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 68},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 70},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 72},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 74},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 76},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 78},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 80},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 82},
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 84},	//40
+	{switchPoint, CalduinoEncodeType::SwithPoint, CalduinoUnit::None, 86},
+	{programName, CalduinoEncodeType::Byte, CalduinoUnit::None, 88},
+	{pauseTime, CalduinoEncodeType::Byte, CalduinoUnit::None, 89},			
+	{partyTime, CalduinoEncodeType::Byte, CalduinoUnit::None, 90},
+	{startHolidayDay, CalduinoEncodeType::Byte, CalduinoUnit::None, 91},
+	{startHolidayMonth, CalduinoEncodeType::Byte, CalduinoUnit::None, 92},
+	{startHolidayYear, CalduinoEncodeType::Byte, CalduinoUnit::None, 93},
+	{endHolidayDay, CalduinoEncodeType::Byte, CalduinoUnit::None, 94},
+	{endHolidayMonth, CalduinoEncodeType::Byte, CalduinoUnit::None, 95},
+	{endHolidayYear, CalduinoEncodeType::Byte, CalduinoUnit::None, 96},		//50
+	{startHomeHolidayDay, CalduinoEncodeType::Byte, CalduinoUnit::None, 97},
+	{startHomeHolidayMonth, CalduinoEncodeType::Byte, CalduinoUnit::None, 98},
+	{startHomeHolidayYear, CalduinoEncodeType::Byte, CalduinoUnit::None, 99},
+	{endHomeHolidayDay, CalduinoEncodeType::Byte, CalduinoUnit::None, 100},
+	{endHomeHolidayMonth, CalduinoEncodeType::Byte, CalduinoUnit::None, 101},
+	{endHomeHolidayYear, CalduinoEncodeType::Byte, CalduinoUnit::None, 102}
+};
+
+const PROGMEM EMSDatagram program1HC1 = { program1HC1Name, MessageID::Program_1_HC_1_ID, DeviceID::RC_35, SWITCHING_PROGRAM_1_MESSAGE_SIZE, SWITCHING_PROGRAM_1_VALUES_COUNT, switchingProgramValues };
+const PROGMEM EMSDatagram program1HC2 = { program1HC2Name, MessageID::Program_1_HC_2_ID, DeviceID::RC_35, SWITCHING_PROGRAM_1_MESSAGE_SIZE, SWITCHING_PROGRAM_1_VALUES_COUNT, switchingProgramValues };
+const PROGMEM EMSDatagram program1HC3 = { program1HC3Name, MessageID::Program_1_HC_3_ID, DeviceID::RC_35, SWITCHING_PROGRAM_1_MESSAGE_SIZE, SWITCHING_PROGRAM_1_VALUES_COUNT, switchingProgramValues };
+const PROGMEM EMSDatagram program1HC4 = { program1HC4Name, MessageID::Program_1_HC_4_ID, DeviceID::RC_35, SWITCHING_PROGRAM_1_MESSAGE_SIZE, SWITCHING_PROGRAM_1_VALUES_COUNT, switchingProgramValues };
+const PROGMEM EMSDatagram program2HC1 = { program2HC1Name, MessageID::Program_2_HC_1_ID, DeviceID::RC_35, SWITCHING_PROGRAM_2_MESSAGE_SIZE, SWITCHING_PROGRAM_2_VALUES_COUNT, switchingProgramValues };
+const PROGMEM EMSDatagram program2HC2 = { program2HC2Name, MessageID::Program_2_HC_2_ID, DeviceID::RC_35, SWITCHING_PROGRAM_2_MESSAGE_SIZE, SWITCHING_PROGRAM_2_VALUES_COUNT, switchingProgramValues };
+const PROGMEM EMSDatagram program2HC3 = { program2HC3Name, MessageID::Program_2_HC_3_ID, DeviceID::RC_35, SWITCHING_PROGRAM_2_MESSAGE_SIZE, SWITCHING_PROGRAM_2_VALUES_COUNT, switchingProgramValues };
+const PROGMEM EMSDatagram program2HC4 = { program2HC4Name, MessageID::Program_2_HC_4_ID, DeviceID::RC_35, SWITCHING_PROGRAM_2_MESSAGE_SIZE, SWITCHING_PROGRAM_2_VALUES_COUNT, switchingProgramValues };
+const PROGMEM EMSDatagram programDHW = { programDHWName, MessageID::Program_DHW_ID, DeviceID::RC_35, SWITCHING_PROGRAM_1_MESSAGE_SIZE, SWITCHING_PROGRAM_1_VALUES_COUNT, switchingProgramValues };
+const PROGMEM EMSDatagram programPumpDHW = { programPumpDHWName, MessageID::Program_Pump_DHW_ID, DeviceID::RC_35, SWITCHING_PROGRAM_1_MESSAGE_SIZE, SWITCHING_PROGRAM_1_VALUES_COUNT, switchingProgramValues };
+
+/** Monitor MM10 Datagram */
+prog_char monitorMM10Name[] = { "MonitorMM10" };
+prog_char selImpTempMM10[] = { "SelImpTempMM10" };
+prog_char curImpTempMM10[] = { "CurImpTempMM10" };
+prog_char statusMM10[] = { "ModMM10" };
+
+const PROGMEM CalduinoData monitorMM10Values[] = {
+	{selImpTempMM10, CalduinoEncodeType::Byte, CalduinoUnit::Celsius, 4},
+	{curImpTempMM10, CalduinoEncodeType::Float, CalduinoUnit::Celsius, 5, 0, 2, 10},
+	{statusMM10, CalduinoEncodeType::Byte, CalduinoUnit::Percentage, 7}
+};
+
+const PROGMEM EMSDatagram monitorMM10  = { monitorMM10Name, MessageID::Monitor_MM_10_ID, DeviceID::MM_10, MONITOR_MM_10_MESSAGE_SIZE, MONITOR_MM_10_VALUES_COUNT, monitorMM10Values };
+
+/** EMS Datagram Array , pointer to the defined EMS Datagrams */
+EMSDatagram* eMSDatagramIDs[]  =
+{
+	&rCDatetime,
+	&uBAWorkingTime,
+	&uBAMonitorFast,
+	&uBAMonitorSlow,
+	&uBAParameterDHW,
+	&uBAMonitorDHW,
+	&uBAFlagsDHW,
+	&workingModeDHW,
+	&programDHW,
+	&programPumpDHW,
+	&workingModeHC1,
+	&monitorHC1,
+	&program1HC1,
+	&program2HC1,
+	&workingModeHC2,
+	&monitorHC2,
+	&program1HC2,
+	&program2HC2,
+	&workingModeHC3,
+	&monitorHC3,
+	&program1HC3,
+	&program2HC3,
+	&workingModeHC4,
+	&monitorHC4,
+	&program1HC4,
+	&program2HC4,
+	&monitorMM10
+};
+
+/** EMS devices in the inventory of Calduino, all the Device Identifiers except Calduino (PC) */
+const PROGMEM byte eMSDeviceIDs[EMS_DEVICES] =
+{
+	DeviceID::UBA,
+	DeviceID::BC_10,
+	DeviceID::RC_35,
+	DeviceID::WM_10,
+	DeviceID::RC_20,
+	DeviceID::MM_10
+};
+
+
+/**
+ * Structure that contains the position and encoding of a Calduino Data in its EMS Datagram. It
+ * is used in order to get single values contained in a EMS Buffer.
+ */
+
+struct CalduinoDataRequest
+{
+	byte eMSDatagramID;
+	byte offset;
+	byte bitOffset;
+	byte floatBytes;
+	byte floatFactor;
+};
+
+/** Expand the request lists of Calduino.h to the Calduino Data Requests. */
+#define CALDUINO_BYTE_REQUEST(request, eMSDatagramID, offset) { EMSDatagramID::eMSDatagramID, offset, 0, 0, 0 },
+#define CALDUINO_FLOAT_REQUEST(request, eMSDatagramID, offset, floatBytes, floatFactor) { EMSDatagramID::eMSDatagramID, offset, 0, floatBytes, floatFactor },
+#define CALDUINO_ULONG_REQUEST(request, eMSDatagramID, offset) { EMSDatagramID::eMSDatagramID, offset, 0, 0, 0 },
+#define CALDUINO_BIT_REQUEST(request, eMSDatagramID, offset, bitOffset) { EMSDatagramID::eMSDatagramID, offset, bitOffset, 0, 0 },
+
+/** Array with all the Calduino Data of type bytes. Is referenced by ByteRequest enumeration. */
+const PROGMEM CalduinoDataRequest byteRequests[] = { CALDUINO_BYTE_REQUESTS(CALDUINO_BYTE_REQUEST) };
+
+/** Array with all the Calduino Data of type float. Is referenced by FloatRequest enumeration. */
+const PROGMEM CalduinoDataRequest floatRequests[] = { CALDUINO_FLOAT_REQUESTS(CALDUINO_FLOAT_REQUEST) };
+
+/** Array with all the Calduino Data of type bit. Is referenced by BitRequest enumeration. */
+const PROGMEM CalduinoDataRequest bitRequests[] = { CALDUINO_BIT_REQUESTS(CALDUINO_BIT_REQUEST) };
+
+/** Array with all the Calduino Data of type ulong. Is referenced by uLongRequest enumeration. */
+const PROGMEM CalduinoDataRequest uLongRequests[] = { CALDUINO_ULONG_REQUESTS(CALDUINO_ULONG_REQUEST) };
+
+
+#pragma endregion EMSDatagram
+
+/* CalduinoDebug definition */
+#pragma region CalduinoDebug
+
+/** Default constructor */
+CalduinoDebug::CalduinoDebug()
+{
+	debugSerial = NULL;
+}
+
+
+/**
+ * Begins the given debug serial
+ *
+ * @param [in,out]	_debugSerial	The stream to be used as debug serial.
+ */
+
+void CalduinoDebug::begin(Stream *_debugSerial)
+{
+	debugSerial = _debugSerial;
+}
+
+
+/**
+ * Writes the given data in the debug serial
+ *
+ * @param	data	The data to write.
+ *
+ * @return	The number of bytes written.
+ */
+
+size_t CalduinoDebug::write(uint8_t data)
+{
+	if (debugSerial != NULL) {
+		return debugSerial->write(data);
+	}
+
+	return 0;
+}
+
+#pragma endregion CalduinoDebug
+
+/* CalduinoSerializer definition */
+#pragma region CalduinoSerializer
+
+/** Default constructor */
+CalduinoSerializer::CalduinoSerializer()
+{
+	out = NULL;
+	printFormat = NULL;
+	format = PrintFormat::Standard;
+	depth = 0;
+	firstMember = true;
+}
+
+
+/**
+ * Begins the serializer with the given Print sink.
+ *
+ * @param [in,out]	_out		 	- The Print where the tokens are written.
+ * @param [in]		_printFormat	- The print format to be read when a document begins.
+ */
+
+void CalduinoSerializer::begin(Print *_out, PrintFormat *_printFormat)
+{
+	out = _out;
+	printFormat = _printFormat;
+	depth = 0;
+}
+
+
+/**
+ * Begins an object named name. If it is the outermost object, a new document begins in the
+ * active print format.
+ *
+ * @param	name	- Flash string with the name of the object.
+ */
+
+void CalduinoSerializer::beginObject(const __FlashStringHelper *name)
+{
+	PROFILE_SCOPE(ProfileSection::PrintObject);
+
+	if (depth == 0)
+	{
+		format = *printFormat;
+		firstMember = true;
+	}
+
+	switch (format)
+	{
+		case PrintFormat::NoUnit:
+		case PrintFormat::Standard:
+		{
+			out->print(F("--- "));
+			out->print(name);
+			out->println(F(" ---"));
+			break;
+		}
+		case PrintFormat::XML:
+		{
+			out->print('<');
+			out->print(name);
+			out->println('>');
+			break;
+		}
+		case PrintFormat::JSON:
+		{
+			if (depth == 0) out->print('{');
+			printKey(name);
+			out->print('{');
+			firstMember = true;
+			break;
+		}
+		case PrintFormat::Binary:
+		{
+			// the objects are not printed, only the records of the EMS Datagrams
+			break;
+		}
+	}
+
+	// deeper objects are printed, but only the names of SERIALIZER_DEPTH levels are kept
+	names[(depth < SERIALIZER_DEPTH) ? depth : (SERIALIZER_DEPTH - 1)] = name;
+	depth++;
+}
+
+
+/** Ends the innermost object. If it is the outermost object, the document is finished. */
+void CalduinoSerializer::endObject()
+{
+	PROFILE_SCOPE(ProfileSection::PrintObject);
+
+	if (depth == 0) return;
+
+	depth--;
+	const __FlashStringHelper *name = names[(depth < SERIALIZER_DEPTH) ? depth : (SERIALIZER_DEPTH - 1)];
+
+	switch (format)
+	{
+		case PrintFormat::NoUnit:
+		case PrintFormat::Standard:
+		{
+			out->print(F("--- "));
+			out->print(name);
+			out->println(F(" ---"));
+			break;
+		}
+		case PrintFormat::XML:
+		{
+			out->print(F("</"));
+			out->print(name);
+			out->println('>');
+			break;
+		}
+		case PrintFormat::JSON:
+		{
+			out->print('}');
+			firstMember = false;
+			if (depth == 0) out->println('}');
+			break;
+		}
+		case PrintFormat::Binary:
+		{
+			break;
+		}
+	}
+}
+
+
+/**
+ * Prints the name of a member. In JSON the members are separated by commas, and the index is
+ * appended to the name so repeated members (e.g. Switch Points) have unique names.
+ *
+ * @param	name 	- Flash string with the name of the member.
+ * @param	index	- (Optional) Index of a repeated member, ERROR_VALUE if it is not repeated.
+ */
+
+void CalduinoSerializer::printKey(const __FlashStringHelper *name, byte index)
+{
+	switch (format)
+	{
+		case PrintFormat::NoUnit:
+		case PrintFormat::Standard:
+		{
+			out->print(name);
+			out->print(F(": "));
+			break;
+		}
+		case PrintFormat::XML:
+		{
+			out->print('<');
+			out->print(name);
+			out->print('>');
+			break;
+		}
+		case PrintFormat::JSON:
+		{
+			if (!firstMember) out->print(',');
+			out->print('"');
+			out->print(name);
+			if (index != ERROR_VALUE) out->print(index);
+			out->print(F("\":"));
+			firstMember = false;
+			break;
+		}
+		case PrintFormat::Binary:
+		{
+			// the members are not printed, their values are in the record of the EMS Datagram
+			break;
+		}
+	}
+}
+
+
+/**
+ * Prints the end of a member, with its unit in the standard print format.
+ *
+ * @param	name	- Flash string with the name of the member.
+ * @param	unit	- Flash string with the unit of the member, NULL if it has no unit.
+ */
+
+void CalduinoSerializer::printEnd(const __FlashStringHelper *name, const __FlashStringHelper *unit)
+{
+	switch (format)
+	{
+		case PrintFormat::Standard:
+		{
+			if (unit != NULL)
+			{
+				out->print(' ');
+				out->print(unit);
+			}
+			out->println();
+			break;
+		}
+		case PrintFormat::NoUnit:
+		{
+			out->println();
+			break;
+		}
+		case PrintFormat::XML:
+		{
+			out->print(F("</"));
+			out->print(name);
+			out->println('>');
+			break;
+		}
+		case PrintFormat::JSON:
+		case PrintFormat::Binary:
+		{
+			break;
+		}
+	}
+}
+
+
+/**
+ * Prints a fixed-point value with one decimal, without using float. FIXED_ERROR_VALUE is
+ * printed as nan (null in JSON).
+ *
+ * @param	value	- value in tenths.
+ */
+
+void CalduinoSerializer::printFixed(int16_t value)
+{
+	if (value == FIXED_ERROR_VALUE)
+	{
+		out->print((format == PrintFormat::JSON) ? F("null") : F("nan"));
+		return;
+	}
+
+	unsigned int magnitude = (value < 0) ? -value : value;
+	if (value < 0) out->print('-');
+	out->print(magnitude / FIXED_POINT_SCALE);
+	out->print('.');
+	out->print(magnitude % FIXED_POINT_SCALE);
+}
+
+
+/**
+ * Decodes the Calduino Data with the bytes contained in the EMS Buffer and prints it as a member
+ * of the current object.
+ *
+ * @param [in]	calduinoData	- The Calduino Data to be printed.
+ * @param [in]	inEMSBuffer 	- EMS bytes received.
+ */
+
+void CalduinoSerializer::printData(CalduinoData *calduinoData, byte *inEMSBuffer)
+{
+	PROFILE_SCOPE(ProfileSection::PrintData);
+
+	if (format == PrintFormat::Binary) return;
+
+	const __FlashStringHelper *name = FPSTR(calduinoData->dataName);
+	SwitchPoint valueSP = {};
+
+	if (calduinoData->encodeType == CalduinoEncodeType::SwithPoint)
+	{
+		valueSP = calduinoData->decodeSwitchPoint(inEMSBuffer);
+		printKey(name, valueSP.id);
+	}
+	else
+	{
+		printKey(name);
+	}
+
+	switch (calduinoData->encodeType)
+	{
+		case CalduinoEncodeType::Byte:
+		{
+			out->print(calduinoData->decodeByteValue(inEMSBuffer));
+			break;
+		}
+		case CalduinoEncodeType::Bit:
+		{
+			out->print(calduinoData->decodeBitValue(inEMSBuffer));
+			break;
+		}
+		case CalduinoEncodeType::ULong:
+		{
+			out->print(calduinoData->decodeULongValue(inEMSBuffer));
+			break;
+		}
+		case CalduinoEncodeType::UInt:
+		{
+			out->print(calduinoData->decodeUIntValue(inEMSBuffer));
+			break;
+		}
+		case CalduinoEncodeType::Float:
+		{
+			printFixed(calduinoData->decodeFixedValue(inEMSBuffer));
+			break;
+		}
+		case CalduinoEncodeType::SwithPoint:
+		{
+			byte fields[] = { valueSP.id, valueSP.action, valueSP.day, valueSP.hour, valueSP.minute };
+
+			// the five fields are separated by spaces, or printed as an array in JSON
+			if (format == PrintFormat::JSON) out->print('[');
+			for (byte i = 0; i < sizeof(fields); i++)
+			{
+				if (i > 0) out->print((format == PrintFormat::JSON) ? ',' : ' ');
+				out->print(fields[i]);
+			}
+			if (format == PrintFormat::JSON) out->print(']');
+			break;
+		}
+		case CalduinoEncodeType::Fixed:
+		{
+			// only a kind of Calduino Value Request, no Calduino Data is encoded as Fixed
+			break;
+		}
+	}
+
+	printEnd(name, FPSTR(calduinoUnits[calduinoData->unit]));
+}
+
+
+/**
+ * Prints a numeric value as a member of the current object.
+ *
+ * @param	name 	- Flash string with the name of the value.
+ * @param	value	- The value to be printed.
+ * @param	unit 	- (Optional) Flash string with the unit of the value.
+ */
+
+void CalduinoSerializer::printValue(const __FlashStringHelper *name, long value, const __FlashStringHelper *unit)
+{
+	if (format == PrintFormat::Binary) return;
+
+	printKey(name);
+	out->print(value);
+	printEnd(name, unit);
+}
+
+
+/**
+ * Prints a string value as a member of the current object. In JSON it is quoted, escaping
+ * quotes and backslashes.
+ *
+ * @param	name 	- Flash string with the name of the value.
+ * @param	value	- The string to be printed.
+ */
+
+void CalduinoSerializer::printValue(const __FlashStringHelper *name, const char *value)
+{
+	if (format == PrintFormat::Binary) return;
+
+	printKey(name);
+
+	if (format == PrintFormat::JSON)
+	{
+		out->print('"');
+		for (; *value != '\0'; value++)
+		{
+			if ((*value == '"') || (*value == '\\')) out->print('\\');
+			out->print(*value);
+		}
+		out->print('"');
+	}
+	else
+	{
+		out->print(value);
+	}
+
+	printEnd(name, NULL);
+}
+
+
+
+/**
+ * Prints the telemetry record of an EMS Datagram in Binary format.
+ *
+ * @param 	   	eMSDatagramID	- The EMS Datagram ID of the record.
+ * @param [in] 	eMSDatagram  	- The EMS Datagram, copied from program memory.
+ * @param [in] 	inEMSBuffer  	- EMS bytes received, NULL if the EMS Datagram failed.
+ * @param [in] 	present		 	- Bitmap of the Calduino Data to be printed
+ * 								(TELEMETRY_BITMAP_SIZE bytes).
+ */
+
+void CalduinoSerializer::printRecord(byte eMSDatagramID, EMSDatagram *eMSDatagram, byte *inEMSBuffer, const byte *present)
+{
+	PROFILE_SCOPE(ProfileSection::PrintData);
+
+	if (depth == 0) format = *printFormat;
+
+	out->write(eMSDatagramID);
+
+	// a failed EMS Datagram is a record without payload
+	if (inEMSBuffer == NULL)
+	{
+		out->write((byte)0);
+		return;
+	}
+
+	byte bitmapSize = TELEMETRY_BITMAP_SIZE(eMSDatagram->dataSize);
+	out->write(bitmapSize + printRecordValues(eMSDatagram, inEMSBuffer, present, false));
+
+	for (byte i = 0; i < bitmapSize; i++)
+	{
+		out->write(present[i]);
+	}
+
+	printRecordValues(eMSDatagram, inEMSBuffer, present, true);
+}
+
+
+/**
+ * Prints (or only measures) the values of the Calduino Data present in a telemetry record.
+ *
+ * @param [in]	eMSDatagram	- The EMS Datagram, copied from program memory.
+ * @param [in]	inEMSBuffer	- EMS bytes received.
+ * @param [in]	present	   	- Bitmap of the Calduino Data to be printed.
+ * @param 	  	write	   	- False to only obtain the length of the values.
+ *
+ * @return	The length in bytes of the values.
+ */
+
+byte CalduinoSerializer::printRecordValues(EMSDatagram *eMSDatagram, byte *inEMSBuffer, const byte *present, boolean write)
+{
+	CalduinoData calduinoData;
+	byte length = 0;
+	byte bits = 0;
+	byte bitCount = 0;
+
+	for (byte i = 0; i < eMSDatagram->dataSize; i++)
+	{
+		if (!bitRead(present[i / 8], i % 8)) continue;
+
+		memcpy_P(&calduinoData, &eMSDatagram->data[i], sizeof(CalduinoData));
+
+		// consecutive bits are packed in one byte, printed when it is full or another type follows
+		if (calduinoData.encodeType == CalduinoEncodeType::Bit)
+		{
+			if (calduinoData.decodeBitValue(inEMSBuffer)) bitSet(bits, bitCount);
+			if (++bitCount == 8)
+			{
+				length += printRecordByte(bits, write);
+				bits = bitCount = 0;
+			}
+			continue;
+		}
+
+		if (bitCount > 0)
+		{
+			length += printRecordByte(bits, write);
+			bits = bitCount = 0;
+		}
+
+		switch (calduinoData.encodeType)
+		{
+			case CalduinoEncodeType::Byte:
+			{
+				length += printRecordByte(calduinoData.decodeByteValue(inEMSBuffer), write);
+				break;
+			}
+			case CalduinoEncodeType::Float:
+			{
+				// the signed EMS value (not scaled, so it is exact), zigzag encoded so small negative
+				// values use few bytes too
+				int16_t value = decodeEMSFixed(inEMSBuffer, calduinoData.offset, calduinoData.floatBytes, FIXED_POINT_SCALE);
+				length += printVarint((uint16_t)(((uint16_t)value << 1) ^ (uint16_t)(value >> 15)), write);
+				break;
+			}
+			case CalduinoEncodeType::ULong:
+			{
+				length += printVarint(calduinoData.decodeULongValue(inEMSBuffer), write);
+				break;
+			}
+			case CalduinoEncodeType::UInt:
+			{
+				length += printVarint(calduinoData.decodeUIntValue(inEMSBuffer), write);
+				break;
+			}
+			case CalduinoEncodeType::SwithPoint:
+			{
+				length += printRecordByte(inEMSBuffer[calduinoData.offset], write);
+				length += printRecordByte(inEMSBuffer[calduinoData.offset + 1], write);
+				break;
+			}
+			case CalduinoEncodeType::Bit:
+			case CalduinoEncodeType::Fixed:
+			{
+				// bits are packed above, no Calduino Data is encoded as Fixed
+				break;
+			}
+		}
+	}
+
+	if (bitCount > 0) length += printRecordByte(bits, write);
+
+	return length;
+}
+
+
+/**
+ * Prints (or only measures) a byte of a telemetry record.
+ *
+ * @param	value	- The byte to be printed.
+ * @param	write	- False to only obtain the length.
+ *
+ * @return	The length in bytes, always 1.
+ */
+
+byte CalduinoSerializer::printRecordByte(byte value, boolean write)
+{
+	if (write) out->write(value);
+
+	return 1;
+}
+
+
+/**
+ * Prints (or only measures) an unsigned value as a varint: 7 bits per byte, least significant
+ * first, with the most significant bit set in every byte but the last.
+ *
+ * @param	value	- The value to be printed.
+ * @param	write	- False to only obtain the length.
+ *
+ * @return	The length in bytes of the varint.
+ */
+
+byte CalduinoSerializer::printVarint(unsigned long value, boolean write)
+{
+	byte length = 0;
+
+	do
+	{
+		byte data = value & 0x7F;
+		value >>= 7;
+		length += printRecordByte((value != 0) ? (data | 0x80) : data, write);
+	} while (value != 0);
+
+	return length;
+}
+
+#pragma endregion CalduinoSerializer
+
+/* CalduinoProfile definition */
+#pragma region CalduinoProfile
+
+#ifdef CALDUINO_PROFILE
+
+volatile ProfileCounter profileCounters[PROFILE_SECTIONS];
+uint16_t profileOverhead = 0;
+
+/**
+ * Start Timer 1 at the CPU clock (normal mode, no prescaler) to count cycles and reset the
+ * counters. The PWM outputs of Timer 1 are no longer available.
+ */
+
+void profileBegin()
+{
+	TCCR1A = 0;
+	TCCR1B = _BV(CS10);
+	TIMSK1 = 0;
+
+	// cycles spent reading the timer, discounted from every measure
+	uint16_t start = TCNT1;
+	profileOverhead = TCNT1 - start;
+
+	profileReset();
+}
+
+
+/** Reset the counters of all the sections. */
+
+void profileReset()
+{
+	uint8_t oldSREG = SREG;
+	cli();
+	for (byte i = 0; i < PROFILE_SECTIONS; i++)
+	{
+		profileCounters[i].count = 0;
+		profileCounters[i].cycles = 0;
+		profileCounters[i].maxCycles = 0;
+	}
+	SREG = oldSREG;
+}
+
+
+/**
+ * Get a copy of the counters of a section. Interrupts are disabled while copying, since the
+ * counters of the interrupt sections are updated by them.
+ *
+ * @param	section	The profiled section.
+ *
+ * @return	The counters of the section.
+ */
+
+ProfileCounter getProfileCounter(ProfileSection section)
+{
+	ProfileCounter counter;
+	uint8_t oldSREG = SREG;
+	cli();
+	counter.count = profileCounters[section].count;
+	counter.cycles = profileCounters[section].cycles;
+	counter.maxCycles = profileCounters[section].maxCycles;
+	SREG = oldSREG;
+	return counter;
+}
+
+
+/**
+ * Add an execution of a section. Each section is only updated from one context (interrupt or
+ * main loop), so no locking is needed.
+ *
+ * @param	section	The profiled section.
+ * @param	cycles 	CPU cycles measured.
+ */
+
+void profileAdd(ProfileSection section, uint16_t cycles)
+{
+	cycles = (cycles > profileOverhead) ? cycles - profileOverhead : 0;
+	profileCounters[section].count++;
+	profileCounters[section].cycles += cycles;
+	if (cycles > profileCounters[section].maxCycles) profileCounters[section].maxCycles = cycles;
+}
+
+#endif
+
+#pragma endregion CalduinoProfile
+
+/* CalduinoSerial definition */
+#pragma region CalduinoSerial
+
+/** Default constructor */
+CalduinoSerial::CalduinoSerial()
+{
+	calduinoSerial = NULL;
+}
+
+
+/**
+ * Begins the given calduino serial
+ *
+ * @param [in,out]	_calduinoSerial	The stream to be used as calduino serial.
+ */
+
+void CalduinoSerial::begin(EMSSerial *_calduinoSerial)
+{
+	calduinoSerial = _calduinoSerial;
+}
+#pragma endregion CalduinoSerial
+
+/* Calduino definition */
+#pragma region Calduino
+
+/** Calduino constructor method. Initialize variables. */
+Calduino::Calduino()
+{
+	EMSMaxWaitTime = EMS_MAX_WAIT_TIME;
+	printFormat = PrintFormat::Standard;
+	listenOnly = false;
+#ifdef CALDUINO_STATS
+	lastRxOverflows = 0;
+	resetStats();
+#endif
+	calduinoSerial = &eMSSerial;
+	commandTransaction = ERROR_VALUE;
+	transactionSequence = 0;
+	pipelineDepth = 1;
+	serializer.begin(&debugSerial, &printFormat);
+
+#ifdef CALDUINO_CACHE
+	// all the cache slots are free
+	for (byte i = 0; i < EMS_CACHE_SLOTS; i++)
+	{
+		cache[i].eMSDatagramID = ERROR_VALUE;
+		cache[i].valid = false;
+	}
+#endif
+
+#ifdef CALDUINO_REPORTS
+	// no EMS Datagram is reported in delta mode
+	for (byte i = 0; i < EMS_REPORT_SLOTS; i++)
+	{
+		reports[i].eMSDatagramID = ERROR_VALUE;
+	}
+
+	// temperatures are reported when they change at least CELSIUS_DEADBAND, the rest on any change
+	for (byte i = 0; i < CALDUINO_UNITS; i++)
+	{
+		deadbands[i] = 0;
+	}
+	deadbands[CalduinoUnit::Celsius] = CELSIUS_DEADBAND;
+#endif
+
+	// the EMS devices are unknown until they are seen on the EMS Bus or discovered
+	for (byte i = 0; i < EMS_DEVICES; i++)
+	{
+		devices[i].deviceID = pgm_read_byte(&eMSDeviceIDs[i]);
+		devices[i].status = DeviceStatus::Unknown;
+		devices[i].productID = ERROR_VALUE;
+		devices[i].versionMajor = ERROR_VALUE;
+		devices[i].versionMinor = ERROR_VALUE;
+		updateBreaker(&devices[i], true);
+	}
+	resetLatency();
+
+	// all the transaction slots are free
+	for (byte i = 0; i < CALDUINO_TRANSACTIONS; i++)
+	{
+		transactions[i].status = TransactionStatus::Free;
+	}
+}
+
+
+/**
+ * Start the Calduino device assigning the serial streams used.
+ *
+ * @param [in,out]	_calduinoSerial	- UART port used to communicate with the EMS Serial.
+ * @param [in,out]	_debugSerial   	- Optional stream to report errors and status.
+ *
+ * @return	True if there is communication with the EMS Buffer, false otherwise.
+ */
+
+boolean Calduino::begin(EMSSerial *_calduinoSerial, Stream *_debugSerial)
+{
+	eMSSerial.begin(_calduinoSerial);
+
+	return begin(&eMSSerial, _debugSerial);
+}
+
+
+/**
+ * Start the Calduino device assigning a Calduino Serial. Derived Calduino Serials can replace
+ * the EMS Serial and the clock (e.g. to run Calduino against a simulated EMS Bus).
+ *
+ * @param [in,out]	_calduinoSerial	- Calduino Serial used to communicate with the EMS Bus.
+ * @param [in,out]	_debugSerial   	- Optional stream to report errors and status.
+ *
+ * @return	True if there is communication with the EMS Buffer, false otherwise.
+ */
+
+boolean Calduino::begin(CalduinoSerial *_calduinoSerial, Stream *_debugSerial)
+{
+	calduinoSerial = _calduinoSerial;
+#ifdef CALDUINO_STATS
+	lastRxOverflows = calduinoSerial->rxOverflows();
+#endif
+	debugSerial.begin(_debugSerial);
+
+	// Define DEBUG FUNCTIONS
+	if (_debugSerial != NULL)
+	{
+#ifndef DEBUG
+#define DEBUG
+#define DPRINT(item) debugSerial.print(item)
+#define DPRINTLN(item) debugSerial.println(item)
+#define DPRINTVALUE(item1, item2) debugSerial.print(item1);debugSerial.print(": ");debugSerial.println(item2)
+#endif
+	}
+
+	return getCalduinoByteValue(ByteRequest::second_b);
+}
+
+
+/**
+ * Calculate the CRC code of the buffer passed as parameter.
+ *
+ * @param [in]	eMSBuffer	Buffer for which the CRC is calculated.
+ * @param 	  	len		 	Length of the buffer.
+ *
+ * @return	CRC code.
+ */
+
+uint8_t Calduino::crcCalculator(byte * eMSBuffer, int len)
+{
+	PROFILE_SCOPE(ProfileSection::CRCCalculator);
+
+	uint8_t i, crc = 0x0;
+	for (i = 0; i < len - 2; i++)
+	{
+		crc = crc_update(crc, eMSBuffer[i]);
+	}
+	return crc;
+}
+
+
+/**
+ * Add a time to a log-scale histogram. Bin i counts times lower than 4 * 2^i milliseconds.
+ *
+ * @param [in,out]	histogram	The histogram (STATS_HISTOGRAM_BINS bins).
+ * @param 		  	time	 	Time in milliseconds.
+ */
+
+#ifdef CALDUINO_STATS
+static void addToHistogram(uint16_t *histogram, unsigned long time)
+{
+	byte bin = 0;
+
+	while ((bin < STATS_HISTOGRAM_BINS - 1) && (time >= (4UL << bin))) bin++;
+
+	histogram[bin]++;
+}
+#endif
+
+
+/**
+ * Add a sample to a latency estimator, as the retransmission timer of TCP (Jacobson/Karels):
+ * SRTT += (sample - SRTT) / 8 and RTTVar += (|sample - SRTT| - RTTVar) / 4.
+ *
+ * @param [in,out]	estimator	The latency estimator.
+ * @param 		  	sample   	The latency measured in milliseconds.
+ */
+
+static void addLatencySample(LatencyEstimator *estimator, unsigned long sample)
+{
+	// samples are limited so the scaled values fit in 16 bits, and are never 0 (no samples)
+	int delta = (sample > EMS_MAX_WAIT_TIME * RETRY_FACTOR ? EMS_MAX_WAIT_TIME * RETRY_FACTOR : (sample == 0 ? 1 : sample));
+
+	if (estimator->srtt == 0)
+	{
+		estimator->srtt = delta << 3;
+		estimator->rttvar = delta << 1;
+	}
+	else
+	{
+		delta -= (estimator->srtt >> 3);
+		estimator->srtt += delta;
+		if (delta < 0) delta = -delta;
+		delta -= (estimator->rttvar >> 2);
+		estimator->rttvar += delta;
+	}
+
+	estimator->backoff = 0;
+}
+
+
+/**
+ * Get the timeout derived from a latency estimator: srttFactor * SRTT + 4 * RTTVar, not lower
+ * than MIN_ADAPTIVE_TIMEOUT and doubled after each consecutive timeout.
+ *
+ * @param [in]	estimator 	The latency estimator (NULL if there is none).
+ * @param 	  	srttFactor	Times the SRTT is added to the timeout.
+ * @param 	  	maxTimeout	The timeout used without samples, and the maximum timeout.
+ *
+ * @return	The timeout in milliseconds.
+ */
+
+static unsigned long getAdaptiveTimeout(const LatencyEstimator *estimator, byte srttFactor, unsigned long maxTimeout)
+{
+	if ((estimator == NULL) || (estimator->srtt == 0)) return maxTimeout;
+
+	unsigned long timeout = (unsigned long)(estimator->srtt >> 3) * srttFactor + estimator->rttvar;
+	if (timeout < MIN_ADAPTIVE_TIMEOUT) timeout = MIN_ADAPTIVE_TIMEOUT;
+	timeout <<= estimator->backoff;
+
+	return (timeout > maxTimeout ? maxTimeout : timeout);
+}
+
+
+/**
+ * Get the bitmap of the chunks of EMS_CHUNK_SIZE bytes in which a read is split.
+ *
+ * @param	length	Number of bytes to be read (a write is a single chunk).
+ *
+ * @return	The bitmap with a bit set for each chunk (at least one, EMS_MAX_CHUNKS at most).
+ */
+
+static uint16_t getChunksBitmap(byte length)
+{
+	byte chunks = (length == 0 ? 1 : (length + EMS_CHUNK_SIZE - 1) / EMS_CHUNK_SIZE);
+
+	return (chunks >= EMS_MAX_CHUNKS ? 0xFFFF : (1U << chunks) - 1);
+}
+
+
+/**
+ * Get the first chunk set in a bitmap of chunks.
+ *
+ * @param	chunks	The bitmap of chunks (not 0).
+ *
+ * @return	The index of the first chunk.
+ */
+
+static byte getFirstChunk(uint16_t chunks)
+{
+	byte chunk = 0;
+
+	while (!(chunks & 1U))
+	{
+		chunks >>= 1;
+		chunk++;
+	}
+
+	return chunk;
+}
+
+
+/**
+ * Get the number of bytes of a chunk of a read transaction.
+ *
+ * @param [in]	transaction	The transaction.
+ * @param 	  	chunk	   	The index of the chunk.
+ *
+ * @return	EMS_CHUNK_SIZE, or the remaining bytes in the last chunk.
+ */
+
+static byte getChunkLength(const CalduinoTransaction *transaction, byte chunk)
+{
+	byte remaining = transaction->length - chunk * EMS_CHUNK_SIZE;
+
+	return (remaining > EMS_CHUNK_SIZE ? EMS_CHUNK_SIZE : remaining);
+}
+
+
+/**
+ * Check whether a transaction goes before another one in the transaction queue: it has higher
+ * priority or, with the same priority, it was submitted before.
+ *
+ * @param [in]	transaction	The transaction.
+ * @param [in]	other	   	The transaction compared with.
+ *
+ * @return	True if the transaction goes first, false otherwise.
+ */
+
+static boolean isScheduledBefore(const CalduinoTransaction *transaction, const CalduinoTransaction *other)
+{
+	if (transaction->priority != other->priority) return (transaction->priority < other->priority);
+
+	return ((long)(transaction->sequence - other->sequence) < 0);
+}
+
+
+/**
+ * Submit an EMS Command to the transaction queue and return its handle. The transaction is
+ * executed asynchronously by poll() once the previous transactions of the same or higher
+ * priority have finished.
+ *
+ * @param 	   	write		 	True for a set command (write and read back), false for a get command.
+ * @param 	   	destinationID	The destinationID of the EMS device.
+ * @param 	   	messageID	 	The messageID requested.
+ * @param 	   	offset		 	The offset of the first byte in the EMS Message.
+ * @param 	   	length		 	Number of bytes to be read or written.
+ * @param [in] 	data		 	The data/configuration to be set (NULL in get commands).
+ * @param [out]	inEMSBuffer  	Pointer to the buffer where the EMS Datagram received will be
+ * 								saved (NULL in set commands).
+ * @param 	   	retryTime	 	Time in milliseconds while failed attempts of each chunk are retried.
+ * @param 	   	priority	 	The priority of a get command (set commands are always UserWrite).
+ * @param 	   	callback	 	(Optional) Function called when the transaction finishes.
+ * @param [in] 	context		 	(Optional) Pointer passed to the callback.
+ *
+ * @return	The handle of the transaction, ERROR_VALUE if the queue is full (a background read
+ * 			needs two free slots), in listen only mode, if the EMS device is absent or its
+ * 			breaker is open, or if there are more than MAX_EMS_WRITE bytes to be written.
+ */
+
+byte Calduino::submitTransaction(boolean write, byte destinationID, byte messageID, byte offset, byte length, const byte *data, byte *inEMSBuffer, unsigned long retryTime, TransactionPriority priority, CalduinoCallback callback, void *context)
+{
+	// Calduino does not use the EMS Bus in listen only mode, nor waits for EMS devices not installed
+	// or whose breaker is open
+	EMSDevice *device = getDeviceSlot(destinationID);
+	if (listenOnly || (write && (length > MAX_EMS_WRITE)) || !isDeviceAvailable(device)) return ERROR_VALUE;
+
+	// background reads leave the last free slot to the set and get commands
+	if (priority == TransactionPriority::BackgroundRead)
+	{
+		byte freeSlots = 0;
+
+		for (byte handle = 0; handle < CALDUINO_TRANSACTIONS; handle++)
+		{
+			if (transactions[handle].status == TransactionStatus::Free) freeSlots++;
+		}
+
+		if (freeSlots <= 1) return ERROR_VALUE;
+	}
+
+	for (byte handle = 0; handle < CALDUINO_TRANSACTIONS; handle++)
+	{
+		CalduinoTransaction *transaction = &transactions[handle];
+
+		if (transaction->status == TransactionStatus::Free)
+		{
+			transaction->status = TransactionStatus::Pending;
+			transaction->write = write;
+			transaction->destinationID = destinationID;
+			transaction->messageID = messageID;
+			transaction->offset = offset;
+			transaction->length = length;
+			transaction->missingChunks = getChunksBitmap(write ? 1 : length);
+			if (write) memcpy(transaction->data, data, length);
+			transaction->inEMSBuffer = inEMSBuffer;
+			transaction->retryTime = retryTime;
+
+			// once the backoff has expired, the EMS Command probes the EMS device with a single attempt
+			transaction->probe = ((device != NULL) && (device->breaker == BreakerState::Open));
+			if (transaction->probe)
+			{
+				device->breaker = BreakerState::HalfOpen;
+				transaction->retryTime = 0;
+			}
+			transaction->sequence = transactionSequence++;
+			transaction->priority = (write ? TransactionPriority::UserWrite : priority);
+			transaction->callback = callback;
+			transaction->context = context;
+
+			// search the EMS Datagram of the EMS Command in order to update its stats
+			transaction->eMSDatagramID = ERROR_VALUE;
+#ifdef CALDUINO_STATS
+			for (byte i = 0; i < EMS_DATAGRAMS; i++)
+			{
+				EMSDatagram eMSDatagram;
+				memcpy_P(&eMSDatagram, eMSDatagramIDs[i], sizeof(EMSDatagram));
+
+				if ((eMSDatagram.destinationID == destinationID) && (eMSDatagram.messageID == messageID))
+				{
+					transaction->eMSDatagramID = i;
+					stats.datagrams[i].requests++;
+					break;
+				}
+			}
+#endif
+
+			return handle;
+		}
+	}
+
+	return ERROR_VALUE;
+}
+
+
+/**
+ * Execute the transaction passed as parameter (and the ones submitted before it) blocking the
+ * caller until it finishes.
+ *
+ * @param	handle	The handle of the transaction.
+ *
+ * @return	True if the transaction succeeded, false otherwise.
+ */
+
+boolean Calduino::waitTransaction(byte handle)
+{
+	TransactionStatus status;
+
+	if (handle == ERROR_VALUE) return false;
+
+	do
+	{
+		poll();
+		status = getStatus(handle);
+	} while ((status == TransactionStatus::Pending) || (status == TransactionStatus::Running));
+
+	return (status == TransactionStatus::Succeeded);
+}
+
+
+/**
+ * Prepare the transaction to wait until Calduino is polled by the Bus Master. The frames
+ * received meanwhile are not discarded but processed by poll().
+ *
+ * @param [in,out]	transaction	The running transaction.
+ */
+
+void Calduino::waitPoll(CalduinoTransaction *transaction)
+{
+	// abort the transmission of the previous EMS Command if its echo never arrived
+	if (calduinoSerial->txBusy()) calduinoSerial->flush();
+
+	// watchdog (maximum polling waiting time)
+	transaction->waitingReply = false;
+	transaction->stepStart = calduinoSerial->getMillis();
+	transaction->timeout = transaction->stepStart + getPollTimeout();
+}
+
+
+/**
+ * Build and send the next EMS Command of the transaction once Calduino has been polled.
+ *
+ * @param [in,out]	transaction	The running transaction.
+ */
+
+void Calduino::sendTransactionCommand(CalduinoTransaction *transaction)
+{
+	EMSDatagramStats *datagramStats = getDatagramStats(transaction);
+	unsigned long pollWait = calduinoSerial->getMillis() - transaction->stepStart;
+
+	if (datagramStats != NULL) datagramStats->pollWaitTime += pollWait;
+#ifdef CALDUINO_STATS
+	addToHistogram(stats.pollWaitHistogram, pollWait);
+#endif
+	addLatencySample(&pollLatency, pollWait);
+
+	// buffer long enough for a set command with MAX_EMS_WRITE bytes (headers, CRC and break included)
+	byte outEMSBuffer[EMS_DATAGRAM_OVERHEAD + MAX_EMS_WRITE];
+	byte outLength = OUT_EMS_BUFFER_SIZE;
+
+	// load outEMSBuffer with corresponding values.
+	// first position is the transmitterID. Ox0B is the ComputerID (Calduino address)
+	outEMSBuffer[0] = DeviceID::PC;
+
+	// second position is destinationID. Masked with 0x80 as a read command (get commands and read back of set commands)
+	outEMSBuffer[1] = ((transaction->write && !transaction->verifying) ? transaction->destinationID : transaction->destinationID | 0x80);
+
+	// third position is the messageID
+	outEMSBuffer[2] = transaction->messageID;
+
+	// fourth position is the offset in the buffer. If the message is split in different commands,
+	// the offset contains the byte required from the EMS Datagram
+	outEMSBuffer[3] = transaction->offset;
+
+	if (transaction->write && !transaction->verifying)
+	{
+		// fifth and following positions are the data to send
+		memcpy(&outEMSBuffer[4], transaction->data, transaction->length);
+		outLength = EMS_DATAGRAM_OVERHEAD + transaction->length;
+	}
+	else if (transaction->write)
+	{
+		// fifth position is the length of the data to read back
+		outEMSBuffer[4] = transaction->length;
+	}
+	else
+	{
+		// fourth and fifth positions are the offset and length of the first chunk not received yet.
+		// The data requested is split in chunks of the maximum utile bytes read (EMS_CHUNK_SIZE)
+		byte chunk = getFirstChunk(transaction->missingChunks);
+		outEMSBuffer[3] = transaction->offset + chunk * EMS_CHUNK_SIZE;
+		outEMSBuffer[4] = getChunkLength(transaction, chunk);
+	}
+
+	// calculate the CRC value in the position previous to the break
+	outEMSBuffer[outLength - 2] = crcCalculator(outEMSBuffer, outLength);
+
+	// send the buffer (data bytes + break)
+	if (!calduinoSerial->writeFrame(outEMSBuffer, outLength))
+	{
+		retryTransaction(transaction);
+		return;
+	}
+
+	// check if the requested query is answered in time (EMSMaxWaitTime milliseconds at most)
+	transaction->waitingReply = true;
+	transaction->stepStart = calduinoSerial->getMillis();
+	transaction->timeout = transaction->stepStart + getAdaptiveTimeout(getReplyLatency(transaction), 1, EMSMaxWaitTime);
+}
+
+
+/**
+ * Process the first frame received after sending an EMS Command of the transaction.
+ *
+ * @param [in,out]	transaction	The running transaction.
+ * @param [in]	  	inEMSBuffer	The frame received.
+ * @param 		  	len		   	Number of bytes of the frame.
+ * @param 		  	crcOK	   	Whether the CRC of the frame is correct.
+ */
+
+void Calduino::processTransactionReply(CalduinoTransaction *transaction, byte *inEMSBuffer, int len, bool crcOK)
+{
+	EMSDatagramStats *datagramStats = getDatagramStats(transaction);
+	// late replies may arrive while waiting for the poll, they are not response time samples
+	LatencyEstimator *latency = (transaction->waitingReply ? getReplyLatency(transaction) : NULL);
+	unsigned long responseTime = calduinoSerial->getMillis() - transaction->stepStart;
+
+#ifdef CALDUINO_STATS
+	if (transaction->waitingReply) addToHistogram(stats.responseHistogram, responseTime);
+#endif
+
+	if (transaction->write && !transaction->verifying)
+	{
+		// if the answer received is 0x01, the value has been correctly sent, read it back then
+		if ((len > 0) && (inEMSBuffer[0] == 0x01))
+		{
+			if (latency != NULL) addLatencySample(latency, responseTime);
+			transaction->verifying = true;
+			waitPoll(transaction);
+		}
+		else
+		{
+			if (datagramStats != NULL) datagramStats->frameErrors++;
+			retryTransaction(transaction);
+		}
+	}
+	// if more than 4 bytes are read (datagram received)
+	// check if the CRC of the information received is correct and the operation type returned corresponds with the one requested
+	else if ((len > 4) && crcOK && (inEMSBuffer[2] == transaction->messageID))
+	{
+		if (transaction->write)
+		{
+			if (latency != NULL) addLatencySample(latency, responseTime);
+
+			// check if the data received corresponds with the change requested
+			if ((len >= transaction->length + EMS_DATAGRAM_OVERHEAD) && (memcmp(transaction->data, &inEMSBuffer[4], transaction->length) == 0))
+			{
+				transaction->status = TransactionStatus::Succeeded;
+			}
+			else
+			{
+				if (datagramStats != NULL) datagramStats->frameErrors++;
+				retryTransaction(transaction);
+			}
+		}
+		else
+		{
+			// the reply may correspond to any chunk (e.g. a late reply to a previous attempt)
+			byte chunkOffset = inEMSBuffer[3] - transaction->offset;
+			byte chunk = chunkOffset / EMS_CHUNK_SIZE;
+
+			// a chunk already received or not requested does not answer the EMS Command, keep waiting
+			if ((inEMSBuffer[3] < transaction->offset) || (chunkOffset % EMS_CHUNK_SIZE != 0) || (chunk >= EMS_MAX_CHUNKS) ||
+				!(transaction->missingChunks & (1U << chunk)))
+			{
+				return;
+			}
+
+			// a reply shorter than the chunk requested does not complete it, the chunk is requested again
+			byte chunkLength = getChunkLength(transaction, chunk);
+			if (len < chunkLength + EMS_DATAGRAM_OVERHEAD)
+			{
+				if (datagramStats != NULL) datagramStats->frameErrors++;
+				retryTransaction(transaction);
+				return;
+			}
+
+			if (latency != NULL) addLatencySample(latency, responseTime);
+
+			// copy the bytes read to inEMSBuffer taking into account the internal offset (reconstruct the EMS Datagram)
+			memcpy(&transaction->inEMSBuffer[INITIAL_OFFSET + inEMSBuffer[3]], &inEMSBuffer[INITIAL_OFFSET], chunkLength);
+
+			transaction->missingChunks &= ~(1U << chunk);
+
+			if (transaction->missingChunks == 0)
+			{
+				transaction->status = TransactionStatus::Succeeded;
+			}
+			else
+			{
+				// every chunk has its own retry time, the chunks received are never requested again
+				transaction->deadline = calduinoSerial->getMillis() + transaction->retryTime;
+				waitPoll(transaction);
+			}
+		}
+	}
+	else
+	{
+		if (datagramStats != NULL)
+		{
+			if ((len > 4) && !crcOK) datagramStats->crcErrors++;
+			else datagramStats->frameErrors++;
+		}
+		retryTransaction(transaction);
+	}
+}
+
+
+/**
+ * Retry the transaction after a failed attempt, or mark it as failed if the retry time of the
+ * current chunk has expired. The chunks already read are kept and set commands are sent again.
+ *
+ * @param [in,out]	transaction	The running transaction.
+ */
+
+void Calduino::retryTransaction(CalduinoTransaction *transaction)
+{
+	if ((long)(calduinoSerial->getMillis() - transaction->deadline) < 0)
+	{
+		EMSDatagramStats *datagramStats = getDatagramStats(transaction);
+		if (datagramStats != NULL) datagramStats->retries++;
+
+		transaction->verifying = false;
+		waitPoll(transaction);
+	}
+	else
+	{
+		transaction->status = TransactionStatus::Failed;
+	}
+}
+
+
+/**
+ * Release the EMS Bus once a running transaction has finished and invoke its callback. Slots
+ * of transactions with callback are freed before invoking it, the others keep the result until
+ * it is read with getStatus().
+ *
+ * @param	handle	The handle of the transaction.
+ */
+
+void Calduino::finishTransaction(byte handle)
+{
+	CalduinoTransaction *transaction = &transactions[handle];
+
+	if (commandTransaction == handle) commandTransaction = ERROR_VALUE;
+
+	EMSDatagramStats *datagramStats = getDatagramStats(transaction);
+	if ((datagramStats != NULL) && (transaction->status == TransactionStatus::Succeeded)) datagramStats->successes++;
+
+	// the EMS device only fails if the EMS Command was sent and its reply was lost or wrong (a failed
+	// transaction keeps waitingReply). While the breaker is half open only the probe decides
+	EMSDevice *device = getDeviceSlot(transaction->destinationID);
+	if ((device != NULL) && ((device->breaker != BreakerState::HalfOpen) || transaction->probe))
+	{
+		if ((transaction->status == TransactionStatus::Succeeded) || transaction->waitingReply)
+		{
+			updateBreaker(device, transaction->status == TransactionStatus::Succeeded);
+		}
+		else if (transaction->probe)
+		{
+			// a probe never polled does not extend the backoff, the next EMS Command probes again
+			device->breaker = BreakerState::Open;
+		}
+	}
+
+	if (transaction->callback != NULL)
+	{
+		CalduinoCallback callback = transaction->callback;
+		boolean success = (transaction->status == TransactionStatus::Succeeded);
+
+		transaction->status = TransactionStatus::Free;
+		callback(handle, success, transaction->context);
+	}
+}
+
+
+/**
+ * Submit an asynchronous get command of a whole EMS Datagram.
+ *
+ * @param [out]	inEMSBuffer  	Pointer to the buffer where the EMS Datagram received will be
+ * 								saved. It must be valid until the transaction finishes and its
+ * 								size must be the message length plus EMS_DATAGRAM_OVERHEAD.
+ * @param 	   	eMSDatagramID	The EMS Datagram to obtain.
+ * @param 	   	callback	 	(Optional) Function called by poll() when the transaction finishes.
+ * @param [in] 	context		 	(Optional) Pointer passed to the callback.
+ * @param 	   	priority	 	(Optional) InteractiveRead (default) or BackgroundRead, for the
+ * 								periodic refresh of EMS Datagrams that yields the EMS Bus to
+ * 								the set commands and the interactive reads.
+ *
+ * @return	The handle of the transaction, ERROR_VALUE if the queue is full.
+ */
+
+byte Calduino::submit(byte *inEMSBuffer, EMSDatagramID eMSDatagramID, CalduinoCallback callback, void *context, TransactionPriority priority)
+{
+	// get from program memory the EMS Datagram passed as parameter
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, eMSDatagramIDs[eMSDatagramID], sizeof(EMSDatagram));
+
+	return submitTransaction(false, eMSDatagram.destinationID, eMSDatagram.messageID, 0, eMSDatagram.messageLength, NULL, inEMSBuffer, EMSMaxWaitTime * RETRY_FACTOR * 2, priority, callback, context);
+}
+
+
+/**
+ * Submit an asynchronous set command of a Calduino Data. The snapshot of the EMS Datagram (if
+ * cached) is invalidated.
+ *
+ * @param	eMSDatagramID	 	The EMS Datagram where the configuration is.
+ * @param	datagramDataIndex	The Calduino Data to be changed.
+ * @param	data			 	The data/configuration to be set.
+ * @param	callback		 	(Optional) Function called by poll() when the transaction finishes.
+ * @param	context			 	(Optional) Pointer passed to the callback.
+ *
+ * @return	The handle of the transaction, ERROR_VALUE if the queue is full.
+ */
+
+byte Calduino::submit(EMSDatagramID eMSDatagramID, DatagramDataIndex datagramDataIndex, byte data, CalduinoCallback callback, void *context)
+{
+	// get from program memory the EMS Datagram passed as parameter
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, eMSDatagramIDs[eMSDatagramID], sizeof(EMSDatagram));
+
+	// get from program memory the Calduino Data  of the configuration to be changed 
+	CalduinoData calduinoData;
+	memcpy_P(&calduinoData, &eMSDatagram.data[datagramDataIndex], sizeof(CalduinoData));
+
+	// the snapshot of this EMS Datagram (if cached) is no longer valid
+	EMSCacheSlot *slot = getCacheSlot(eMSDatagramIDs[eMSDatagramID]);
+	if (slot != NULL) slot->valid = false;
+
+	return submitTransaction(true, eMSDatagram.destinationID, eMSDatagram.messageID, calduinoData.offset - INITIAL_OFFSET, 1, &data, NULL, EMSMaxWaitTime * RETRY_FACTOR, TransactionPriority::UserWrite, callback, context);
+}
+
+
+/**
+ * Advance the transaction engine without blocking. It must be called periodically (e.g. from
+ * loop()) while there are submitted transactions. Up to pipelineDepth transactions (by default
+ * one) use the EMS Bus at a time, by priority and in order of submission. The telegrams with
+ * correct CRC sent by the EMS devices to other destinations (e.g. the monitors broadcasted by
+ * the UBA and the RC) refresh the snapshots of the cached EMS Datagrams and mark their senders
+ * as present, so poll() must also be called in listen only mode.
+ */
+
+void Calduino::poll()
+{
+	byte auxBuffer[SERIAL_BUFFER_SIZE];
+	bool crcOK;
+	byte running = 0;
+
+	// if the pipeline has room, start the oldest pending transactions (none in listen only mode)
+	startTransactions();
+
+	for (byte handle = 0; handle < CALDUINO_TRANSACTIONS; handle++)
+	{
+		if (transactions[handle].status == TransactionStatus::Running) running |= (1 << handle);
+	}
+
+	// no transaction running, just store the telegrams sent by the EMS devices
+	if (running == 0)
+	{
+		while (calduinoSerial->frameAvailable())
+		{
+			int ptr = calduinoSerial->readFrame(auxBuffer, SERIAL_BUFFER_SIZE, &crcOK);
+			if (crcOK)
+			{
+				updateInventory(auxBuffer, ptr);
+				storeTelegram(auxBuffer, ptr);
+			}
+		}
+		return;
+	}
+
+	// process the frames received
+	while ((getRunningTransactions() > 0) && calduinoSerial->frameAvailable())
+	{
+		int ptr = calduinoSerial->readFrame(auxBuffer, SERIAL_BUFFER_SIZE, &crcOK);
+
+		// every telegram received reveals its sender, also the replies to Calduino
+		if (crcOK) updateInventory(auxBuffer, ptr);
+
+		// telegrams not addressed to Calduino (e.g. broadcasts of the monitors) are stored
+		if (crcOK && (ptr > 4) && (auxBuffer[1] != DeviceID::PC))
+		{
+			storeTelegram(auxBuffer, ptr);
+		}
+		// the Bus Master polls (pollAddress + Break) the device ID that Calduino simulates (PC)
+		else if ((ptr == 2) && ((auxBuffer[0] & 0x7F) == DeviceID::PC) && (getPolledTransaction() != NULL))
+		{
+			CalduinoTransaction *transaction = getPolledTransaction();
+			refreshPollTimeouts(transaction);
+			commandTransaction = transaction - transactions;
+			sendTransactionCommand(transaction);
+		}
+		// the polls of the other EMS devices do not concern Calduino
+		else if ((ptr == 2) && (auxBuffer[0] & 0x80) && ((auxBuffer[0] & 0x7F) != DeviceID::PC))
+		{
+			continue;
+		}
+		// a poll that no transaction can use means that the reply to the last EMS Command was lost
+		else
+		{
+			CalduinoTransaction *transaction = getReplyTransaction(auxBuffer, ptr, crcOK);
+			if (transaction != NULL) processTransactionReply(transaction, auxBuffer, ptr, crcOK);
+		}
+	}
+
+	// another device was using the EMS Bus while sending the EMS Command
+	if ((commandTransaction != ERROR_VALUE) && (transactions[commandTransaction].status == TransactionStatus::Running) &&
+		transactions[commandTransaction].waitingReply && calduinoSerial->collision())
+	{
+#ifdef CALDUINO_STATS
+		stats.collisions++;
+#endif
+		// the EMS Command was not received by the EMS device, it is not a failure of the EMS device
+		transactions[commandTransaction].waitingReply = false;
+		retryTransaction(&transactions[commandTransaction]);
+	}
+
+	for (byte handle = 0; handle < CALDUINO_TRANSACTIONS; handle++)
+	{
+		CalduinoTransaction *transaction = &transactions[handle];
+
+		// the poll or the reply has not arrived in time
+		if ((transaction->status == TransactionStatus::Running) && ((long)(calduinoSerial->getMillis() - transaction->timeout) > 0))
+		{
+			EMSDatagramStats *datagramStats = getDatagramStats(transaction);
+			if (datagramStats != NULL) datagramStats->timeouts++;
+
+			// the timeout of the step is doubled until its next sample
+			LatencyEstimator *latency = (transaction->waitingReply ? getReplyLatency(transaction) : &pollLatency);
+			if ((latency != NULL) && (latency->backoff < MAX_TIMEOUT_BACKOFF)) latency->backoff++;
+
+			retryTransaction(transaction);
+		}
+
+		if ((running & (1 << handle)) && (transaction->status != TransactionStatus::Running))
+		{
+			finishTransaction(handle);
+		}
+	}
+}
+
+
+/**
+ * Start the pending transactions, by priority and in order of submission, while there are less
+ * than pipelineDepth transactions running (none in listen only mode). If the pipeline is full,
+ * a running transaction of lower priority waiting to be polled, i.e. between two chunks, yields
+ * its place and goes back to the queue. It resumes later from the chunks still missing.
+ */
+
+void Calduino::startTransactions()
+{
+	while (!listenOnly)
+	{
+		CalduinoTransaction *transaction = NULL;
+		CalduinoTransaction *preempted = NULL;
+
+		for (byte handle = 0; handle < CALDUINO_TRANSACTIONS; handle++)
+		{
+			if ((transactions[handle].status == TransactionStatus::Pending) &&
+				((transaction == NULL) || isScheduledBefore(&transactions[handle], transaction)))
+			{
+				transaction = &transactions[handle];
+			}
+		}
+
+		if (transaction == NULL) return;
+
+		if ((getRunningTransactions() >= pipelineDepth) && (getRunningTransactions() > 0))
+		{
+			for (byte handle = 0; handle < CALDUINO_TRANSACTIONS; handle++)
+			{
+				CalduinoTransaction *running = &transactions[handle];
+
+				if ((running->status == TransactionStatus::Running) && !running->waitingReply &&
+					(running->priority > transaction->priority) && ((preempted == NULL) || isScheduledBefore(preempted, running)))
+				{
+					preempted = running;
+				}
+			}
+
+			if (preempted == NULL) return;
+
+			preempted->status = TransactionStatus::Pending;
+#ifdef CALDUINO_STATS
+			stats.preemptions++;
+#endif
+		}
+
+		transaction->status = TransactionStatus::Running;
+		transaction->verifying = false;
+		transaction->deadline = calduinoSerial->getMillis() + transaction->retryTime;
+		waitPoll(transaction);
+	}
+}
+
+
+/**
+ * Get the number of transactions running on the EMS Bus.
+ *
+ * @return	The number of running transactions.
+ */
+
+byte Calduino::getRunningTransactions()
+{
+	byte running = 0;
+
+	for (byte handle = 0; handle < CALDUINO_TRANSACTIONS; handle++)
+	{
+		if (transactions[handle].status == TransactionStatus::Running) running++;
+	}
+
+	return running;
+}
+
+
+/**
+ * Get the transaction that sends its EMS Command in the poll received: the first running
+ * transaction waiting to be polled, by priority and in order of submission. While a set command waits for its acknowledge, which does not identify its
+ * sender, no other EMS Command is sent.
+ *
+ * @return	The transaction polled, NULL if there is none.
+ */
+
+CalduinoTransaction* Calduino::getPolledTransaction()
+{
+	CalduinoTransaction *polled = NULL;
+
+	for (byte handle = 0; handle < CALDUINO_TRANSACTIONS; handle++)
+	{
+		CalduinoTransaction *transaction = &transactions[handle];
+
+		if (transaction->status != TransactionStatus::Running) continue;
+
+		if (transaction->waitingReply)
+		{
+			if (transaction->write && !transaction->verifying) return NULL;
+		}
+		else if ((polled == NULL) || isScheduledBefore(transaction, polled))
+		{
+			polled = transaction;
+		}
+	}
+
+	return polled;
+}
+
+
+/**
+ * Restart the poll timeout of the transactions that keep waiting to be polled while the poll
+ * received is used by another one.
+ *
+ * @param [in]	polled	The transaction that sends its EMS Command in the poll received.
+ */
+
+void Calduino::refreshPollTimeouts(CalduinoTransaction *polled)
+{
+	for (byte handle = 0; handle < CALDUINO_TRANSACTIONS; handle++)
+	{
+		CalduinoTransaction *transaction = &transactions[handle];
+
+		if ((transaction != polled) && (transaction->status == TransactionStatus::Running) && !transaction->waitingReply)
+		{
+			transaction->timeout = calduinoSerial->getMillis() + getPollTimeout();
+		}
+	}
+}
+
+
+/**
+ * Get the transaction a frame addressed to Calduino answers. Replies with correct CRC are
+ * matched with the running transactions by their source, messageID and offset, so a late reply
+ * is also accepted while its transaction waits for the poll. Any other frame (acknowledges, CRC
+ * errors or unexpected replies) answers the last EMS Command sent, only if it is the single
+ * transaction waiting for its reply.
+ *
+ * @param [in]	frame	The frame received.
+ * @param 	  	len  	Number of bytes of the frame.
+ * @param 	  	crcOK	Whether the CRC of the frame is correct.
+ *
+ * @return	The transaction answered, NULL if there is none.
+ */
+
+CalduinoTransaction* Calduino::getReplyTransaction(byte *frame, int len, bool crcOK)
+{
+	for (byte handle = 0; (handle < CALDUINO_TRANSACTIONS) && crcOK && (len > 4); handle++)
+	{
+		CalduinoTransaction *transaction = &transactions[handle];
+
+		if ((transaction->status != TransactionStatus::Running) || ((frame[0] & 0x7F) != transaction->destinationID) ||
+			(frame[2] != transaction->messageID))
+		{
+			continue;
+		}
+
+		if (transaction->write)
+		{
+			if (transaction->verifying && transaction->waitingReply && (frame[3] == transaction->offset)) return transaction;
+		}
+		else
+		{
+			byte chunkOffset = frame[3] - transaction->offset;
+			byte chunk = chunkOffset / EMS_CHUNK_SIZE;
+
+			if ((frame[3] >= transaction->offset) && (chunkOffset % EMS_CHUNK_SIZE == 0) && (chunk < EMS_MAX_CHUNKS) &&
+				(transaction->missingChunks & (1U << chunk)))
+			{
+				return transaction;
+			}
+		}
+	}
+
+	// with several EMS Commands waiting for their reply it is unknown which one the frame answers,
+	// their reply timeouts decide
+	for (byte handle = 0; handle < CALDUINO_TRANSACTIONS; handle++)
+	{
+		if ((handle != commandTransaction) && (transactions[handle].status == TransactionStatus::Running) &&
+			transactions[handle].waitingReply)
+		{
+			return NULL;
+		}
+	}
+
+	if ((commandTransaction != ERROR_VALUE) && (transactions[commandTransaction].status == TransactionStatus::Running) &&
+		transactions[commandTransaction].waitingReply)
+	{
+		return &transactions[commandTransaction];
+	}
+
+	return NULL;
+}
+
+
+/**
+ * Get the status of a submitted transaction. Once a finished status (Succeeded or Failed) is
+ * returned, the slot is freed and the handle is no longer valid.
+ *
+ * @param	handle	The handle of the transaction returned by submit().
+ *
+ * @return	The status of the transaction.
+ */
+
+TransactionStatus Calduino::getStatus(byte handle)
+{
+	if (handle >= CALDUINO_TRANSACTIONS) return TransactionStatus::Free;
+
+	TransactionStatus status = transactions[handle].status;
+
+	if ((status == TransactionStatus::Succeeded) || (status == TransactionStatus::Failed))
+	{
+		transactions[handle].status = TransactionStatus::Free;
+	}
+
+	return status;
+}
+
+
+/**
+ * Get the latency estimator of the replies of the EMS device of the transaction passed as
+ * parameter.
+ *
+ * @param [in]	transaction	The transaction.
+ *
+ * @return	The latency estimator of its EMS device, NULL if the EMS device is not in the inventory.
+ */
+
+LatencyEstimator* Calduino::getReplyLatency(CalduinoTransaction *transaction)
+{
+	EMSDevice *device = getDeviceSlot(transaction->destinationID);
+
+	return (device == NULL ? NULL : &device->latency);
+}
+
+
+/**
+ * Get the time Calduino currently waits to be polled by the Bus Master before retrying. It is
+ * learned from the poll waits measured, EMSMaxWaitTime * RETRY_FACTOR at most. The poll waits
+ * are spread between 0 and the poll period of the Bus Master, so twice their mean estimates the
+ * poll period.
+ *
+ * @return	The timeout in milliseconds.
+ */
+
+unsigned long Calduino::getPollTimeout()
+{
+	return getAdaptiveTimeout(&pollLatency, 2, EMSMaxWaitTime * RETRY_FACTOR);
+}
+
+
+/**
+ * Get the time Calduino currently waits for the reply of an EMS device before retrying. It is
+ * learned from the response times of the EMS device, EMSMaxWaitTime at most.
+ *
+ * @param	deviceID	The EMS device.
+ *
+ * @return	The timeout in milliseconds.
+ */
+
+unsigned long Calduino::getReplyTimeout(DeviceID deviceID)
+{
+	EMSDevice *device = getDeviceSlot(deviceID);
+
+	return getAdaptiveTimeout(device == NULL ? NULL : &device->latency, 1, EMSMaxWaitTime);
+}
+
+
+/**
+ * Forget the latencies measured (e.g. after moving Calduino to another EMS Bus). Until new
+ * samples are measured, the timeouts are EMSMaxWaitTime * RETRY_FACTOR waiting for the poll and
+ * EMSMaxWaitTime waiting for the reply.
+ */
+
+void Calduino::resetLatency()
+{
+	memset(&pollLatency, 0, sizeof(LatencyEstimator));
+
+	for (byte i = 0; i < EMS_DEVICES; i++)
+	{
+		memset(&devices[i].latency, 0, sizeof(LatencyEstimator));
+	}
+}
+
+
+/**
+ * Get the stats of the EMS Datagram of the transaction passed as parameter.
+ *
+ * @param [in]	transaction	The transaction.
+ *
+ * @return	The stats of its EMS Datagram, NULL if the EMS Command does not correspond to any
+ * 			or without CALDUINO_STATS.
+ */
+
+EMSDatagramStats* Calduino::getDatagramStats(CalduinoTransaction *transaction)
+{
+#ifdef CALDUINO_STATS
+	return (transaction->eMSDatagramID == ERROR_VALUE ? NULL : &stats.datagrams[transaction->eMSDatagramID]);
+#else
+	return NULL;
+#endif
+}
+
+
+#ifdef CALDUINO_STATS
+/**
+ * Get the stats of the EMS Bus transactions since Calduino started or the stats were reset.
+ *
+ * @return	The Calduino Stats.
+ */
+
+const CalduinoStats &Calduino::getStats()
+{
+	// add the frames discarded by the Calduino Serial since the last call
+	uint16_t rxOverflows = calduinoSerial->rxOverflows();
+	stats.rxOverflows += rxOverflows - lastRxOverflows;
+	lastRxOverflows = rxOverflows;
+
+	return stats;
+}
+
+
+/** Reset all the stats counters and histograms. */
+
+void Calduino::resetStats()
+{
+	memset(&stats, 0, sizeof(CalduinoStats));
+}
+#endif
+
+
+/**
+ * Generic method to get an EMS Datagram. By default will obtain the whole EMSDatagram message
+ * Length bytes. To obtain only a Calduino Data, set accordingly length and offset parameters.
+ * If the message length is greater than the MAX_EMS_READ, the command will be splitted in
+ * shorter requests.
+ *
+ * @param [out]	inEMSBuffer	Pointer to the buffer where the EMS Datagram received will be saved.
+ * 							It will always have the size of the whole EMS Message, no matter if
+ * 							only a Calduino Data is requested.
+ * @param 	   	eMSDatagram	The EMSDatagram to obtain.
+ * @param 	   	length	   	(Optional) The length of the Calduino Data.
+ * @param 	   	offset	   	(Optional) The offset of the Calduino Data in the EMSBuffer.
+ *
+ * @return	True if it succeeds, false otherwise.
+ */
+
+boolean Calduino::getEMSBuffer(byte* inEMSBuffer, EMSDatagram eMSDatagram, byte length = 0, byte offset = 0)
+{
+	// get the EMS Datagram Bytes, repeat operation if failed until timeout
+	byte handle = submitTransaction(false, eMSDatagram.destinationID, eMSDatagram.messageID, (offset == 0 ? offset : offset - INITIAL_OFFSET),
+		(length == 0 ? eMSDatagram.messageLength : length), NULL, inEMSBuffer, EMSMaxWaitTime * RETRY_FACTOR * 2, TransactionPriority::InteractiveRead);
+
+	return waitTransaction(handle);
+}
+
+/**
+ * Configure the cache of the EMS Datagram passed as parameter. While the snapshot of a cached
+ * EMS Datagram is younger than its TTL, the getters of its Calduino Data are served from the
+ * cache without any EMS Bus transaction. Once stale, the whole EMS Datagram is refreshed.
+ *
+ * @param	eMSDatagramID	The EMS Datagram to be cached.
+ * @param	ttl			 	Time in milliseconds while the snapshot is fresh. 0 disables the cache
+ * 							of this EMS Datagram and frees its slot.
+ *
+ * @return	True if it succeeds, false if there is no free slot or the EMS Datagram is too long to
+ * 			be cached (or without CALDUINO_CACHE).
+ */
+
+boolean Calduino::setCacheTTL(EMSDatagramID eMSDatagramID, unsigned long ttl)
+{
+#ifndef CALDUINO_CACHE
+	return (ttl == 0);
+#else
+	// get from program memory the EMS Datagram passed as parameter
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, eMSDatagramIDs[eMSDatagramID], sizeof(EMSDatagram));
+
+	// search the slot already assigned to this EMS Datagram, or a free one
+	EMSCacheSlot *slot = getCacheSlot(eMSDatagramIDs[eMSDatagramID]);
+
+	for (byte i = 0; (i < EMS_CACHE_SLOTS) && (slot == NULL) && (ttl > 0); i++)
+	{
+		if (cache[i].eMSDatagramID == ERROR_VALUE) slot = &cache[i];
+	}
+
+	if (ttl == 0)
+	{
+		// free the slot (if any)
+		if (slot != NULL) slot->eMSDatagramID = ERROR_VALUE;
+		return true;
+	}
+
+	if ((slot == NULL) || (eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD > EMS_CACHE_BUFFER_SIZE))
+	{
+		return false;
+	}
+
+	if (slot->eMSDatagramID != eMSDatagramID)
+	{
+		slot->eMSDatagramID = eMSDatagramID;
+		slot->valid = false;
+	}
+
+	slot->ttl = ttl;
+
+	return true;
+#endif
+}
+
+
+/** Invalidate all the EMS Datagram snapshots, forcing them to be refreshed in the next read. */
+
+void Calduino::invalidateCache()
+{
+#ifdef CALDUINO_CACHE
+	for (byte i = 0; i < EMS_CACHE_SLOTS; i++)
+	{
+		cache[i].valid = false;
+	}
+#endif
+}
+
+
+/**
+ * Store the data of a telegram in the snapshot of its EMS Datagram, if cached. The telegram
+ * matches an EMS Datagram when it is sent by its device (not a read request) with its
+ * messageID. A telegram with the whole EMS Message refreshes the snapshot, while a telegram with
+ * only a part of it updates those bytes of a valid snapshot.
+ *
+ * @param [in]	telegram	The telegram received, with correct CRC.
+ * @param 	  	len			Number of bytes of the telegram (headers, CRC and break included).
+ */
+
+void Calduino::storeTelegram(byte *telegram, int len)
+{
+#ifdef CALDUINO_CACHE
+	// read requests do not contain data
+	if ((len <= EMS_DATAGRAM_OVERHEAD) || (telegram[1] & 0x80)) return;
+
+	byte dataLength = len - EMS_DATAGRAM_OVERHEAD;
+	byte offset = telegram[3];
+
+	for (byte i = 0; i < EMS_CACHE_SLOTS; i++)
+	{
+		if (cache[i].eMSDatagramID == ERROR_VALUE) continue;
+
+		// get from program memory the EMS Datagram of the slot
+		EMSDatagram eMSDatagram;
+		memcpy_P(&eMSDatagram, eMSDatagramIDs[cache[i].eMSDatagramID], sizeof(EMSDatagram));
+
+		if (((telegram[0] & 0x7F) != eMSDatagram.destinationID) || (telegram[2] != eMSDatagram.messageID)) continue;
+
+		if (offset + dataLength > eMSDatagram.messageLength)
+		{
+			dataLength = (offset < eMSDatagram.messageLength ? eMSDatagram.messageLength - offset : 0);
+		}
+
+		if ((offset == 0) && (dataLength == eMSDatagram.messageLength))
+		{
+			cache[i].valid = true;
+			cache[i].timestamp = calduinoSerial->getMillis();
+		}
+
+		if (cache[i].valid)
+		{
+			memcpy(&cache[i].buffer[INITIAL_OFFSET + offset], &telegram[INITIAL_OFFSET], dataLength);
+		}
+
+		return;
+	}
+#endif
+}
+
+
+/**
+ * Get the inventory slot of the EMS device passed as parameter.
+ *
+ * @param	deviceID	The EMS device ID.
+ *
+ * @return	The EMS Device, NULL if the EMS device is not in the inventory.
+ */
+
+EMSDevice* Calduino::getDeviceSlot(byte deviceID)
+{
+	for (byte i = 0; i < EMS_DEVICES; i++)
+	{
+		if (devices[i].deviceID == deviceID) return &devices[i];
+	}
+
+	return NULL;
+}
+
+
+/**
+ * Update the inventory with a telegram received. Its sender is present on the EMS Bus, and if
+ * the telegram is the answer to a version query, its product ID and version are stored.
+ *
+ * @param [in]	telegram	The telegram received, with correct CRC.
+ * @param 	  	len			Number of bytes of the telegram (headers, CRC and break included).
+ */
+
+void Calduino::updateInventory(byte *telegram, int len)
+{
+	// polls and acknowledges do not identify their sender
+	if (len <= INITIAL_OFFSET) return;
+
+	EMSDevice *device = getDeviceSlot(telegram[0] & 0x7F);
+	if (device == NULL) return;
+
+	device->status = DeviceStatus::Present;
+
+	// the EMS device is back on the EMS Bus, the next EMS Command probes it without waiting the backoff
+	if (device->breaker == BreakerState::Open) device->probeTime = calduinoSerial->getMillis();
+
+	if (!(telegram[1] & 0x80) && (telegram[2] == MessageID::Version_ID) && (telegram[3] == 0) && (len >= VERSION_MESSAGE_SIZE + EMS_DATAGRAM_OVERHEAD))
+	{
+		device->productID = telegram[INITIAL_OFFSET];
+		device->versionMajor = telegram[INITIAL_OFFSET + 1];
+		device->versionMinor = telegram[INITIAL_OFFSET + 2];
+	}
+}
+
+
+/**
+ * Check whether an EMS Command can be sent to the EMS device passed as parameter.
+ *
+ * @param [in]	device	The EMS device (NULL if it is not in the inventory).
+ *
+ * @return	False if the EMS device is absent, its breaker is open and the backoff has not
+ * 			expired yet, or its breaker is half open (probe running), true otherwise.
+ */
+
+boolean Calduino::isDeviceAvailable(EMSDevice *device)
+{
+	if (device == NULL) return true;
+
+	if ((device->status == DeviceStatus::Absent) || (device->breaker == BreakerState::HalfOpen)) return false;
+
+	return ((device->breaker == BreakerState::Closed) || ((long)(calduinoSerial->getMillis() - device->probeTime) >= 0));
+}
+
+
+/**
+ * Update the circuit breaker of an EMS device with the result of a transaction whose EMS Command
+ * was sent. A success closes it. BREAKER_FAILURES consecutive failures (replies lost or wrong)
+ * open it during BREAKER_BACKOFF, and every failed probe doubles the backoff (up to
+ * BREAKER_MAX_BACKOFF). A random jitter of up to a
+ * BREAKER_JITTER_DIVISOR part of the backoff is added, so the probes of several EMS devices
+ * are spread.
+ *
+ * @param [in,out]	device 	The EMS device.
+ * @param 		  	success	Whether the transaction succeeded.
+ */
+
+void Calduino::updateBreaker(EMSDevice *device, boolean success)
+{
+	if (success)
+	{
+		device->breaker = BreakerState::Closed;
+		device->failures = 0;
+		device->backoff = BREAKER_BACKOFF;
+		return;
+	}
+
+	if (device->failures < ERROR_VALUE) device->failures++;
+
+	if (device->breaker == BreakerState::HalfOpen)
+	{
+		device->backoff = (device->backoff > BREAKER_MAX_BACKOFF / 2 ? BREAKER_MAX_BACKOFF : device->backoff * 2);
+	}
+	else if ((device->breaker == BreakerState::Open) || (device->failures < BREAKER_FAILURES))
+	{
+		// transactions submitted before the breaker opened do not extend the backoff
+		return;
+	}
+
+	device->breaker = BreakerState::Open;
+	device->probeTime = calduinoSerial->getMillis() + device->backoff + random(device->backoff / BREAKER_JITTER_DIVISOR + 1);
+}
+
+
+/**
+ * Discover the EMS devices installed, sending a version query to every EMS device of the
+ * inventory. The EMS devices that do not answer are marked as absent, so the EMS Commands
+ * addressed to them fail immediately instead of waiting for their whole retry time. Each query
+ * is retried only during EMSMaxWaitTime * DISCOVERY_RETRY_FACTOR and closes the breaker of the
+ * EMS device. If the Bus Master does not poll Calduino the queries are not sent and the EMS
+ * devices stay unknown. In listen only mode no query is sent, the EMS devices are only found by
+ * the telegrams they send.
+ *
+ * @return	The number of EMS devices present.
+ */
+
+byte Calduino::discoverDevices()
+{
+	byte inEMSBuffer[VERSION_MESSAGE_SIZE + EMS_DATAGRAM_OVERHEAD];
+	byte present = 0;
+
+	for (byte i = 0; i < EMS_DEVICES; i++)
+	{
+		EMSDevice *device = &devices[i];
+
+		if (!listenOnly)
+		{
+			// absent EMS devices are queried again, the answer is stored by updateInventory
+			device->status = DeviceStatus::Unknown;
+			updateBreaker(device, true);
+
+			byte handle = submitTransaction(false, device->deviceID, MessageID::Version_ID, 0, VERSION_MESSAGE_SIZE, NULL, inEMSBuffer, EMSMaxWaitTime * DISCOVERY_RETRY_FACTOR, TransactionPriority::InteractiveRead);
+
+			// only an EMS device that does not answer the query sent is absent, if Calduino has not been
+			// polled it stays unknown (the freed slot keeps the state of the failed transaction)
+			if (!waitTransaction(handle) && (handle != ERROR_VALUE) && transactions[handle].waitingReply &&
+				(device->status == DeviceStatus::Unknown))
+			{
+				device->status = DeviceStatus::Absent;
+			}
+		}
+
+		if (device->status == DeviceStatus::Present) present++;
+	}
+
+	return present;
+}
+
+
+/**
+ * Get the entry of the inventory of the EMS device passed as parameter.
+ *
+ * @param	deviceID	The EMS device ID.
+ *
+ * @return	The EMS Device (status, product ID and version), NULL if the EMS device is not in the
+ * 			inventory (e.g. Calduino itself).
+ */
+
+const EMSDevice *Calduino::getDevice(DeviceID deviceID)
+{
+	return getDeviceSlot(deviceID);
+}
+
+
+/**
+ * Get the cache slot assigned to the EMS Datagram passed as parameter.
+ *
+ * @param	pEMSDatagram	Pointer to the EMS Datagram in program memory.
+ *
+ * @return	The cache slot, NULL if the EMS Datagram is not cached.
+ */
+
+EMSCacheSlot* Calduino::getCacheSlot(const EMSDatagram *pEMSDatagram)
+{
+#ifdef CALDUINO_CACHE
+	for (byte i = 0; i < EMS_CACHE_SLOTS; i++)
+	{
+		if ((cache[i].eMSDatagramID != ERROR_VALUE) && (eMSDatagramIDs[cache[i].eMSDatagramID] == pEMSDatagram))
+		{
+			return &cache[i];
+		}
+	}
+#endif
+
+	return NULL;
+}
+
+
+/**
+ * Get an EMS Datagram going through the cache. If the EMS Datagram is cached, the whole
+ * snapshot is copied in inEMSBuffer (refreshing it first if it is stale). Otherwise only the
+ * bytes requested are obtained from the EMS Bus.
+ *
+ * @param [out]	inEMSBuffer 	Pointer to the buffer where the EMS Datagram will be saved. It
+ * 								will always have the size of the whole EMS Message.
+ * @param 	   	pEMSDatagram	Pointer to the EMS Datagram in program memory.
+ * @param 	   	eMSDatagram 	The EMSDatagram to obtain.
+ * @param 	   	length	   		(Optional) The length of the Calduino Data.
+ * @param 	   	offset	   		(Optional) The offset of the Calduino Data in the EMSBuffer.
+ *
+ * @return	True if it succeeds, false otherwise.
+ */
+
+boolean Calduino::getCachedEMSBuffer(byte *inEMSBuffer, const EMSDatagram *pEMSDatagram, EMSDatagram eMSDatagram, byte length, byte offset)
+{
+	EMSCacheSlot *slot = getCacheSlot(pEMSDatagram);
+
+	// not cached, get only the bytes requested
+	if (slot == NULL)
+	{
+		return getEMSBuffer(inEMSBuffer, eMSDatagram, length, offset);
+	}
+
+	// refresh the whole EMS Datagram if the snapshot is stale
+	if ((!slot->valid) || (calduinoSerial->getMillis() - slot->timestamp >= slot->ttl))
+	{
+		// in listen only mode snapshots are only refreshed by the telegrams sent by the EMS devices
+		if (listenOnly) return false;
+
+		slot->valid = getEMSBuffer(slot->buffer, eMSDatagram);
+		slot->timestamp = calduinoSerial->getMillis();
+
+		if (!slot->valid) return false;
+	}
+
+	memcpy(inEMSBuffer, slot->buffer, eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD);
+
+	return true;
+}
+
+
+/**
+ * Get the bytes of a CalduinoField going through the cache. It is the only part of
+ * Calduino::get that is not known at compile time.
+ *
+ * @param [out]	inEMSBuffer  	Pointer to the buffer where the EMS Datagram will be saved.
+ * @param 	   	eMSDatagramID	The EMS Datagram that contains the field.
+ * @param 	   	length		 	The length of the field.
+ * @param 	   	offset		 	The offset of the field in the EMSBuffer.
+ *
+ * @return	True if it succeeds, false otherwise.
+ */
+
+boolean Calduino::getFieldBuffer(byte *inEMSBuffer, EMSDatagramID eMSDatagramID, byte length, byte offset)
+{
+	// get from program memory the EMSDatagram
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, eMSDatagramIDs[eMSDatagramID], sizeof(EMSDatagram));
+
+	return getCachedEMSBuffer(inEMSBuffer, eMSDatagramIDs[eMSDatagramID], eMSDatagram, length, offset);
+}
+
+
+/**
+ * Get a Calduino Data of type Byte.
+ *
+ * @param	typeIdx	Identifier of the Calduino Data Byte requested.
+ *
+ * @return	The value of the Calduino Data requested, ERROR_VALUE otherwise.
+ */
+
+byte Calduino::getCalduinoByteValue(ByteRequest typeIdx)
+{
+	byte result = ERROR_VALUE;
+
+	// get from program memory the CalduinoDataRequest
+	CalduinoDataRequest calduinoDataRequest;
+	memcpy_P(&calduinoDataRequest, &byteRequests[typeIdx], sizeof(CalduinoDataRequest));
+
+	// get from program memory the EMSDatagram
+	EMSDatagram *pEMSDatagram = eMSDatagramIDs[calduinoDataRequest.eMSDatagramID];
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, pEMSDatagram, sizeof(EMSDatagram));
+
+	// buffer where the EMS Datagram will be saved (size is message size plus EMS_DATAGRAM_OVERHEAD bytes to store the headers, CRC and break)
+	byte inEMSBuffer[eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD];
+
+	// get an EMS Buffer with the parameters requested. Length is 1 (byte) and offset is the position of the data type in the EMSBuffer
+	boolean operationStatus = getCachedEMSBuffer(inEMSBuffer, pEMSDatagram, eMSDatagram, 1, calduinoDataRequest.offset);
+
+	if (operationStatus)
+	{
+		result = decodeEMSByte(inEMSBuffer, calduinoDataRequest.offset);
+	}
+
+	return result;
+}
+
+
+/**
+ * Get a Calduino Data of type Float in fixed point, without using float. The error code
+ * (errCode_f) is only available up to 3276, use readUBAMonitorFast for the whole range.
+ *
+ * @param	typeIdx	Identifier of the Calduino Data Float requested.
+ *
+ * @return	The value of the Calduino Data requested in tenths, FIXED_ERROR_VALUE otherwise.
+ */
+
+int16_t Calduino::getCalduinoFixedValue(FloatRequest typeIdx)
+{
+	int16_t result = FIXED_ERROR_VALUE;
+
+	// get from program memory the CalduinoDataRequest
+	CalduinoDataRequest calduinoDataRequest;
+	memcpy_P(&calduinoDataRequest, &floatRequests[typeIdx], sizeof(CalduinoDataRequest));
+
+	// get from program memory the EMSDatagram
+	EMSDatagram *pEMSDatagram = eMSDatagramIDs[calduinoDataRequest.eMSDatagramID];
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, pEMSDatagram, sizeof(EMSDatagram));
+
+	// buffer where the EMS Datagram will be saved (size is message size plus EMS_DATAGRAM_OVERHEAD bytes to store the headers, CRC and break)
+	byte inEMSBuffer[eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD];
+
+	// get an EMS Buffer with the parameters requested. Length is 1 or 2 (bytes) and offset is the position of the data type in the EMSBuffer
+	boolean operationStatus = getCachedEMSBuffer(inEMSBuffer, pEMSDatagram, eMSDatagram, calduinoDataRequest.floatBytes, calduinoDataRequest.offset);
+
+	if (operationStatus)
+	{
+		result = decodeEMSFixed(inEMSBuffer, calduinoDataRequest.offset, calduinoDataRequest.floatBytes, calduinoDataRequest.floatFactor);
+	}
+
+	return result;
+}
+
+
+#ifdef CALDUINO_FLOAT
+/**
+ * Get a Calduino Data of type Float.
+ *
+ * @param	typeIdx	Identifier of the Calduino Data Float requested.
+ *
+ * @return	The value of the Calduino Data requested, NAN otherwise.
+ */
+
+float Calduino::getCalduinoFloatValue(FloatRequest typeIdx)
+{
+	float result = NAN;
+
+	// get from program memory the CalduinoDataRequest
+	CalduinoDataRequest calduinoDataRequest;
+	memcpy_P(&calduinoDataRequest, &floatRequests[typeIdx], sizeof(CalduinoDataRequest));
+
+	// get from program memory the EMSDatagram
+	EMSDatagram *pEMSDatagram = eMSDatagramIDs[calduinoDataRequest.eMSDatagramID];
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, pEMSDatagram, sizeof(EMSDatagram));
+
+	// buffer where the EMS Datagram will be saved (size is message size plus EMS_DATAGRAM_OVERHEAD bytes to store the headers, CRC and break)
+	byte inEMSBuffer[eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD];
+
+	// get an EMS Buffer with the parameters requested. Length is 1 or 2 (bytes) and offset is the position of the data type in the EMSBuffer
+	boolean operationStatus = getCachedEMSBuffer(inEMSBuffer, pEMSDatagram, eMSDatagram, calduinoDataRequest.floatBytes, calduinoDataRequest.offset);
+
+	if (operationStatus)
+	{
+		// not a conversion of getCalduinoFixedValue, the UInt codes do not fit in fixed point
+		result = decodeEMSFloat(inEMSBuffer, calduinoDataRequest.offset, calduinoDataRequest.floatBytes, calduinoDataRequest.floatFactor);
+	}
+
+	return result;
+}
+#endif
+
+
+/**
+ * Get a Calduino Data of type ULong.
+ *
+ * @param	typeIdx	Identifier of the Calduino Data ULong requested.
+ *
+ * @return	The value of the Calduino Data requested, NAN otherwise.
+ */
+
+unsigned long Calduino::getCalduinoUlongValue(ULongRequest typeIdx)
+{
+	unsigned long result = NAN;
+
+	// get from program memory the CalduinoDataRequest
+	CalduinoDataRequest calduinoDataRequest;
+	memcpy_P(&calduinoDataRequest, &uLongRequests[typeIdx], sizeof(CalduinoDataRequest));
+
+	// get from program memory the EMSDatagram
+	EMSDatagram *pEMSDatagram = eMSDatagramIDs[calduinoDataRequest.eMSDatagramID];
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, pEMSDatagram, sizeof(EMSDatagram));
+
+	// buffer where the EMS Datagram will be saved (size is message size plus EMS_DATAGRAM_OVERHEAD bytes to store the headers, CRC and break)
+	byte inEMSBuffer[eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD];
+
+	// get an EMS Buffer with the parameters requested. Length is 3 (bytes) and offset is the position of the data type in the EMSBuffer
+	boolean operationStatus = getCachedEMSBuffer(inEMSBuffer, pEMSDatagram, eMSDatagram, 3, calduinoDataRequest.offset);
+
+	if (operationStatus)
+	{
+		result = decodeEMSULong(inEMSBuffer, calduinoDataRequest.offset);
+	}
+
+	return result;
+}
+
+
+/**
+ * Get a Calduino Data of type Bit.
+ *
+ * @param	typeIdx	Identifier of the Calduino Data Bit requested.
+ *
+ * @return	The value of the Calduino Data requested, false otherwise.
+ */
+
+boolean Calduino::getCalduinoBitValue(BitRequest typeIdx)
+{
+	boolean result = NAN;
+
+	// get from program memory the CalduinoDataRequest
+	CalduinoDataRequest calduinoDataRequest;
+	memcpy_P(&calduinoDataRequest, &bitRequests[typeIdx], sizeof(CalduinoDataRequest));
+
+	// get from program memory the EMSDatagram
+	EMSDatagram *pEMSDatagram = eMSDatagramIDs[calduinoDataRequest.eMSDatagramID];
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, pEMSDatagram, sizeof(EMSDatagram));
+
+	// buffer where the EMS Datagram will be saved (size is message size plus EMS_DATAGRAM_OVERHEAD bytes to store the headers, CRC and break)
+	byte inEMSBuffer[eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD];
+
+	// get an EMS Buffer with the parameters requested. Length is 1 (byte) and offset is the position of the data type in the EMSBuffer
+	boolean operationStatus = getCachedEMSBuffer(inEMSBuffer, pEMSDatagram, eMSDatagram, 1, calduinoDataRequest.offset);
+
+	if (operationStatus)
+	{
+		result = decodeEMSBit(inEMSBuffer, calduinoDataRequest.offset, calduinoDataRequest.bitOffset);
+	}
+
+	return result;
+}
+
+
+/**
+ * Get from program memory the Calduino Data referenced by a Calduino Value Request.
+ *
+ * @param [in] 	request			The Calduino Value Request.
+ * @param [out]	eMSDatagramID	The EMS Datagram that contains the Calduino Data.
+ * @param [out]	calduinoData	The Calduino Data referenced (without name nor unit).
+ *
+ * @return	True if it succeeds, false if the encode type is not supported.
+ */
+
+static boolean loadCalduinoData(const CalduinoValueRequest *request, byte *eMSDatagramID, CalduinoData *calduinoData)
+{
+	const CalduinoDataRequest *requests;
+
+	switch (request->encodeType)
+	{
+		case CalduinoEncodeType::Byte: requests = byteRequests; break;
+		case CalduinoEncodeType::Bit: requests = bitRequests; break;
+#ifdef CALDUINO_FLOAT
+		case CalduinoEncodeType::Float: requests = floatRequests; break;
+#endif
+		case CalduinoEncodeType::Fixed: requests = floatRequests; break;
+		case CalduinoEncodeType::ULong: requests = uLongRequests; break;
+		default: return false;
+	}
+
+	CalduinoDataRequest calduinoDataRequest;
+	memcpy_P(&calduinoDataRequest, &requests[request->index], sizeof(CalduinoDataRequest));
+
+	*eMSDatagramID = calduinoDataRequest.eMSDatagramID;
+	calduinoData->dataName = NULL;
+	calduinoData->encodeType = request->encodeType;
+	calduinoData->unit = CalduinoUnit::None;
+	calduinoData->offset = calduinoDataRequest.offset;
+	calduinoData->bitOffset = calduinoDataRequest.bitOffset;
+	calduinoData->floatBytes = calduinoDataRequest.floatBytes;
+	calduinoData->floatFactor = calduinoDataRequest.floatFactor;
+	return true;
+}
+
+
+/**
+ * Decode a Calduino Data in the member of the Calduino Value corresponding to its encode type.
+ *
+ * @param [in] 	calduinoData	The Calduino Data to decode.
+ * @param [in] 	inEMSBuffer 	The EMS bytes received.
+ * @param [out]	result			The Calduino Value where the result is stored.
+ */
+
+static void decodeCalduinoValue(CalduinoData *calduinoData, byte *inEMSBuffer, CalduinoValue *result)
+{
+	switch (calduinoData->encodeType)
+	{
+		case CalduinoEncodeType::Byte: result->byteValue = calduinoData->decodeByteValue(inEMSBuffer); break;
+		case CalduinoEncodeType::Bit: result->bitValue = calduinoData->decodeBitValue(inEMSBuffer); break;
+#ifdef CALDUINO_FLOAT
+		case CalduinoEncodeType::Float: result->floatValue = calduinoData->decodeFloatValue(inEMSBuffer); break;
+#endif
+		case CalduinoEncodeType::Fixed: result->fixedValue = calduinoData->decodeFixedValue(inEMSBuffer); break;
+		case CalduinoEncodeType::ULong: result->uLongValue = calduinoData->decodeULongValue(inEMSBuffer); break;
+		// loadCalduinoData only accepts the encode types above
+		default: break;
+	}
+}
+
+
+/**
+ * Get a batch of Calduino Data with the minimum number of EMS Bus transactions. The requests are
+ * grouped by EMS Datagram and, inside each EMS Datagram, the bytes requested are merged in
+ * reads as long as they fit in one EMS Command and the bytes skipped between two Calduino Data
+ * are cheaper than a new poll slot (EMS_POLL_SLOT_COST). Cached EMS Datagrams are served from
+ * the cache.
+ *
+ * @param [in] 	requests	Array of Calduino Value Requests.
+ * @param 	   	count   	Number of requests in the array.
+ * @param [out]	results 	Array of count Calduino Values where the results are stored, in the
+ * 							same order than the requests. Failed values are set to ERROR_VALUE,
+ * 							FIXED_ERROR_VALUE, NAN or false, as the single getters do.
+ *
+ * @return	True if all the values were obtained, false otherwise.
+ */
+
+boolean Calduino::readValues(const CalduinoValueRequest *requests, byte count, CalduinoValue *results)
+{
+	boolean operationStatus = true;
+	boolean done[count];
+	byte eMSDatagramID, requestDatagramID;
+	CalduinoData calduinoData;
+
+	// initialize the results with the error values
+	for (byte i = 0; i < count; i++)
+	{
+		done[i] = false;
+
+		switch (requests[i].encodeType)
+		{
+#ifdef CALDUINO_FLOAT
+			case CalduinoEncodeType::Float: results[i].floatValue = NAN; break;
+#endif
+			case CalduinoEncodeType::Fixed: results[i].fixedValue = FIXED_ERROR_VALUE; break;
+			case CalduinoEncodeType::ULong: results[i].uLongValue = ERROR_VALUE; break;
+			case CalduinoEncodeType::Bit: results[i].bitValue = false; break;
+			default: results[i].byteValue = ERROR_VALUE;
+		}
+	}
+
+	for (byte i = 0; i < count; i++)
+	{
+		if (done[i]) continue;
+
+		if (!loadCalduinoData(&requests[i], &eMSDatagramID, &calduinoData))
+		{
+			done[i] = true;
+			operationStatus = false;
+			continue;
+		}
+
+		// every request of this EMS Datagram will be read in this iteration
+		EMSDatagram *pEMSDatagram = eMSDatagramIDs[eMSDatagramID];
+		EMSDatagram eMSDatagram;
+		memcpy_P(&eMSDatagram, pEMSDatagram, sizeof(EMSDatagram));
+
+		// collect the ranges of bytes requested in this EMS Datagram, sorted by offset
+		byte rangeStart[count];
+		byte rangeEnd[count];
+		byte ranges = 0;
+
+		for (byte j = i; j < count; j++)
+		{
+			if ((!done[j]) && loadCalduinoData(&requests[j], &requestDatagramID, &calduinoData) && (requestDatagramID == eMSDatagramID))
+			{
+				byte k = ranges++;
+				for (; (k > 0) && (rangeStart[k - 1] > calduinoData.offset); k--)
+				{
+					rangeStart[k] = rangeStart[k - 1];
+					rangeEnd[k] = rangeEnd[k - 1];
+				}
+				rangeStart[k] = calduinoData.offset;
+				rangeEnd[k] = calduinoData.offset + calduinoData.getLength();
+			}
+		}
+
+		// buffer where the EMS Datagram will be saved (size is message size plus EMS_DATAGRAM_OVERHEAD bytes to store the headers, CRC and break)
+		byte inEMSBuffer[eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD];
+		boolean cached = (getCacheSlot(pEMSDatagram) != NULL);
+		byte r = 0;
+
+		while (r < ranges)
+		{
+			// merge the next ranges while they fit in one EMS Command and the gap is cheaper than a poll slot
+			byte readStart = rangeStart[r];
+			byte readEnd = rangeEnd[r];
+
+			for (r++; (r < ranges) && (cached ||
+				((rangeEnd[r] - readStart <= MAX_EMS_READ - EMS_DATAGRAM_OVERHEAD) && (rangeStart[r] <= readEnd + EMS_POLL_SLOT_COST))); r++)
+			{
+				if (rangeEnd[r] > readEnd) readEnd = rangeEnd[r];
+			}
+
+			// get the merged range (or the whole snapshot if the EMS Datagram is cached)
+			boolean readStatus = getCachedEMSBuffer(inEMSBuffer, pEMSDatagram, eMSDatagram, readEnd - readStart, readStart);
+			operationStatus &= readStatus;
+
+			// decode the requests contained in the range read
+			for (byte j = i; j < count; j++)
+			{
+				if ((!done[j]) && loadCalduinoData(&requests[j], &requestDatagramID, &calduinoData) && (requestDatagramID == eMSDatagramID))
+				{
+					if ((calduinoData.offset >= readStart) && (calduinoData.offset < readEnd))
+					{
+						if (readStatus) decodeCalduinoValue(&calduinoData, inEMSBuffer, &results[j]);
+						done[j] = true;
+					}
+				}
+			}
+		}
+	}
+
+	return operationStatus;
+}
+
+
+/** Decode a Calduino Data of the value lists of Calduino.h in the member of the struct. */
+#define CALDUINO_DECODE_Byte(offset, bitOffset, floatBytes, floatFactor) decodeEMSByte(inEMSBuffer, offset)
+#define CALDUINO_DECODE_Bit(offset, bitOffset, floatBytes, floatFactor) decodeEMSBit(inEMSBuffer, offset, bitOffset)
+#define CALDUINO_DECODE_Float(offset, bitOffset, floatBytes, floatFactor) decodeEMSFixed(inEMSBuffer, offset, floatBytes, floatFactor)
+#define CALDUINO_DECODE_ULong(offset, bitOffset, floatBytes, floatFactor) decodeEMSULong(inEMSBuffer, offset)
+#define CALDUINO_DECODE_UInt(offset, bitOffset, floatBytes, floatFactor) decodeEMSUInt(inEMSBuffer, offset)
+#define CALDUINO_DATA_DECODE(name, label, encodeType, unit, offset, bitOffset, floatBytes, floatFactor) values->name = CALDUINO_DECODE_##encodeType(offset, bitOffset, floatBytes, floatFactor);
+
+
+/**
+ * Get the UBA Monitor Fast with one EMS Buffer (or cached snapshot) and decode all its values.
+ *
+ * @param [out]	values	The struct where the values are stored (Float values in tenths).
+ *
+ * @return	True if it succeeds, false otherwise (values are not modified).
+ */
+
+boolean Calduino::readUBAMonitorFast(UBAMonitorFast *values)
+{
+	byte inEMSBuffer[UBA_MONITOR_FAST_MESSAGE_SIZE + EMS_DATAGRAM_OVERHEAD];
+
+	if (!getFieldBuffer(inEMSBuffer, EMSDatagramID::UBA_Monitor_Fast, 0, 0)) return false;
+
+	UBA_MONITOR_FAST_VALUES(CALDUINO_DATA_DECODE)
+	return true;
+}
+
+
+/**
+ * Get the UBA Monitor Slow with one EMS Buffer (or cached snapshot) and decode all its values.
+ *
+ * @param [out]	values	The struct where the values are stored (Float values in tenths).
+ *
+ * @return	True if it succeeds, false otherwise (values are not modified).
+ */
+
+boolean Calduino::readUBAMonitorSlow(UBAMonitorSlow *values)
+{
+	byte inEMSBuffer[UBA_MONITOR_SLOW_MESSAGE_SIZE + EMS_DATAGRAM_OVERHEAD];
+
+	if (!getFieldBuffer(inEMSBuffer, EMSDatagramID::UBA_Monitor_Slow, 0, 0)) return false;
+
+	UBA_MONITOR_SLOW_VALUES(CALDUINO_DATA_DECODE)
+	return true;
+}
+
+
+/**
+ * Get the Working Mode of a heating circuit with one EMS Buffer (or cached snapshot) and decode
+ * all its values.
+ *
+ * @param 	   	selHC 	The heating circuit (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
+ * @param [out]	values	The struct where the values are stored (Float values in tenths).
+ *
+ * @return	True if it succeeds, false otherwise (values are not modified).
+ */
+
+boolean Calduino::readWorkingModeHC(byte selHC, WorkingModeHC *values)
+{
+	byte inEMSBuffer[WORKING_MODE_HC_MESSAGE_SIZE + EMS_DATAGRAM_OVERHEAD];
+
+	if ((selHC == 0) || (selHC > MAX_HC_CIRCUIT)) return false;
+	if (!getFieldBuffer(inEMSBuffer, EMSDatagramID::Working_Mode_HC_1 + (selHC - 1) * 4, 0, 0)) return false;
+
+	WORKING_MODE_HC_VALUES(CALDUINO_DATA_DECODE)
+	return true;
+}
+
+
+/**
+ * Get the Monitor of a heating circuit with one EMS Buffer (or cached snapshot) and decode all
+ * its values.
+ *
+ * @param 	   	selHC 	The heating circuit (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
+ * @param [out]	values	The struct where the values are stored (Float values in tenths).
+ *
+ * @return	True if it succeeds, false otherwise (values are not modified).
+ */
+
+boolean Calduino::readMonitorHC(byte selHC, MonitorHC *values)
+{
+	byte inEMSBuffer[MONITOR_HC_MESSAGE_SIZE + EMS_DATAGRAM_OVERHEAD];
+
+	if ((selHC == 0) || (selHC > MAX_HC_CIRCUIT)) return false;
+	if (!getFieldBuffer(inEMSBuffer, EMSDatagramID::Monitor_HC_1 + (selHC - 1) * 4, 0, 0)) return false;
+
+	MONITOR_HC_VALUES(CALDUINO_DATA_DECODE)
+	return true;
+}
+
+
+/**
+ * Check if the EMS Datagram passed as parameter is a switching program.
+ *
+ * @param	selProgram	The EMS Datagram to check.
+ *
+ * @return	True if it is a switching program, false otherwise.
+ */
+
+static boolean isSwitchingProgram(EMSDatagramID selProgram)
+{
+	return ((selProgram == EMSDatagramID::Program_1_HC_1) || (selProgram == EMSDatagramID::Program_2_HC_1) ||
+		(selProgram == EMSDatagramID::Program_1_HC_2) || (selProgram == EMSDatagramID::Program_2_HC_2) ||
+		(selProgram == EMSDatagramID::Program_1_HC_3) || (selProgram == EMSDatagramID::Program_2_HC_3) ||
+		(selProgram == EMSDatagramID::Program_1_HC_4) || (selProgram == EMSDatagramID::Program_2_HC_4) ||
+		(selProgram == EMSDatagramID::Program_DHW) || (selProgram == EMSDatagramID::Program_Pump_DHW));
+}
+
+
+/**
+ * Encode a switch point in the two bytes it occupies in the EMS Message.
+ *
+ * @param 	   	operationSwitchPoint	The operation to be performed in the switch point (0 -
+ * 										off/night, 1 - on/day, 7 - undefined).
+ * @param 	   	daySwitchPoint			Day of the week (0 - monday, ..., 6 - sunday).
+ * @param 	   	hourSwitchPoint			Hour of the day (0 to 23).
+ * @param 	   	minuteSwitchPoint   	Minute (The minimum time between switching points is 10 min).
+ * @param [out]	switchPoint				The two bytes encoded.
+ *
+ * @return	True if the switch point is correct, false otherwise.
+ */
+
+static boolean encodeSwitchPoint(byte operationSwitchPoint, byte daySwitchPoint, byte hourSwitchPoint, byte minuteSwitchPoint, byte *switchPoint)
+{
+	// evaluate if the operationSwitchPoint is correct
+	// evaluate if the daySwitchPoint time is correct (not used by undefined switch points)
+	if (!((operationSwitchPoint == 7) ||
+		(((operationSwitchPoint == 0) || (operationSwitchPoint == 1)) &&
+		(daySwitchPoint < MAX_DAY_WEEK) &&
+		(hourSwitchPoint < MAX_HOUR_DAY) &&
+		((minuteSwitchPoint < MAX_MINUTE_HOUR) && (minuteSwitchPoint % 10 == 0)))))
+	{
+		return false;
+	}
+
+	switchPoint[0] = (operationSwitchPoint == 7) ? 0xE7 : (0x00 | (daySwitchPoint << 5) | (operationSwitchPoint));
+	switchPoint[1] = (operationSwitchPoint == 7) ? 0x90 : ((hourSwitchPoint * 6) + (minuteSwitchPoint / 10));
+
+	return true;
+}
+
+
+/**
+ * Get a Calduino Data of type Switch Point.
+ *
+ * @param	selProgram   	Identifier of the Calduino Data Bit requested.
+ * @param	switchPointID	Identifier for the switch point.
+ *
+ * @return	The value of the Calduino Data requested, false otherwise.
+ */
+
+SwitchPoint Calduino::getCalduinoSwitchPoint(EMSDatagramID selProgram, byte switchPointID)
+{
+	SwitchPoint result;
+	
+	if (isSwitchingProgram(selProgram) && (switchPointID < SWITCHING_POINTS))
+	{
+		// get from program memory the EMSDatagram
+		EMSDatagram eMSDatagram;
+		memcpy_P(&eMSDatagram, eMSDatagramIDs[selProgram], sizeof(EMSDatagram));
+
+		// get from program memory the CalduinoData 
+		CalduinoData calduinoData;
+		memcpy_P(&calduinoData, &eMSDatagram.data[switchPointID], sizeof(CalduinoData));
+
+		// buffer where the EMS Datagram will be saved (size is message size plus EMS_DATAGRAM_OVERHEAD bytes to store the headers, CRC and break)
+		byte inEMSBuffer[eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD];
+
+		// get an EMS Buffer with the parameters requested. Length is 2 (bytes) and offset is the position of the data type in the EMSBuffer
+		boolean operationStatus = getEMSBuffer(inEMSBuffer, eMSDatagram, 2, calduinoData.offset);
+
+		if (operationStatus)
+		{
+			result = calduinoData.decodeSwitchPoint(inEMSBuffer);
+		}
+	}
+
+	return result;
+}
+
+/**
+ * Get all the switch points of a switching program. The switch points are read with the
+ * minimum number of EMS Commands instead of one per switch point.
+ *
+ * @param 	   	selProgram  	The switching program requested.
+ * @param [out]	switchPoints	Array of SWITCHING_POINTS switch points where the program is saved.
+ *
+ * @return	True if it succeeds, false otherwise.
+ */
+
+boolean Calduino::readProgram(EMSDatagramID selProgram, SwitchPoint *switchPoints)
+{
+	if (!isSwitchingProgram(selProgram)) return false;
+
+	// get from program memory the EMSDatagram
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, eMSDatagramIDs[selProgram], sizeof(EMSDatagram));
+
+	// buffer where the EMS Datagram will be saved (size is message size plus EMS_DATAGRAM_OVERHEAD bytes to store the headers, CRC and break)
+	byte inEMSBuffer[eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD];
+
+	// get the bytes of all the switch points (two bytes each one, from the beginning of the EMS Message)
+	if (!getEMSBuffer(inEMSBuffer, eMSDatagram, SWITCHING_POINTS * 2, INITIAL_OFFSET)) return false;
+
+	for (byte i = 0; i < SWITCHING_POINTS; i++)
+	{
+		// get from program memory the CalduinoData 
+		CalduinoData calduinoData;
+		memcpy_P(&calduinoData, &eMSDatagram.data[i], sizeof(CalduinoData));
+
+		switchPoints[i] = calduinoData.decodeSwitchPoint(inEMSBuffer);
+	}
+
+	return true;
+}
+
+
+/**
+ * Report the EMS Datagram passed as parameter in delta mode: printEMSDatagram prints only the
+ * values that changed since they were last reported by at least the deadband of their unit,
+ * and the whole EMS Datagram every refreshCycles reports. Only EMS Datagrams whose message
+ * (plus headers) fits in EMS_CACHE_BUFFER_SIZE can be reported in delta mode.
+ *
+ * @param	eMSDatagramID	- The EMS Datagram ID to be reported in delta mode.
+ * @param	refreshCycles	- Number of reports between two full reports (1 reports always the
+ * 							whole EMS Datagram), 0 to report it always in full again.
+ *
+ * @return	True if it succeeds, false if there is no free slot or the EMS Datagram is too long
+ * 			(or without CALDUINO_REPORTS).
+ */
+
+boolean Calduino::setDeltaReport(EMSDatagramID eMSDatagramID, byte refreshCycles)
+{
+#ifndef CALDUINO_REPORTS
+	return (refreshCycles == 0);
+#else
+	// get from program memory the EMS Datagram passed as parameter
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, eMSDatagramIDs[eMSDatagramID], sizeof(EMSDatagram));
+
+	// search the slot already assigned to this EMS Datagram, or a free one
+	EMSReportSlot *slot = getReportSlot(eMSDatagramID);
+
+	for (byte i = 0; (i < EMS_REPORT_SLOTS) && (slot == NULL) && (refreshCycles > 0); i++)
+	{
+		if (reports[i].eMSDatagramID == ERROR_VALUE) slot = &reports[i];
+	}
+
+	if (refreshCycles == 0)
+	{
+		// free the slot (if any)
+		if (slot != NULL) slot->eMSDatagramID = ERROR_VALUE;
+		return true;
+	}
+
+	if ((slot == NULL) || (eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD > EMS_CACHE_BUFFER_SIZE))
+	{
+		return false;
+	}
+
+	if (slot->eMSDatagramID != eMSDatagramID)
+	{
+		slot->eMSDatagramID = eMSDatagramID;
+		slot->valid = false;
+	}
+
+	slot->refreshCycles = refreshCycles;
+
+	return true;
+#endif
+}
+
+
+/**
+ * Set the deadband of the Calduino Data of a unit reported in delta mode. A value is reported
+ * when it differs from the last reported by at least the deadband (any change if 0). Bits and
+ * Switch Points are reported on any change.
+ *
+ * @param	unit		- The unit of the Calduino Data.
+ * @param	deadband	- Deadband in tenths of the unit (e.g. 5 is 0.5 Celsius degrees).
+ */
+
+void Calduino::setDeadband(CalduinoUnit unit, uint16_t deadband)
+{
+#ifdef CALDUINO_REPORTS
+	if (unit < CALDUINO_UNITS) deadbands[unit] = deadband;
+#endif
+}
+
+
+/** Forget the values reported in delta mode, so the next report of each EMS Datagram is full. */
+
+void Calduino::resetDeltaReport()
+{
+#ifdef CALDUINO_REPORTS
+	for (byte i = 0; i < EMS_REPORT_SLOTS; i++)
+	{
+		reports[i].valid = false;
+	}
+#endif
+}
+
+
+/**
+ * Get the report slot assigned to the EMS Datagram passed as parameter.
+ *
+ * @param	eMSDatagramID	- The EMS Datagram ID.
+ *
+ * @return	The report slot, NULL if the EMS Datagram is not reported in delta mode.
+ */
+
+EMSReportSlot* Calduino::getReportSlot(byte eMSDatagramID)
+{
+#ifdef CALDUINO_REPORTS
+	for (byte i = 0; i < EMS_REPORT_SLOTS; i++)
+	{
+		if (reports[i].eMSDatagramID == eMSDatagramID) return &reports[i];
+	}
+#endif
+
+	return NULL;
+}
+
+
+#ifdef CALDUINO_REPORTS
+/**
+ * Check whether a Calduino Data has changed since it was last reported by at least the
+ * deadband of its unit.
+ *
+ * @param [in]	calduinoData  	- The Calduino Data to be checked.
+ * @param [in]	reportedBuffer	- The values last reported.
+ * @param [in]	inEMSBuffer   	- EMS bytes received.
+ *
+ * @return	True if the Calduino Data has to be reported, false otherwise.
+ */
+
+boolean Calduino::isDataChanged(CalduinoData *calduinoData, byte *reportedBuffer, byte *inEMSBuffer)
+{
+	// values are compared in tenths, as the deadbands
+	long reportedValue;
+	long value;
+
+	switch (calduinoData->encodeType)
+	{
+		case CalduinoEncodeType::Byte:
+		{
+			reportedValue = calduinoData->decodeByteValue(reportedBuffer) * 10L;
+			value = calduinoData->decodeByteValue(inEMSBuffer) * 10L;
+			break;
+		}
+		case CalduinoEncodeType::Float:
+		{
+			reportedValue = calduinoData->decodeFixedValue(reportedBuffer);
+			value = calduinoData->decodeFixedValue(inEMSBuffer);
+
+			// a sensor lost or recovered is always reported
+			if ((reportedValue == FIXED_ERROR_VALUE) || (value == FIXED_ERROR_VALUE)) return (reportedValue != value);
+			break;
+		}
+		case CalduinoEncodeType::ULong:
+		{
+			reportedValue = calduinoData->decodeULongValue(reportedBuffer) * 10L;
+			value = calduinoData->decodeULongValue(inEMSBuffer) * 10L;
+			break;
+		}
+		case CalduinoEncodeType::Bit:
+		{
+			return calduinoData->decodeBitValue(reportedBuffer) != calduinoData->decodeBitValue(inEMSBuffer);
+		}
+		default:
+		{
+			return memcmp(&reportedBuffer[calduinoData->offset], &inEMSBuffer[calduinoData->offset], calduinoData->getLength()) != 0;
+		}
+	}
+
+	unsigned long difference = labs(value - reportedValue);
+
+	return (difference != 0) && (difference >= deadbands[calduinoData->unit]);
+}
+#endif
+
+
+/**
+ * Select the values of a whole EMS Datagram to be printed. All of them, unless the EMS Datagram
+ * is reported in delta mode and a full report is not due: then only the values changed. The
+ * values selected are kept as the last reported.
+ *
+ * @param 	   	eMSDatagramID	- The EMS Datagram ID.
+ * @param [in] 	eMSDatagram  	- The EMS Datagram, copied from program memory.
+ * @param [in] 	inEMSBuffer  	- EMS bytes received.
+ * @param [out]	present		 	- Bitmap where the Calduino Data selected are set.
+ */
+
+void Calduino::selectReportedData(byte eMSDatagramID, EMSDatagram *eMSDatagram, byte *inEMSBuffer, byte *present)
+{
+	EMSReportSlot *slot = getReportSlot(eMSDatagramID);
+
+	boolean full = (slot == NULL) || !slot->valid || (++slot->cycles >= slot->refreshCycles);
+	if ((slot != NULL) && full)
+	{
+		slot->valid = true;
+		slot->cycles = 0;
+	}
+
+	CalduinoData calduinoData;
+	for (byte i = 0; i < eMSDatagram->dataSize; i++)
+	{
+		memcpy_P(&calduinoData, &eMSDatagram->data[i], sizeof(CalduinoData));
+
+#ifdef CALDUINO_REPORTS
+		if (!full && !isDataChanged(&calduinoData, slot->buffer, inEMSBuffer)) continue;
+#endif
+
+		bitSet(present[i / 8], i % 8);
+		if (slot == NULL) continue;
+
+		// keep the value reported (only its bit, the rest of the byte may not be reported)
+		if (calduinoData.encodeType == CalduinoEncodeType::Bit)
+		{
+			bitWrite(slot->buffer[calduinoData.offset], calduinoData.bitOffset, calduinoData.decodeBitValue(inEMSBuffer));
+		}
+		else
+		{
+			memcpy(&slot->buffer[calduinoData.offset], &inEMSBuffer[calduinoData.offset], calduinoData.getLength());
+		}
+	}
+}
+
+
+/**
+ * Get the EMS Datagram passed as parameter by sending a get EMS command and parsing the bytes
+ * obtained. If datagramDataIndex is ERROR_VALUE, get the whole datagram. Get only the Data
+ * Index otherwise. If debug is activated the results will be sent to the Debug Serial Stream
+ * following the print format activated.
+ *
+ * @param	eMSDatagramID	 	- The EMS Datagram ID to be obtained.
+ * @param	datagramDataIndex	- (Optional) If not ERROR_VALUE, the position that the data to be
+ * 								recovered occupies in the calduinoDataValues array.
+ *
+ * @return	True if it succeeds, false otherwise.
+ */
+
+boolean Calduino::printEMSDatagram(EMSDatagramID eMSDatagramID, DatagramDataIndex datagramDataIndex = ERROR_VALUE)
+{
+	// get from program memory the EMS Datagram passed as parameter
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, eMSDatagramIDs[eMSDatagramID], sizeof(EMSDatagram));
+
+	// if only one data is requested, obtain the calduinoData
+	CalduinoData calduinoData;
+	if (datagramDataIndex != ERROR_VALUE)
+	{
+		memcpy_P(&calduinoData, &eMSDatagram.data[datagramDataIndex], sizeof(CalduinoData));
+	}
+	
+	// buffer where the EMS Datagram will be saved (size is message size plus 5 bytes to store the headers, CRC and break)
+	byte inEMSBuffer[eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD];
+
+	// launch the get EMS Buffer operation. Depending on the datagramDataIndex value it will
+	// require the whole datagram (length = 0) or just 3 bytes (maximum size of a Data Type). 
+	boolean operationStatus = getCachedEMSBuffer(inEMSBuffer, eMSDatagramIDs[eMSDatagramID], eMSDatagram, (datagramDataIndex == ERROR_VALUE ? 0 : 3), (datagramDataIndex == ERROR_VALUE ? 0 : calduinoData.offset));
+
+	return printEMSBuffer(eMSDatagramID, (operationStatus ? inEMSBuffer : NULL), datagramDataIndex);
+}
+
+
+/**
+ * Print an EMS Datagram already received (e.g. by submit()) following the print format
+ * activated, like printEMSDatagram does without using the EMS Bus.
+ *
+ * @param	eMSDatagramID	 	- The EMS Datagram ID of the buffer.
+ * @param	inEMSBuffer		 	- The EMS Datagram received, NULL if it could not be received (the
+ * 								EMS Datagram Error Tag is printed).
+ * @param	datagramDataIndex	- (Optional) If not ERROR_VALUE, the position that the only data to
+ * 								be printed occupies in the calduinoDataValues array.
+ *
+ * @return	True if inEMSBuffer is not NULL, false otherwise.
+ */
+
+boolean Calduino::printEMSBuffer(EMSDatagramID eMSDatagramID, byte *inEMSBuffer, DatagramDataIndex datagramDataIndex)
+{
+	// get from program memory the EMS Datagram passed as parameter
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, eMSDatagramIDs[eMSDatagramID], sizeof(EMSDatagram));
+
+	boolean operationStatus = (inEMSBuffer != NULL);
+	CalduinoData calduinoData;
+
+	// print the EMS Datagram Header Tag (the binary record is printed at once at the end)
+	boolean binary = serializer.isBinary();
+	if (!binary) serializer.beginObject(FPSTR(eMSDatagram.messageName));
+
+	// select the values to be printed: only the requested, or all the values of the datagram
+	// (only the changed ones if it is reported in delta mode)
+	byte present[TELEMETRY_BITMAP_SIZE(eMSDatagram.dataSize)];
+	memset(present, 0, sizeof(present));
+
+	if (datagramDataIndex != ERROR_VALUE)
+	{
+		bitSet(present[datagramDataIndex / 8], datagramDataIndex % 8);
+	}
+	else if (operationStatus)
+	{
+		selectReportedData(eMSDatagramID, &eMSDatagram, inEMSBuffer, present);
+	}
+
+	if (binary)
+	{
+		// print the telemetry record with the values selected
+		serializer.printRecord(eMSDatagramID, &eMSDatagram, inEMSBuffer, present);
+	}
+	else if (operationStatus)
+	{
+		// decode and print each value selected
+		for (byte i = 0; i < eMSDatagram.dataSize; i++)
+		{
+			if (!bitRead(present[i / 8], i % 8)) continue;
+
+			memcpy_P(&calduinoData, &eMSDatagram.data[i], sizeof(CalduinoData));
+			serializer.printData(&calduinoData, inEMSBuffer);
+		}
+	}
+	else
+	{
+		// print the EMS Datagram Error Tag
+		serializer.printValue(FPSTR(returnTag), 0L);
+	}
+
+	// print the EMS Datagram Tail Tag
+	if (!binary) serializer.endObject();
+
+	return operationStatus;
+}
+
+
+/**
+ * Send a Set Command updating the value of the data situaded in CalduinoDataValuesIndex of
+ * eMSDatagramID. If debug is activated the result of the operation will be sent to the Debug
+ * Serial Stream following the selected print format.
+ *
+ * @param	eMSDatagramID	 	- The EMSDatagram to be updated.
+ * @param	calduinoDataIndex	- The position that the value to be updated occupies in the
+ * 									calduinoDataValues array.
+ * @param	data			 	- The data/value to be assigned.
+ * @param	extraOffset		 	(Optional) - An extra offset to apply to the EMS Command offset,
+ * 								in case this data type uses two or more bytes (Switch Point).
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::updateEMSDatagram(EMSDatagramID eMSDatagramID, DatagramDataIndex datagramDataIndex, byte data, byte extraOffset = 0)
+{
+	return updateEMSDatagramBlock(eMSDatagramID, datagramDataIndex, &data, 1, extraOffset);
+}
+
+
+/**
+ * Send a Set Command updating in one EMS Command up to MAX_EMS_WRITE contiguous bytes of
+ * eMSDatagramID, starting in the data situated in CalduinoDataValuesIndex. The bytes are
+ * verified with one read back of the whole block. If debug is activated the result of the
+ * operation will be sent to the Debug Serial Stream following the selected print format.
+ *
+ * @param	eMSDatagramID	 	- The EMSDatagram to be updated.
+ * @param	calduinoDataIndex	- The position that the first value to be updated occupies in
+ * 								the calduinoDataValues array.
+ * @param	data			 	- The data/values to be assigned.
+ * @param	length			 	- Number of bytes to be assigned. The following bytes belong to
+ * 								the following Calduino Data, or to the same Calduino Data if it
+ * 								uses two or more bytes (Switch Point).
+ * @param	extraOffset		 	(Optional) - An extra offset to apply to the EMS Command offset.
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::updateEMSDatagramBlock(EMSDatagramID eMSDatagramID, DatagramDataIndex datagramDataIndex, const byte *data, byte length, byte extraOffset = 0)
+{
+	boolean operationStatus = false;
+
+	// get from program memory the EMS Datagram passed as parameter
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, eMSDatagramIDs[eMSDatagramID], sizeof(EMSDatagram));
+
+	// print the EMS Datagram Header Tag (the binary record is printed at once at the end)
+	boolean binary = serializer.isBinary();
+	if (!binary) serializer.beginObject(FPSTR(eMSDatagram.messageName));
+
+	// get from program memory the Calduino Data  of the configuration to be changed 
+	CalduinoData calduinoData;
+	memcpy_P(&calduinoData, &eMSDatagram.data[datagramDataIndex], sizeof(CalduinoData));
+
+	// set the configuration and read it back, repeat operation if failed until timeout
+	byte handle = submitTransaction(true, eMSDatagram.destinationID, eMSDatagram.messageID, calduinoData.offset - INITIAL_OFFSET + extraOffset, length, data, NULL, EMSMaxWaitTime * RETRY_FACTOR, TransactionPriority::UserWrite);
+	operationStatus = waitTransaction(handle);
+
+	// the snapshot of this EMS Datagram (if cached) is no longer valid
+	EMSCacheSlot *slot = getCacheSlot(eMSDatagramIDs[eMSDatagramID]);
+	if (slot != NULL) slot->valid = false;
+
+	if (binary)
+	{
+		// the record contains the Calduino Data whose bytes have all been written
+		byte start = calduinoData.offset + extraOffset;
+		byte present[TELEMETRY_BITMAP_SIZE(eMSDatagram.dataSize)];
+		byte outEMSBuffer[eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD];
+		memset(present, 0, sizeof(present));
+		memcpy(&outEMSBuffer[start], data, length);
+
+		for (byte i = 0; i < eMSDatagram.dataSize; i++)
+		{
+			CalduinoData writtenData;
+			memcpy_P(&writtenData, &eMSDatagram.data[i], sizeof(CalduinoData));
+
+			if ((writtenData.offset >= start) && (writtenData.offset + writtenData.getLength() <= start + length))
+			{
+				bitSet(present[i / 8], i % 8);
+			}
+		}
+
+		serializer.printRecord(eMSDatagramID, &eMSDatagram, (operationStatus ? outEMSBuffer : NULL), present);
+	}
+	// if success and debug activated, print the set values
+	else if (operationStatus)
+	{
+		for (byte i = 0; i < length; i++)
+		{
+			// every byte is a different Calduino Data, unless it uses two or more bytes (Switch Point)
+			if ((i > 0) && (calduinoData.encodeType != CalduinoEncodeType::SwithPoint))
+			{
+				memcpy_P(&calduinoData, &eMSDatagram.data[datagramDataIndex + i], sizeof(CalduinoData));
+			}
+
+			// consider floats as signed values
+			serializer.printValue(FPSTR(calduinoData.dataName), (calduinoData.encodeType == CalduinoEncodeType::Byte ? (uint8_t)data[i] : (int8_t)data[i]), FPSTR(calduinoUnits[calduinoData.unit]));
+		}
+	}
+	else
+	{
+		// print the EMS Datagram Error Tag
+		serializer.printValue(FPSTR(returnTag), 0L);
+	}
+
+	// print the EMS Datagram Tail Tag
+	if (!binary) serializer.endObject();
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to set the selected RC35 heating circuit to the desired Mode
+ *
+ * @param	selHC  	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
+ * @param	selMode	The selected working mode to be configured (0-night, 1-day, 2-auto/program).
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setWorkModeHC(byte selHC, byte selMode)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected heating circuit exists
+	// evaluate if the selected mode exists
+	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (selMode <= MAX_WORKING_MODE))
+	{
+		// Working Mode is in position 5 of eMSDatagram.Values array in Working_Mode_HC_selHC
+		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_HC_1 + (selHC - 1) * 4, 5, selMode);
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to set in the selected RC35 heating circuit and Mode, the desired
+ * temperature.
+ *
+ * @param	selHC  	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
+ * @param	selMode	The working mode to be configured (0-night, 1-day, 2-holidays).
+ * @param	selTmp 	The desired temperature (multiplied by two, originally in increments of 0,5).
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setTemperatureHC(byte selHC, byte selMode, byte selTmp)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected heating circuit exists
+	// evaluate if the selected mode exists
+	// evaluate if the selected temperature is inside limits
+	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (selMode <= MAX_WORKING_MODE) && (selTmp <= MAX_TEMPERATURE * 2) && (selTmp >= MIN_TEMPERATURE * 2))
+	{
+		// Data Type SelNight/Day/Holi Temp is in position 0 to 2 (selMode) of EMS Datagram Values array in EMS Datagram Working_Mode_HC_selHC
+		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_HC_1 + (selHC - 1) * 4, selMode, selTmp);
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to set the selected RC35 heating circuit to the desired program.
+ * @selHC the heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
+ * @selProgram the working program to set (0x00 = User 1, 0x01 = Family, 0x02 = Morning, 0x03 =
+ * Early morning, 0x04 = Evening, 0x05 = Midmorning, 0x06 = Afternoon, 0x07 = Midday, 0x08 =
+ * Single, 0x09 = Senioren, 0x0A User2).
+ *
+ * @param	selHC	  	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
+ * @param	selProgram	The the working program to set (0x00 = User 1, 0x01 = Family, 0x02 =
+ * 						Morning, 0x03 = Early morning, 0x04 = Evening, 0x05 = Midmorning, 0x06 =
+ * 						Afternoon, 0x07 = Midday, 0x08 = Single, 0x09 = Senioren, 0x0A User2).
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setProgramHC(byte selHC, byte selProgram)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected heating circuit exists
+	// evaluate if the selected program exists
+	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (selProgram <= MAX_PROGRAM))
+	{
+		// Data Type programName is in position 42 of eMSDatagram.Values array in EMS Datagram Program_1_HC_selHC
+		operationStatus = updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::programNameIdx, selProgram);
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to configure the temperature for summer / winter threshold switchpoint in
+ * the selected heating circuit.
+ *
+ * @param	selHC 	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
+ * @param	selTmp	The desired Summer / Winter Threshold temperature.
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setSWThresholdTempHC(byte selHC, byte selTmp)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected heating circuit exists
+	// evaluate if the selected program exists
+	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (selTmp <= MAX_SUMMER_WINTER_THRESHOLD) && (selTmp >= MIN_SUMMER_WINTER_THRESHOLD))
+	{
+		// Data Type sWThresTempHC is in position 6 of eMSDatagram.Values array in EMS Datagram Working_Mode_HC_selHC
+		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_HC_1 + (selHC - 1) * 4, DatagramDataIndex::sWThresTempHCIdx, selTmp);
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to configure the night setback mode in the selected heating circuit.
+ *
+ * @param	selHC  	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
+ * @param	selMode	The desired setback mode (0 - Shutdown, 1 - Reduced Operation, 2 - Room
+ * 					Setback, 3 - Outdoor Setback).
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setNightSetbackModeHC(byte selHC, byte selMode)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected heating circuit exists
+	// evaluate if the selected program exists
+	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (selMode <= MAX_SETBACK_MODE))
+	{
+		// Data Type nightSetbackMode is in position 7 of eMSDatagram.Values array in EMS Datagram Working_Mode_HC_selHC
+		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_HC_1 + (selHC - 1) * 4, DatagramDataIndex::nightSetbackHCIdx, selMode);
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to configure the night setback outside temperature threshold in the
+ * selected heating circuit. This temperature is only considered if night setback mode is set to
+ * 3 (Outdoor Setback).
+ *
+ * @param	selHC 	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
+ * @param	selTmp	The desired outside temperature to switch between shutdown and reduced mode.
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setNightThresholdOutTempHC(byte selHC, int8_t selTmp)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected heating circuit exists
+	// evaluate if the temperature is inside limits
+	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (selTmp <= MAX_OUT_NIGHT_THRESHOLD) && (selTmp >= MIN_OUT_NIGHT_THRESHOLD))
+	{
+		// Data Type sWThresTempHC is in position 8 of eMSDatagram.Values array in EMS Datagram Working_Mode_HC_selHC
+		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_HC_1 + (selHC - 1) * 4, DatagramDataIndex::nightOutTempHCIdx, selTmp);
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to configure the room temperature offset in the selected heating circuit.
+ * This value shifts left and right the heating characteristic curve.
+ *
+ * @param	selHC 	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
+ * @param	selTmp	The desired offset temperature.
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setRoomTempOffsetHC(byte selHC, int8_t selTmp)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected heating circuit exists
+	// evaluate if the temperature is inside limits
+	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (selTmp <= MAX_ROOM_TEMPERATURE_OFFSET * 2) && (selTmp >= MIN_ROOM_TEMPERATURE_OFFSET * 2))
+	{
+		// Data Type roomTempOffHC is in position 4 of eMSDatagram.Values array in EMS Datagram Working_Mode_HC_selHC
+		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_HC_1 + (selHC - 1) * 4, DatagramDataIndex::roomTempOffHCIdx, selTmp);
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to configure pause mode in duration hours in the selected heating circuit.
+ *
+ * @param	selHC   	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
+ * @param	duration	The desired duration of the pause mode.
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setPauseModeHC(byte selHC, byte duration)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected heating circuit exists
+	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT))
+	{
+		// Data Type pauseTime is in position 43 of eMSDatagram.Values array in EMS Datagram Program_1_HC_selHC
+		operationStatus = updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::pauseTimeIdx, duration);
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to configure party mode in duration hours in the selected heating circuit.
+ * @selHC the heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
+ * @duration the desired duration of the party mode.
+ *
+ * @param	selHC   	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4 is HC4).
+ * @param	duration	The desired duration of the party mode.
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setPartyModeHC(byte selHC, byte duration)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected heating circuit exists
+	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT))
+	{
+		// Data Type party is in position 44 of eMSDatagram.Values array in EMS Datagram Program_1_HC_selHC
+		operationStatus = updateEMSDatagram(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::partyTimeIdx, duration);
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to configure Holidays mode between start and end daySwitchPoint.
+ *
+ * @param	selHC			  	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3 and 4
+ * 								is HC4).
+ * @param	startHolidayDay   	The start holiday day.
+ * @param	startHoldidayMonth	The start holdiday month.
+ * @param	startHolidayYear  	The start holiday year.
+ * @param	endHolidayDay	  	The end holiday dat.
+ * @param	endHoldidayMonth  	The end holdiday month.
+ * @param	endHolidayYear	  	The end holiday year.
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setHolidayModeHC(byte selHC, byte startHolidayDay, byte startHoldidayMonth, byte startHolidayYear, byte endHolidayDay, byte endHoldidayMonth, byte endHolidayYear)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected heating circuit exists
+	// evaluate if the selected daySwitchPoint and month exists
+	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (startHolidayDay <= MAX_DAY) && (endHolidayDay <= MAX_DAY) && (startHoldidayMonth <= MAX_MONTH) && (endHoldidayMonth <= MAX_MONTH))
+	{
+		// Data Type startHolidayDay is in position 45 to endHolidayYear in position 50 of eMSDatagram.Values array in EMS Datagram Program_1_HC_selHC
+		byte holidayPeriod[] = { startHolidayDay, startHoldidayMonth, startHolidayYear, endHolidayDay, endHoldidayMonth, endHolidayYear };
+		operationStatus = updateEMSDatagramBlock(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::startHolidayDayIdx, holidayPeriod, sizeof(holidayPeriod));
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to configure Home Holiday mode (saturday configuration) between start and
+ * end daySwitchPoint.
+ *
+ * @param	selHC				  	The heating circuit to modify (1 is HC1, 2 is HC2, 3 is HC3
+ * 									and 4 is HC4).
+ * @param	startHomeHolidayDay   	The start home holiday day.
+ * @param	startHomeHoldidayMonth	The start home holdiday month.
+ * @param	startHomeHolidayYear  	The start home holiday year.
+ * @param	endHomeHolidayDay	  	The end home holiday.
+ * @param	endHomeHoldidayMonth  	The end home holdiday month.
+ * @param	endHomeHolidayYear	  	The end home holiday year.
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setHomeHolidayModeHC(byte selHC, byte startHomeHolidayDay, byte startHomeHoldidayMonth, byte startHomeHolidayYear, byte endHomeHolidayDay, byte endHomeHoldidayMonth, byte endHomeHolidayYear)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected heating circuit exists
+	// evaluate if the selected daySwitchPoint and month exists
+	if ((selHC > 0) && (selHC <= MAX_HC_CIRCUIT) && (startHomeHolidayDay <= MAX_DAY) && (endHomeHolidayDay <= MAX_DAY) && (startHomeHoldidayMonth <= MAX_MONTH) && (endHomeHoldidayMonth <= MAX_MONTH))
+	{
+		// Data Type startHomeHolidayDay is in position 51 to endHomeHolidayYear in position 56 of eMSDatagram.Values array in EMS Datagram Program_1_HC_selHC
+		byte homeHolidayPeriod[] = { startHomeHolidayDay, startHomeHoldidayMonth, startHomeHolidayYear, endHomeHolidayDay, endHomeHoldidayMonth, endHomeHolidayYear };
+		operationStatus = updateEMSDatagramBlock(EMSDatagramID::Program_1_HC_1 + (selHC - 1) * 4, DatagramDataIndex::startHomeHolidayDayIdx, homeHolidayPeriod, sizeof(homeHolidayPeriod));
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to set the DHW working mode.
+ * @selMode the working mode to be configured (0-off, 1-on, 2-auto)
+ *
+ * @param	selMode	The working mode to be configured (0-off, 1-on, 2-auto).
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setWorkModeDHW(byte selMode)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected mode exists
+	if (selMode <= MAX_WORKING_MODE)
+	{
+		// Working Mode is in position 2 of eMSDatagram.Values array in Working_Mode_DHW
+		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_DHW, 2, selMode);
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to set the DHW Pump working mode.
+ *
+ * @param	selMode	The working mode to be configured (0-off, 1-on, 2-auto)
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setWorkModePumpDHW(byte selMode)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected mode exists
+	if (selMode <= MAX_WORKING_MODE)
+	{
+		// Working Mode is in position 3 of eMSDatagram.Values array in Working_Mode_DHW
+		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_DHW, DatagramDataIndex::workModePumpDHWIdx, selMode);
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to set the desired temperature in the Domestic How Water System.
+ *
+ * @param	selTmp	The desired temperature to be configured.
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setTemperatureDHW(byte selTmp)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected temperature is inside limits
+	if ((selTmp <= MAX_DHW_TEMPERATURE) && (selTmp >= MIN_DHW_TEMPERATURE))
+	{
+		// Data Type selTempDHW is in position 0 of EMS Datagram Values array in EMS Datagram UBA_Parameter_DHW
+		operationStatus = updateEMSDatagram(EMSDatagramID::UBA_Parameter_DHW, DatagramDataIndex::selTempDHWIdx, selTmp);
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to set the desired disinfection temperature in the Domestic How Water
+ * System.
+ *
+ * @param	selTmp	The desired temperature to be configured.
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setTemperatureTDDHW(byte selTmp)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected temperature is inside limits
+	if ((selTmp <= MAX_DHW_TEMPERATURE) && (selTmp >= MIN_DHW_TEMPERATURE))
+	{
+		// Data Type disinfTempDHW is in position 1 of EMS Datagram Values array in EMS Datagram UBA_Parameter_DHW
+		operationStatus = updateEMSDatagram(EMSDatagramID::UBA_Parameter_DHW, DatagramDataIndex::tempTDDHWIdx, selTmp);
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to change the DHW program.
+ *
+ * @param	selProgram	The working program to be set (0 = like the heating circuit, 255 = own
+ * 						program).
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setProgramDHW(byte selProgram)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected mode exists (0 or 255)
+	if ((selProgram == 0) || (selProgram == ERROR_VALUE))
+	{
+		// progDHW is in position 0 of eMSDatagram.Values array in Working_Mode_DHW
+		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_DHW, DatagramDataIndex::progDHWIdx, selProgram);
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to change the Pump DHW program.
+ *
+ * @param	selProgram	The working program to be set (0 = like the heating circuit, 255 = own
+ * 						program).
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setProgramPumpDHW(byte selProgram)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected mode exists (0 or 255)
+	if ((selProgram == 0) || (selProgram == ERROR_VALUE))
+	{
+		// progPumpDHW is in position 1 of eMSDatagram.Values array in Working_Mode_DHW
+		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_DHW, DatagramDataIndex::progPumpDHWIdx, selProgram);
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to change the thermal disinfection DHW working mode.
+ *
+ * @param	selMode	255 to enable thermal disinfection DHW function, 0 to disable it.
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setWorkModeTDDHW(byte selMode)
+{
+	boolean operationStatus = false;
+	
+	// evaluate if the selected mode exists (0 or 255)
+	if ((selMode == 0) || (selMode == ERROR_VALUE))
+	{
+		// workModeTDDHW is in position 4 of eMSDatagram.Values array in Working_Mode_DHW
+		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_DHW, DatagramDataIndex::workModeTDDHWIdx, selMode);
+	}
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to change the thermal disinfection DHW running day. It will run once per week
+ * at the selected daySwitchPoint and hour, or once per day if dayTDDHW is 7.
+ *
+ * @param	dayTDDHW 	Day of the week to run the thermal disinfection (7 is everyday).
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setDayTDDHW(byte dayTDDHW)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected dayTDDHW is correct
+	if (dayTDDHW <= MAX_DAY_WEEK)
+	{
+		// dayTDDHW is in position 5 of eMSDatagram.Values array in Working_Mode_DHW
+		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_DHW, DatagramDataIndex::dayTDDHWIdx, dayTDDHW);
+	}
+
+	return operationStatus;
+}
+
+/**
+* Send an EMS command to change the thermal disinfection DHW program. It will run once per week
+* at the selected daySwitchPoint and hour, or once per day if dayTDDHW is 7.
+*
+* @param	hourTDDHW	Hour of the week to run the thermal disinfection.
+*
+* @return	True if it succeeds, false if it fails.
+*/
+
+boolean Calduino::setHourTDDHW(byte hourTDDHW)
+{
+	boolean operationStatus = false;
+
+	// evaluate if the selected hourTDDHW is2 correct
+	if (hourTDDHW < MAX_HOUR_DAY)
+	{
+		// desHourDHW is in position 6 of eMSDatagram.Values array in Working_Mode_DHW
+		operationStatus = updateEMSDatagram(EMSDatagramID::Working_Mode_DHW, DatagramDataIndex::hourTDDHWIdx, hourTDDHW);
+	}
+
+	return operationStatus;
+}
+
+
+/**
+ * Send an EMS command to change an specific switch point in the program passed as parameter.
+ *
+ * @param	selProgram				The selected program to be updated.
+ * @param	switchPointID			Identifier for the switch point.
+ * @param	operationSwitchPoint	The operation to be performed in the switch point (0 -
+ * 									off/night, 1 - on/day, 7 - undefined).
+ * @param	daySwitchPoint			Day of the week (0 - monday, ..., 6 - sunday).
+ * @param	hourSwitchPoint			Hour of the day (0 to 23).
+ * @param	minuteSwitchPoint   	Minute (The minimum time between switching points is 10 min).
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setProgramSwitchPoint(EMSDatagramID selProgram, byte switchPointID, byte operationSwitchPoint, byte daySwitchPoint, byte hourSwitchPoint, byte minuteSwitchPoint)
+{
+	boolean operationStatus = false;
+	byte switchPoint[2];
+
+	// evaluate if the selected selProgram is correct
+	// evaluate if the switch point is inside limits
+	// evaluate if the switch point is correct and encode it
+	if (isSwitchingProgram(selProgram) && (switchPointID < SWITCHING_POINTS) &&
+		encodeSwitchPoint(operationSwitchPoint, daySwitchPoint, hourSwitchPoint, minuteSwitchPoint, switchPoint))
+	{
+		operationStatus = updateEMSDatagramBlock(selProgram, switchPointID, switchPoint, 2);
+	}
+
+	return operationStatus;
+}
+
+/**
+ * Send the EMS commands to change a whole switching program. The current program is read and
+ * only the bytes that differ are written, in blocks of up to MAX_EMS_WRITE bytes.
+ *
+ * @param	selProgram  	The selected program to be updated.
+ * @param	switchPoints	Array of SWITCHING_POINTS switch points with the new program. The id of
+ * 							each switch point is its position in the array.
+ *
+ * @return	True if it succeeds, false if it fails or any switch point is not correct.
+ */
+
+boolean Calduino::writeProgram(EMSDatagramID selProgram, const SwitchPoint *switchPoints)
+{
+	if (!isSwitchingProgram(selProgram)) return false;
+
+	// encode the new program
+	byte newProgram[SWITCHING_POINTS * 2];
+
+	for (byte i = 0; i < SWITCHING_POINTS; i++)
+	{
+		if (!encodeSwitchPoint(switchPoints[i].action, switchPoints[i].day, switchPoints[i].hour, switchPoints[i].minute, &newProgram[i * 2])) return false;
+	}
+
+	// get from program memory the EMSDatagram
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, eMSDatagramIDs[selProgram], sizeof(EMSDatagram));
+
+	// read the current program (switch points start in the first position of the EMS Message)
+	byte inEMSBuffer[eMSDatagram.messageLength + EMS_DATAGRAM_OVERHEAD];
+	if (!getEMSBuffer(inEMSBuffer, eMSDatagram, SWITCHING_POINTS * 2, INITIAL_OFFSET)) return false;
+
+	byte *currentProgram = &inEMSBuffer[INITIAL_OFFSET];
+	boolean operationStatus = true;
+	byte i = 0;
+
+	while (i < SWITCHING_POINTS * 2)
+	{
+		if (currentProgram[i] == newProgram[i])
+		{
+			i++;
+			continue;
+		}
+
+		// extend the block up to the last changed byte that fits in one EMS Command
+		byte blockStart = i;
+		byte blockEnd = i + 1;
+
+		for (byte j = blockEnd; (j < SWITCHING_POINTS * 2) && (j - blockStart < MAX_EMS_WRITE); j++)
+		{
+			if (currentProgram[j] != newProgram[j]) blockEnd = j + 1;
+		}
+
+		operationStatus &= updateEMSDatagramBlock(selProgram, 0, &newProgram[blockStart], blockEnd - blockStart, blockStart);
+		i = blockEnd;
+	}
+
+	return operationStatus;
+}
+
+
+
+/**
+ * Send an EMS command to set the warm watter one time function on or off.
+ *
+ * @param	selMode	True to enable one time function, false to disable it.
+ *
+ * @return	True if it succeeds, false if it fails.
+ */
+
+boolean Calduino::setOneTimeDHW(boolean selMode)
+{
+	boolean operationStatus;
+
+	operationStatus = updateEMSDatagram(EMSDatagramID::Flags_DHW, DatagramDataIndex::oneTimeDHW2Idx, selMode ? DHW_ONETIME_ON: DHW_ONETIME_OFF);
+	operationStatus |= getCalduinoBitValue(BitRequest::oneTimeDHW_t);
+	return operationStatus;
+}
+
+#pragma endregion Calduino
+
+
@@ -1,688 +1,1554 @@
-/*
-* Copyright (c) 2018 Daniel Macas Perea (dani.macias.perea@gmail.com)
-*   
-* Permission is hereby granted, free of charge, to any person obtaining a copy
-* of this software and associated documentation files (the "Software"), to deal
-* in the Software without restriction, including without limitation the rights
-* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-* copies of the Software, and to permit persons to whom the Software is
-* furnished to do so, subject to the following conditions:
-*
-* The above copyright notice and this permission notice shall be included in all
-* copies or substantial portions of the Software.
-*
-* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-* SOFTWARE.
-* 
-* Legal Notices
-* 'Bosch Group', 'Buderus', 'Nefit' and 'Worcester' are brands of Bosch Thermotechnology.
-* All other trademarks are the property of their respective owners.
-*/
-
-/* Release history
-*
-* Version  Date         Description
-* 0.1      25-Apr-2018  First release.
-* 0.2	   22-May-2018  Operation to set Thermal Disinfection splitted in two. 
-*						Retry factor adapted to minimize errors.
-* 0.3      05-Jun-2018  Corrected UBAMonitorDHW Datagram
-*/
-
-/**
-* @mainpage EMS Bus - Arduino library.
-*
-* This library provides functions to communicate through the EMS Bus with Buderus/Nefit/Worcester
-* (or any other EMS Bus compatible) boilers. It includes commands for both getting status information
-* (UBA Monitor, DHW Monitor, etc.) and setting new configurations (Set Day/Night Temperature,
-* Set Working Mode, etc.).
-*
-* @author	dani.macias.perea@gmail.com
-*/
-
-/**
-* @file Calduino.h
-*
-* @brief The Calduino class definition including EMSSerial, CalduinoDebug, CalduinoSerial, Calduino Datagrams and Calduino Datas.
-*/
-
-
-#ifndef Calduino_h
-#define Calduino_h
-
-#define SERIAL_BUFFER_SIZE 48
-#define MAX_EMS_READ 32
-
-#if MAX_EMS_READ > SERIAL_BUFFER_SIZE
-# MAX_EMS_READ = SERIAL_BUFFER_SIZE
-#endif
-
-
-#define ERROR_VALUE 0xFF
-#define HEATING_CIRCUITS 2
-
-#define PSTR(s) (__extension__({static prog_char __c[] PROGMEM = (s); &__c[0];})) 
-#define FPSTR(pstr_pointer) (reinterpret_cast<const __FlashStringHelper *>(pstr_pointer))
-
-typedef const PROGMEM char prog_char;
-
-/* EMSSerial declaration */
-#pragma region EMSSERIAL
-
-/**
- * Hardware Serial class adapted to EMS Buffer characteristics. There is only a reception
- * buffer. WriteEOF will disable reception and change UART parity to send without errors an 11
- * bits 0 chain. Flush operation will disable and enable reception to erase the buffer.
- */
-
-class EMSSerial : public Stream {
-protected:
-	volatile uint8_t *_ubrrh;
-	volatile uint8_t *_ubrrl;
-	volatile uint8_t *_ucsra;
-	volatile uint8_t *_ucsrb;
-	volatile uint8_t *_ucsrc;
-	volatile uint8_t *_udr;
-	uint8_t _rxen;
-	uint8_t _txen;
-	uint8_t _rxcie;
-	uint8_t _error;
-	bool _written;
-
-public:
-	volatile uint8_t _rx_buffer_head;
-	volatile uint8_t _rx_buffer_tail;
-
-	unsigned char _rx_buffer[SERIAL_BUFFER_SIZE];
-	bool _error_flag[SERIAL_BUFFER_SIZE];
-
-	EMSSerial(
-		volatile uint8_t *ubrrh, volatile uint8_t *ubrrl,
-		volatile uint8_t *ucsra, volatile uint8_t *ucsrb,
-		volatile uint8_t *ucsrc, volatile uint8_t *udr,
-		uint8_t rxen, uint8_t txen, uint8_t rxcie);
-	EMSSerial();
-	bool begin(unsigned long baud);
-	void end();
-	void writeEOF();
-	virtual int available(void);
-	bool frameError() { bool ret = _error; 	_error = false;  return ret; }
-	virtual int peek(void);
-	virtual int read(void);
-	virtual void flush(void);
-	virtual size_t write(uint8_t);
-	inline size_t write(unsigned long n) { return write((uint8_t)n); }
-	inline size_t write(long n) { return write((uint8_t)n); }
-	inline size_t write(unsigned int n) { return write((uint8_t)n); }
-	inline size_t write(int n) { return write((uint8_t)n); }
-	//using Print::write; // pull in write(str) and write(buf, size) from Print
-	operator bool();
-};
-
-#if defined(UBRRH) || defined(UBRR0H)
-extern EMSSerial EMSSerial0;
-#endif
-#if defined(UBRR1H)
-extern EMSSerial EMSSerial1;
-#endif
-#if defined(UBRR2H)
-extern EMSSerial EMSSerial2;
-#endif
-#if defined(UBRR3H) 
-extern EMSSerial EMSSerial3;
-#endif
-
-#pragma endregion EMSSerial
-
-/* CalduinoData declaration */
-#pragma region CalduinoData
-
-/**
- * Enumeration of Calduino Units. It should match the calduinoUnits array, which contains a
- * flash string for each unit.
- */
-
- enum CalduinoUnit {
-	None,
-	Celsius,
-	YesNo,
-	MAmper,
-	Bar,
-	Minute,
-	Times,
-	Percentage,
-	Seconds
-};
-
-
-/**
- * Enumeration that represent calduino encode types. Each enconde type will parse the bytes contained
- * in the EMS Datagram in a different way.
- */
-
- enum CalduinoEncodeType {
-	Byte,
-	Bit,
-	Float,
-	ULong,
-	SwithPoint
-};
-
-
-/**
- * Print Format enumeration.
- * - Standard prints values and units.  
- * - XML surrounds values with name tags.  
- * - NoUnit prints only values.
- */
-
- enum PrintFormat {
-	Standard,
-	NoUnit,
-	XML
-};
-
-
-/**
- * Switch point struct definition.
- * - Id is the identification of the Switch Point.
- * - Action is the operation performed (0 - off/night, 1 - on/day, 7 - undefined).
- * - Point in time (day from 0 - monday to 6 - sunday,
- * hours from 0 to 23 and minute from 0 to 50, in 10 minutes increments).
- */
-
-typedef struct SwitchPoint {
-	byte id;
-	byte action;
-	byte day;
-	byte hour;
-	byte minute;
-};
-
-
-/**
- * Calduino data struct definition.
- * - Name is the ID of the data.  
- * - Encode Type to use by parsing from the EMS Buffer.  
- * - Unit of the data.  
- * - Offset is the position that the data occupies in the EMS Buffer.  
- * - Bit Offset is only used for bit types.  
- * - Float bytes is only used for float types. It is the number of bytes represented by the
- * value in the EMS Buffer.  
- * - Float factor is only used for float types. Floats are coded multiplied by a factor (2 or
- * 10) to avoid decimals in the EMS Buffer. To decode a float it should by diveded by this
- * factor.
- */
-
-struct CalduinoData {
-	prog_char* dataName;
-	CalduinoEncodeType encodeType;
-	CalduinoUnit unit;
-	byte offset;
-	byte bitOffset;
-	byte floatBytes;
-	byte floatFactor;
-
-	byte decodeByteValue(byte* inEMSBuffer);
-	bool decodeBitValue(byte* inEMSBuffer);
-	unsigned long decodeULongValue(byte* inEMSBuffer);
-	SwitchPoint decodeSwitchPoint(byte *inEMSBuffer);
-	float decodeFloatValue(byte* inEMSBuffer);
-	void decodeValue(byte* inEMSBuffer, char* value);
-	void printfValue(char* str, char* value, PrintFormat printFormat);
-};
-
-#pragma endregion CalduinoData
-
-/* EMSDatagram declaration */
-#pragma region EMSDatagram
-
-/* Enumeration of EMS Datagram. It matches the eMSDatagramIDs array. */
-typedef enum EMSDatagramID {
-	RC_Datetime,
-	UBA_Working_Time,
-	UBA_Monitor_Fast,
-	UBA_Monitor_Slow,
-	UBA_Parameter_DHW,
-	UBA_Monitor_DHW,
-	Flags_DHW,
-	Working_Mode_DHW,
-	Program_DHW,
-	Program_Pump_DHW,
-	Working_Mode_HC_1,
-	Monitor_HC_1,
-	Program_1_HC_1,
-	Program_2_HC_1,
-	Working_Mode_HC_2,
-	Monitor_HC_2,
-	Program_1_HC_2,
-	Program_2_HC_2,
-	Working_Mode_HC_3,
-	Monitor_HC_3,
-	Program_1_HC_3,
-	Program_2_HC_3,
-	Working_Mode_HC_4,
-	Monitor_HC_4,
-	Program_1_HC_4,
-	Program_2_HC_4,
-	Monitor_MM_10
-};
-
-/** Enumeration of Message Identifiers in the EMS Bus. */
-enum MessageID {
-	RC_Datetime_ID = 0x06,
-	UBA_Working_Time_ID = 0x14,
-	UBA_Monitor_Fast_ID = 0x18,
-	UBA_Monitor_Slow_ID = 0x19,
-	UBA_Parameter_DHW_ID = 0X33,
-	UBA_Monitor_DHW_ID = 0x34,
-	Flags_DHW_ID = 0x35,
-	Working_Mode_DHW_ID = 0X37,
-	Program_DHW_ID = 0X38,
-	Program_Pump_DHW_ID = 0X39,
-	Working_Mode_HC_1_ID = 0x3D,
-	Monitor_HC_1_ID = 0x3E,
-	Program_1_HC_1_ID = 0x3F,
-	Program_2_HC_1_ID = 0x42,
-	Working_Mode_HC_2_ID = 0x47,
-	Monitor_HC_2_ID = 0x48,
-	Program_1_HC_2_ID = 0x49,
-	Program_2_HC_2_ID = 0x4C,
-	Working_Mode_HC_3_ID = 0x51,
-	Monitor_HC_3_ID = 0x52,
-	Program_1_HC_3_ID = 0x53,
-	Program_2_HC_3_ID = 0x56,
-	Working_Mode_HC_4_ID = 0x5B,
-	Monitor_HC_4_ID = 0x5C,
-	Program_1_HC_4_ID = 0x5D,
-	Program_2_HC_4_ID = 0x60,
-	Monitor_MM_10_ID = 0xAB
-};
-
-/** Enumeration of Device Identifiers in the EMS Bus. */
-enum DeviceID {
-	UBA = 0x08,
-	BC_10 = 0x09,
-	PC = 0x0B,
-	RC_35 = 0x10,
-	WM_10 = 0x11,
-	RC_20 = 0x17,
-	MM_10 = 0x21
-};
-
-
-/**
-* Enumeration that contains the position that each Calduino Data occupies inside the data array
-* of the EMS Datagram. This enumeration is shared by all the Datagrams, so there will be
-* repeated values.
-*/
-
-enum DatagramDataIndex {
-	yearIdx,
-	monthIdx,
-	dayIdx,
-	hourIdx,
-	minuteIdx,
-	secondIdx,
-	uBAWorkingMinIdx = 0,
-	selImpTempIdx = 0,
-	curImpTempIdx,
-	selBurnPowIdx,
-	curBurnPowIdx,
-	burnGasIdx,
-	fanWorkIdx,
-	ignWorkIdx,
-	heatPmpIdx,
-	threeWayValveDHWIdx,
-	circDHWIdx,
-	retTempIdx,
-	flameCurrIdx,
-	sysPressIdx,
-	srvCode1Idx,
-	srvCode2Idx,
-	errCodeIdx,
-	extTempIdx = 0,
-	boilTempIdx,
-	pumpModIdx,
-	burnStartsIdx,
-	burnWorkMinIdx,
-	burnWorkMinHIdx,
-	selTempDHWIdx = 0,
-	tempTDDHWIdx,
-	curTempDHWIdx = 0,
-	dayModeDHWIdx,
-	oneTimeDHW1Idx,
-	desDHWIdx,
-	prepareDHWIdx,
-	burnStartsDHWIdx,
-	burnWorkMinDHWIdx,
-	oneTimeDHW2Idx = 0,
-	progDHWIdx = 0,
-	progPumpDHWIdx,
-	workModeDHWIdx,
-	workModePumpDHWIdx,
-	workModeTDDHWIdx,
-	dayTDDHWIdx,
-	hourTDDHWIdx,
-	selNightTempHCIdx = 0,
-	selDayTempHCIdx,
-	selHoliTempHCIdx,
-	roomTempInfHCIdx,
-	roomTempOffHCIdx,
-	workModeHCIdx,
-	sWThresTempHCIdx,
-	nightSetbackHCIdx,
-	nightOutTempHCIdx,
-	holiModHCIdx = 0,
-	summerModHCIdx,
-	dayModHCIdx,
-	pauseModHCIdx,
-	selRoomTempHCIdx,
-	programNameIdx = 42,
-	pauseTimeIdx,
-	partyTimeIdx,
-	startHolidayDayIdx,
-	startHolidayMonthIdx,
-	startHolidayYearIdx,
-	endHolidayDayIdx,
-	endHolidayMonthIdx,
-	endHolidayYearIdx,
-	startHomeHolidayDayIdx,
-	startHomeHolidayMonthIdx,
-	startHomeHolidayYearIdx,
-	endHomeHolidayDayIdx,
-	endHomeHolidayMonthIdx,
-	endHomeHolidayYearIdx,
-	selImpTempMM10Idx = 0,
-	curImpTempMM10Idx,
-	statusMM10Idx
-};
-
-
-/**
- * Enumeration containing all the available Calduino Data of type Byte. It matches byteRequests
- * array.
- */
-
- enum ByteRequest {
-	year_b,
-	month_b,
-	day_b,
-	hour_b,
-	minute_b,
-	second_b,
-	selImpTemp_b,
-	selBurnPow_b,
-	curBurnPow_b,
-	srvCode1_b,
-	srvCode2_b,
-	pumpMod_b,
-	selTempDHW_b,
-	tempTDDHW_b,
-	oneTimeDHW2_b,
-	progDHW_b,
-	progPumpDHW_b,
-	workModeDHW_b,
-	workModePumpDHW_b,
-	dayTDDHW_b,
-	hourTDDHW_b,
-	workModeHC1_b,
-	sWThresTempHC1_b,
-	nightSetbackHC1_b,
-	workModeHC2_b,
-	sWThresTempHC2_b,
-	nightSetbackHC2_b,
-	workModeHC3_b,
-	sWThresTempHC3_b,
-	nightSetbackHC3_b,
-	workModeHC4_b,
-	sWThresTempHC4_b,
-	nightSetbackHC4_b,
-	programNameHC1_b,
-	pauseTimeHC1_b,
-	partyTimeHC1_b,
-	programNameHC2_b,
-	pauseTimeHC2_b,
-	partyTimeHC2_b,
-	programNameHC3_b,
-	pauseTimeHC3_b,
-	partyTimeHC3_b,
-	programNameHC4_b,
-	pauseTimeHC4_b,
-	partyTimeHC4_b,
-};
-
-
-/**
- * Enumeration containing all the available Calduino Data of type Float. It matches FloatRequests
- * array.
- */
-
- enum FloatRequest {
-	curImpTemp_f,
-	retTemp_f,
-	flameCurr_f,
-	sysPress_f,
-	errCode_f,
-	extTemp_f,
-	boilTemp_f,
-	curTempDHW_f,
-	selNightTempHC1_f,
-	selDayTempHC1_f,
-	selHoliTempHC1_f,
-	roomTempInfHC1_f,
-	roomTempOffHC1_f,
-	nightOutTempHC1_f,
-	selNightTempHC2_f,
-	selDayTempHC2_f,
-	selHoliTempHC2_f,
-	roomTempInfHC2_f,
-	roomTempOffHC2_f,
-	nightOutTempHC2_f,
-	selNightTempHC3_f,
-	selDayTempHC3_f,
-	selHoliTempHC3_f,
-	roomTempInfHC3_f,
-	roomTempOffHC3_f,
-	nightOutTempHC3_f,
-	selNightTempHC4_f,
-	selDayTempHC4_f,
-	selHoliTempHC4_f,
-	roomTempInfHC4_f,
-	roomTempOffHC4_f,
-	nightOutTempHC4_f,
-	selRoomTempHC1_f,
-	selRoomTempHC2_f,
-	selRoomTempHC3_f,
-	selRoomTempHC4_f,
-	curImpTempMM10_f,
-};
-
-
-/**
- * Enumeration containing all the available Calduino Data of type ULong. It matches
- * ULongRequests array.
- */
-
- enum ULongRequest {
-	uBAWorkingMin_ul,
-	burnStarts_ul,
-	burnWorkMin_ul,
-	burnWorkMinH_ul,
-	burnStartsDHW_ul,
-	burnWorkMinDHW_ul,
-};
-
-
-/**
- * Enumeration containing all the available Calduino Data of type Bit. It matches BitRequests
- * array.
- */
-
- enum BitRequest {
-		burnGas_t,
-		fanWork_t,
-		ignWork_t,
-		heatPmp_t,
-		threeWayValveDHW_t,
-		circDHW_t,
-		dayModeDHW_t,
-		oneTimeDHW_t,
-		desDHW_t,
-		prepareDHW_t,
-		holiModHC1_t,
-		summerModHC1_t,
-		dayModHC1_t,
-		pauseModHC1_t,
-		holiModHC2_t,
-		summerModHC2_t,
-		dayModHC2_t,
-		pauseModHC2_t,
-		holiModHC3_t,
-		summerModHC3_t,
-		dayModHC3_t,
-		pauseModHC3_t,
-		holiModHC4_t,
-		summerModHC4_t,
-		dayModHC4_t,
-		pauseModHC4_t
-};
-
-/**
- * EMS Datagram struct definition. Each datagram contains:
- * - Name in Flash string (for printing/debugging).  
- * - MessageID.  
- * - DeviceID.  
- * - MessageLength is the length in bytes of the EMS Message.
- * - DataSize contain the number of Calduino Data that this Datagram contains. It will match the
- * array size of data.
- * - Data is an array in PROGMEM containing the Data included in this Datagram.
- */
-
-struct EMSDatagram {
-	prog_char* messageName;
-	MessageID messageID;
-	DeviceID destinationID;
-	byte messageLength;
-	byte dataSize;
-	const PROGMEM CalduinoData* data;
-
-	void printMessageName(char* str, boolean header, PrintFormat printFormat);
-	void printErrorTag(char* str, PrintFormat printFormat);
-};
-
-
-typedef const PROGMEM CalduinoData Prog_CalduinoDataType;
-typedef const PROGMEM EMSDatagram Prog_EMSDatagram;
-#pragma endregion EMSDatagram
-
-/* CalduinoDebug declaration */
-#pragma region CalduinoDebug
-
-class CalduinoDebug : public Stream {
-private:
-	Stream *debugSerial;
-
-public:
-	CalduinoDebug();
-	void begin(Stream *_debugSerial);
-
-	virtual size_t write(uint8_t byte);
-	virtual int read() { return debugSerial->read(); }
-	virtual int available() { return debugSerial->available(); }
-	virtual void flush() { return debugSerial->flush(); }
-	virtual int peek() { return debugSerial->peek(); }
-
-	using Print::write;
-};
-
-#pragma endregion CalduinoDebug
-
-/* CalduinoSerial declaration */
-#pragma region CalduinoSerial
-
-class CalduinoSerial {
-private:
-	EMSSerial * calduinoSerial;
-
-public:
-	CalduinoSerial();
-	void begin(EMSSerial *_calduinoSerial);
-
-	virtual size_t write(uint8_t byte) { return calduinoSerial->write(byte); }
-	virtual int read() { return calduinoSerial->read(); }
-	virtual int available() { return calduinoSerial->available(); }
-	virtual void flush() { return calduinoSerial->flush(); }
-	virtual int peek() { return calduinoSerial->peek(); }
-	virtual void writeEOF() { return calduinoSerial->writeEOF(); }
-	virtual bool frameError() { return calduinoSerial->frameError(); }
-};
-
-#pragma endregion CalduinoSerial
-
-/* Calduino declaration */
-#pragma region Calduino
-
-class Calduino {
-private:
-	uint8_t crcCalculator(byte *eMSBuffer, int len);
-	boolean crcCheckOK(byte * inEMSBuffer, int len);
-	int readBytes(byte * inEMSBuffer, byte len, uint32_t eMSTimeout);
-	void sendBuffer(byte * outEMSBuffer, int len);
-	boolean sendRequest(byte *outEMSBuffer);
-	boolean getEMSBuffer(byte *inEMSBuffer, EMSDatagram eMSDatagram, byte length = 0, byte offset = 0);
-	boolean getEMSCommand(byte *inEMSBuffer, byte destinationID, byte messageID, byte length, byte offset = 0);
-	boolean setEMSCommand(byte destinationID, byte messageID, byte offset, byte data);
-	boolean updateEMSDatagram(EMSDatagramID eMSDatagramID, DatagramDataIndex datagramDataIndex, byte data, byte extraOffset = 0);
-
-	unsigned long EMSMaxWaitTime;
-	CalduinoDebug debugSerial;
-	CalduinoSerial calduinoSerial;
-
-public:
-	Calduino();
-
-	boolean begin(EMSSerial *_calduinoSerial, Stream *debugSerial = NULL);
-
-	// Get EMS Commands
-	boolean printEMSDatagram(EMSDatagramID eMSDatagramID, DatagramDataIndex datagramDataIndex = ERROR_VALUE);
-	byte getCalduinoByteValue(ByteRequest typeIdx);
-	float getCalduinoFloatValue(FloatRequest typeIdx);
-	unsigned long getCalduinoUlongValue(ULongRequest typeIdx);
-	boolean getCalduinoBitValue(BitRequest typeIdx);
-	SwitchPoint getCalduinoSwitchPoint(EMSDatagramID selProgram, byte switchPointID);
-
-	// Set EMS Commands
-	boolean setWorkModeHC(byte selHC, byte selMode);
-	boolean setTemperatureHC(byte selHC, byte selMode, byte selTmp);
-	boolean setProgramHC(byte selHC, byte selProgram);
-	boolean setSWThresholdTempHC(byte selHC, byte selTmp);
-	boolean setNightSetbackModeHC(byte selHC, byte selMode);
-	boolean setNightThresholdOutTempHC(byte selHC, int8_t selTmp);
-	boolean setRoomTempOffsetHC(byte selHC, int8_t selTmp);
-	boolean setPauseModeHC(byte selHC, byte duration);
-	boolean setPartyModeHC(byte selHC, byte duration);
-	boolean setHolidayModeHC(byte selHC, byte startHolidayDay, byte startHoldidayMonth, byte startHolidayYear, byte endHolidayDay, byte endHoldidayMonth, byte endHolidayYear);
-	boolean setHomeHolidayModeHC(byte selHC, byte startHomeHolidayDay, byte startHomeHoldidayMonth, byte startHomeHolidayYear, byte endHomeHolidayDay, byte endHomeHoldidayMonth, byte endHomeHolidayYear);
-	boolean setWorkModeDHW(byte selMode);
-	boolean setWorkModePumpDHW(byte selMode);
-	boolean setTemperatureDHW(byte selTmp);
-	boolean setTemperatureTDDHW(byte selTmp);
-	boolean setProgramDHW(byte selProgram);
-	boolean setProgramPumpDHW(byte selProgram);
-	boolean setOneTimeDHW(boolean selMode);
-	boolean setWorkModeTDDHW(byte selMode);
-	boolean setDayTDDHW(byte dayTherDisDHW);
-	boolean setHourTDDHW(byte hourTherDisDHW);
-	boolean setProgramSwitchPoint(EMSDatagramID selProgram, byte switchPointID, byte operationSwitchPoint, byte daySwitchPoint, byte hourSwitchPoint, byte minuteSwitchPoint);
-
-	PrintFormat printFormat;
-};
-
-#pragma endregion Calduino
-
-#endif
+/*
+* Copyright (c) 2018 Daniel Macías Perea (dani.macias.perea@gmail.com)
+*   
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+* 
+* Legal Notices
+* 'Bosch Group', 'Buderus', 'Nefit' and 'Worcester' are brands of Bosch Thermotechnology.
+* All other trademarks are the property of their respective owners.
+*/
+
+/* Release history
+*
+* Version  Date         Description
+* 0.1      25-Apr-2018  First release.
+* 0.2	   22-May-2018  Operation to set Thermal Disinfection splitted in two. 
+*						Retry factor adapted to minimize errors.
+* 0.3      05-Jun-2018  Corrected UBAMonitorDHW Datagram
+*/
+
+/**
+* @mainpage EMS Bus - Arduino library.
+*
+* This library provides functions to communicate through the EMS Bus with Buderus/Nefit/Worcester
+* (or any other EMS Bus compatible) boilers. It includes commands for both getting status information
+* (UBA Monitor, DHW Monitor, etc.) and setting new configurations (Set Day/Night Temperature,
+* Set Working Mode, etc.).
+*
+* @author	dani.macias.perea@gmail.com
+*/
+
+/**
+* @file Calduino.h
+*
+* @brief The Calduino class definition including EMSSerial, CalduinoDebug, CalduinoSerial, Calduino Datagrams and Calduino Datas.
+*/
+
+
+#ifndef Calduino_h
+#define Calduino_h
+
+#include <Arduino.h>
+
+#define SERIAL_BUFFER_SIZE 48
+#define EMS_FRAME_QUEUE_SIZE 4
+#define EMS_TX_BUFFER_SIZE 32
+#define MAX_EMS_READ 32
+#define MAX_EMS_WRITE 8
+
+#if MAX_EMS_READ > SERIAL_BUFFER_SIZE
+# MAX_EMS_READ = SERIAL_BUFFER_SIZE
+#endif
+
+
+#define ERROR_VALUE 0xFF
+#define HEATING_CIRCUITS 2
+#define SWITCHING_POINTS 42
+
+#define EMS_CACHE_SLOTS 4
+#define EMS_CACHE_BUFFER_SIZE 48
+#define EMS_REPORT_SLOTS 4
+#define CALDUINO_UNITS 9
+#define EMS_DEVICES 6
+#define VERSION_MESSAGE_SIZE 3
+
+#define CALDUINO_TRANSACTIONS 4
+#define EMS_DATAGRAMS 27
+#define STATS_HISTOGRAM_BINS 12
+
+/* Fixed-point values are integers in tenths, FIXED_ERROR_VALUE is the EMS "no sensor" value */
+#define FIXED_POINT_SCALE 10
+#define FIXED_ERROR_VALUE ((int16_t)0x8000)
+
+/* Comment to build without float (getCalduinoFloatValue, float CalduinoFields and Float batch requests) */
+#define CALDUINO_FLOAT
+
+/* Uncomment to measure the CPU cycles of the hot paths with Timer 1 (see CalduinoProfile example) */
+//#define CALDUINO_PROFILE
+
+/* Uncomment to keep the counters and histograms of the EMS Bus, getStats() (488 bytes of SRAM) */
+//#define CALDUINO_STATS
+
+/* Uncomment to cache EMS Datagram snapshots, setCacheTTL() (58 bytes of SRAM per EMS_CACHE_SLOTS) */
+//#define CALDUINO_CACHE
+
+/* Uncomment to print EMS Datagrams in delta mode, setDeltaReport() (52 bytes of SRAM per
+   EMS_REPORT_SLOTS, plus 18 bytes of deadbands) */
+//#define CALDUINO_REPORTS
+
+#define PSTR(s) (__extension__({static prog_char __c[] PROGMEM = (s); &__c[0];})) 
+#define FPSTR(pstr_pointer) (reinterpret_cast<const __FlashStringHelper *>(pstr_pointer))
+
+typedef const PROGMEM char prog_char;
+
+/* CalduinoProfile declaration */
+#pragma region CalduinoProfile
+
+#ifdef CALDUINO_PROFILE
+
+/**
+ * Enumeration of the profiled sections. The RX and TX sections are the bodies of the USART
+ * interrupts, so their maximum is the worst-case time with the interrupts disabled (plus the
+ * entry and exit of the interrupt).
+ */
+
+enum ProfileSection {
+	RxISR,
+	TxISR,
+	StoreChar,
+	CRCCalculator,
+	PrintData,
+	PrintObject
+};
+
+#define PROFILE_SECTIONS 6
+
+/**
+ * Profile Counter struct definition. Number of times a section has been executed, total and
+ * maximum CPU cycles spent in it. Cycles are measured with Timer 1 running at the CPU clock, so
+ * a single execution must take less than 65536 cycles. Sections executed outside interrupts
+ * include the time of the interrupts served meanwhile.
+ */
+
+struct ProfileCounter {
+	unsigned long count;
+	unsigned long cycles;
+	uint16_t maxCycles;
+};
+
+void profileBegin();
+void profileReset();
+ProfileCounter getProfileCounter(ProfileSection section);
+void profileAdd(ProfileSection section, uint16_t cycles);
+
+/** Measure the cycles from its declaration to the end of the enclosing block. */
+struct ProfileScope {
+	ProfileSection section;
+	uint16_t start;
+
+	ProfileScope(ProfileSection _section) { section = _section; start = TCNT1; }
+	~ProfileScope() { profileAdd(section, TCNT1 - start); }
+};
+
+#define PROFILE_SCOPE(section) ProfileScope profileScope(section)
+#else
+#define PROFILE_SCOPE(section)
+#endif
+
+#pragma endregion CalduinoProfile
+
+/* EMSSerial declaration */
+#pragma region EMSSERIAL
+
+/**
+ * EMS Frame struct definition. A frame is a complete telegram delimited by a break in the EMS
+ * Bus, published by the RX interrupt in the frame queue of the EMS Serial.
+ * - Start is the position of the first byte of the frame in the reception buffer.
+ * - Length is the number of bytes of the frame, including the break.
+ * - CRC OK is whether the CRC received matches the one calculated while receiving.
+ */
+
+struct EMSFrame {
+	uint8_t start;
+	uint8_t length;
+	bool crcOK;
+};
+
+
+/**
+ * Hardware Serial class adapted to EMS Buffer characteristics. There is only a reception
+ * buffer. WriteEOF will disable reception and change UART parity to send without errors an 11
+ * bits 0 chain. Flush operation will disable and enable reception to erase the buffer.
+ * The RX interrupt delimits the telegrams received with the EMS break and publishes them in a
+ * frame queue, so complete frames can be consumed with frameAvailable and readFrame. Byte
+ * oriented operations (peek, read) bypass the frame queue and should not be mixed with them.
+ * WriteFrame sends a frame driven by the interrupts: every byte is sent when the echo of the
+ * previous one is received from the EMS Bus, and the break right after the last echo. An echo
+ * that does not match the byte sent is reported as a collision.
+ */
+
+class EMSSerial : public Stream {
+protected:
+	volatile uint8_t *_ubrrh;
+	volatile uint8_t *_ubrrl;
+	volatile uint8_t *_ucsra;
+	volatile uint8_t *_ucsrb;
+	volatile uint8_t *_ucsrc;
+	volatile uint8_t *_udr;
+	uint8_t _rxen;
+	uint8_t _txen;
+	uint8_t _rxcie;
+	uint8_t _txcie;
+	uint8_t _error;
+	bool _written;
+
+	friend void store_char(unsigned char c, bool fe, EMSSerial *s);
+	friend void tx_complete(EMSSerial *s);
+
+public:
+	volatile uint8_t _rx_buffer_head;
+	volatile uint8_t _rx_buffer_tail;
+
+	unsigned char _rx_buffer[SERIAL_BUFFER_SIZE];
+	bool _error_flag[SERIAL_BUFFER_SIZE];
+
+	volatile uint8_t _frame_head;
+	volatile uint8_t _frame_tail;
+	EMSFrame _frames[EMS_FRAME_QUEUE_SIZE];
+
+	uint8_t _frame_start;
+	uint8_t _frame_length;
+	uint8_t _frame_crc;
+	uint8_t _frame_prev_crc;
+	bool _frame_overflow;
+	uint16_t _rx_overflows;
+
+	unsigned char _tx_buffer[EMS_TX_BUFFER_SIZE];
+	uint8_t _tx_length;
+	volatile uint8_t _tx_index;
+	volatile bool _tx_busy;
+	volatile bool _tx_collision;
+	uint8_t _tx_ucsrc;
+
+	EMSSerial(
+		volatile uint8_t *ubrrh, volatile uint8_t *ubrrl,
+		volatile uint8_t *ucsra, volatile uint8_t *ucsrb,
+		volatile uint8_t *ucsrc, volatile uint8_t *udr,
+		uint8_t rxen, uint8_t txen, uint8_t rxcie, uint8_t txcie);
+	EMSSerial();
+	bool begin(unsigned long baud);
+	void end();
+	void writeEOF();
+	virtual int available(void);
+	bool frameError() { bool ret = _error; 	_error = false;  return ret; }
+	int frameAvailable(void);
+	int readFrame(byte *buffer, byte len, bool *crcOK = NULL);
+	bool writeFrame(const byte *buffer, byte len);
+	bool txBusy() { return _tx_busy; }
+	bool collision() { bool ret = _tx_collision; _tx_collision = false; return ret; }
+	uint16_t rxOverflows() { return _rx_overflows; }
+	virtual int peek(void);
+	virtual int read(void);
+	virtual void flush(void);
+	virtual size_t write(uint8_t);
+	inline size_t write(unsigned long n) { return write((uint8_t)n); }
+	inline size_t write(long n) { return write((uint8_t)n); }
+	inline size_t write(unsigned int n) { return write((uint8_t)n); }
+	inline size_t write(int n) { return write((uint8_t)n); }
+	//using Print::write; // pull in write(str) and write(buf, size) from Print
+	operator bool();
+};
+
+uint8_t crc_update(uint8_t crc, uint8_t c);
+void store_char(unsigned char c, bool fe, EMSSerial *s);
+void tx_complete(EMSSerial *s);
+
+#if defined(UBRRH) || defined(UBRR0H)
+extern EMSSerial EMSSerial0;
+#endif
+#if defined(UBRR1H)
+extern EMSSerial EMSSerial1;
+#endif
+#if defined(UBRR2H)
+extern EMSSerial EMSSerial2;
+#endif
+#if defined(UBRR3H) 
+extern EMSSerial EMSSerial3;
+#endif
+
+#pragma endregion EMSSerial
+
+/* CalduinoData declaration */
+#pragma region CalduinoData
+
+/**
+ * Enumeration of Calduino Units. It should match the calduinoUnits array, which contains a
+ * flash string for each unit.
+ */
+
+ enum CalduinoUnit {
+	None,
+	Celsius,
+	YesNo,
+	MAmper,
+	Bar,
+	Minute,
+	Times,
+	Percentage,
+	Seconds
+};
+
+
+/**
+ * Enumeration that represent calduino encode types. Each enconde type will parse the bytes contained
+ * in the EMS Datagram in a different way. UInt is a 2 bytes unsigned integer that is not a physical
+ * value (e.g. the error code). Fixed is not used by any Calduino Data, only by the Calduino Value
+ * Requests to get a Float in fixed point.
+ */
+
+ enum CalduinoEncodeType {
+	Byte,
+	Bit,
+	Float,
+	ULong,
+	SwithPoint,
+	UInt,
+	Fixed
+};
+
+
+/**
+ * Print Format enumeration.
+ * - Standard prints values and units.  
+ * - XML surrounds values with name tags.  
+ * - NoUnit prints only values.  
+ * - JSON prints a compact JSON object, without units.  
+ * - Binary prints a compact telemetry record per EMS Datagram (see CalduinoSerializer).
+ */
+
+ enum PrintFormat {
+	Standard,
+	NoUnit,
+	XML,
+	JSON,
+	Binary
+};
+
+
+/**
+ * Switch point struct definition.
+ * - Id is the identification of the Switch Point.
+ * - Action is the operation performed (0 - off/night, 1 - on/day, 7 - undefined).
+ * - Point in time (day from 0 - monday to 6 - sunday,
+ * hours from 0 to 23 and minute from 0 to 50, in 10 minutes increments).
+ */
+
+typedef struct SwitchPoint {
+	byte id;
+	byte action;
+	byte day;
+	byte hour;
+	byte minute;
+};
+
+
+/**
+ * Decode the Calduino Data of each encode type from the EMS bytes received. They are shared by
+ * CalduinoData, which takes the parameters from program memory, and CalduinoField, which has them
+ * as compile-time constants. Float values are decoded in fixed point (tenths, the float factor is
+ * always 1, 2 or 10), the float is only a conversion of it. The exception are the Float requests
+ * of 2 bytes without float factor (errCode_f), which are UInt codes: exact as float, and
+ * FIXED_ERROR_VALUE in fixed point when their tenths do not fit.
+ */
+
+inline byte decodeEMSByte(const byte *inEMSBuffer, byte offset)
+{
+	return inEMSBuffer[offset];
+}
+
+inline boolean decodeEMSBit(const byte *inEMSBuffer, byte offset, byte bitOffset)
+{
+	return bitRead(inEMSBuffer[offset], bitOffset);
+}
+
+inline unsigned long decodeEMSULong(const byte *inEMSBuffer, byte offset)
+{
+	return (((unsigned long)inEMSBuffer[offset]) << 16) + (((unsigned long)inEMSBuffer[offset + 1]) << 8) + inEMSBuffer[offset + 2];
+}
+
+inline uint16_t decodeEMSUInt(const byte *inEMSBuffer, byte offset)
+{
+	return ((uint16_t)inEMSBuffer[offset] << 8) | inEMSBuffer[offset + 1];
+}
+
+inline boolean isEMSUInt(byte floatBytes, byte floatFactor)
+{
+	return (floatBytes == 2) && (floatFactor == 1);
+}
+
+inline int16_t decodeEMSFixed(const byte *inEMSBuffer, byte offset, byte floatBytes, byte floatFactor)
+{
+	if (isEMSUInt(floatBytes, floatFactor))
+	{
+		uint16_t code = decodeEMSUInt(inEMSBuffer, offset);
+		return (code > 0x7FFF / FIXED_POINT_SCALE) ? FIXED_ERROR_VALUE : (int16_t)(code * FIXED_POINT_SCALE);
+	}
+
+	int16_t value = ((floatBytes == 2) ? (int16_t)((inEMSBuffer[offset] << 8) | inEMSBuffer[offset + 1]) : (int8_t)inEMSBuffer[offset]);
+
+	return (value == FIXED_ERROR_VALUE) ? value : value * (FIXED_POINT_SCALE / floatFactor);
+}
+
+#ifdef CALDUINO_FLOAT
+inline float fixedToFloat(int16_t value)
+{
+	return (value == FIXED_ERROR_VALUE) ? NAN : (float)value / FIXED_POINT_SCALE;
+}
+
+inline float decodeEMSFloat(const byte *inEMSBuffer, byte offset, byte floatBytes, byte floatFactor)
+{
+	if (isEMSUInt(floatBytes, floatFactor)) return decodeEMSUInt(inEMSBuffer, offset);
+
+	return fixedToFloat(decodeEMSFixed(inEMSBuffer, offset, floatBytes, floatFactor));
+}
+#endif
+
+void formatFixedValue(char *str, int16_t value);
+
+
+/**
+ * Calduino data struct definition.
+ * - Name is the ID of the data.  
+ * - Encode Type to use by parsing from the EMS Buffer.  
+ * - Unit of the data.  
+ * - Offset is the position that the data occupies in the EMS Buffer.  
+ * - Bit Offset is only used for bit types.  
+ * - Float bytes is only used for float types. It is the number of bytes represented by the
+ * value in the EMS Buffer.  
+ * - Float factor is only used for float types. Floats are coded multiplied by a factor (2 or
+ * 10) to avoid decimals in the EMS Buffer. To decode a float it should by diveded by this
+ * factor.
+ */
+
+struct CalduinoData {
+	prog_char* dataName;
+	CalduinoEncodeType encodeType;
+	CalduinoUnit unit;
+	byte offset;
+	byte bitOffset;
+	byte floatBytes;
+	byte floatFactor;
+
+	byte getLength();
+	byte decodeByteValue(byte* inEMSBuffer);
+	bool decodeBitValue(byte* inEMSBuffer);
+	unsigned long decodeULongValue(byte* inEMSBuffer);
+	uint16_t decodeUIntValue(byte* inEMSBuffer);
+	SwitchPoint decodeSwitchPoint(byte *inEMSBuffer);
+	int16_t decodeFixedValue(byte* inEMSBuffer);
+#ifdef CALDUINO_FLOAT
+	float decodeFloatValue(byte* inEMSBuffer);
+#endif
+};
+
+#pragma endregion CalduinoData
+
+/* EMSDatagram declaration */
+#pragma region EMSDatagram
+
+/* Enumeration of EMS Datagram. It matches the eMSDatagramIDs array. */
+typedef enum EMSDatagramID {
+	RC_Datetime,
+	UBA_Working_Time,
+	UBA_Monitor_Fast,
+	UBA_Monitor_Slow,
+	UBA_Parameter_DHW,
+	UBA_Monitor_DHW,
+	Flags_DHW,
+	Working_Mode_DHW,
+	Program_DHW,
+	Program_Pump_DHW,
+	Working_Mode_HC_1,
+	Monitor_HC_1,
+	Program_1_HC_1,
+	Program_2_HC_1,
+	Working_Mode_HC_2,
+	Monitor_HC_2,
+	Program_1_HC_2,
+	Program_2_HC_2,
+	Working_Mode_HC_3,
+	Monitor_HC_3,
+	Program_1_HC_3,
+	Program_2_HC_3,
+	Working_Mode_HC_4,
+	Monitor_HC_4,
+	Program_1_HC_4,
+	Program_2_HC_4,
+	Monitor_MM_10
+};
+
+/** Enumeration of Message Identifiers in the EMS Bus. */
+enum MessageID {
+	Version_ID = 0x02,
+	RC_Datetime_ID = 0x06,
+	UBA_Working_Time_ID = 0x14,
+	UBA_Monitor_Fast_ID = 0x18,
+	UBA_Monitor_Slow_ID = 0x19,
+	UBA_Parameter_DHW_ID = 0X33,
+	UBA_Monitor_DHW_ID = 0x34,
+	Flags_DHW_ID = 0x35,
+	Working_Mode_DHW_ID = 0X37,
+	Program_DHW_ID = 0X38,
+	Program_Pump_DHW_ID = 0X39,
+	Working_Mode_HC_1_ID = 0x3D,
+	Monitor_HC_1_ID = 0x3E,
+	Program_1_HC_1_ID = 0x3F,
+	Program_2_HC_1_ID = 0x42,
+	Working_Mode_HC_2_ID = 0x47,
+	Monitor_HC_2_ID = 0x48,
+	Program_1_HC_2_ID = 0x49,
+	Program_2_HC_2_ID = 0x4C,
+	Working_Mode_HC_3_ID = 0x51,
+	Monitor_HC_3_ID = 0x52,
+	Program_1_HC_3_ID = 0x53,
+	Program_2_HC_3_ID = 0x56,
+	Working_Mode_HC_4_ID = 0x5B,
+	Monitor_HC_4_ID = 0x5C,
+	Program_1_HC_4_ID = 0x5D,
+	Program_2_HC_4_ID = 0x60,
+	Monitor_MM_10_ID = 0xAB
+};
+
+/** Enumeration of Device Identifiers in the EMS Bus. */
+enum DeviceID {
+	UBA = 0x08,
+	BC_10 = 0x09,
+	PC = 0x0B,
+	RC_35 = 0x10,
+	WM_10 = 0x11,
+	RC_20 = 0x17,
+	MM_10 = 0x21
+};
+
+
+/**
+* Enumeration that contains the position that each Calduino Data occupies inside the data array
+* of the EMS Datagram. This enumeration is shared by all the Datagrams, so there will be
+* repeated values.
+*/
+
+enum DatagramDataIndex {
+	yearIdx,
+	monthIdx,
+	dayIdx,
+	hourIdx,
+	minuteIdx,
+	secondIdx,
+	uBAWorkingMinIdx = 0,
+	selImpTempIdx = 0,
+	curImpTempIdx,
+	selBurnPowIdx,
+	curBurnPowIdx,
+	burnGasIdx,
+	fanWorkIdx,
+	ignWorkIdx,
+	heatPmpIdx,
+	threeWayValveDHWIdx,
+	circDHWIdx,
+	retTempIdx,
+	flameCurrIdx,
+	sysPressIdx,
+	srvCode1Idx,
+	srvCode2Idx,
+	errCodeIdx,
+	extTempIdx = 0,
+	boilTempIdx,
+	pumpModIdx,
+	burnStartsIdx,
+	burnWorkMinIdx,
+	burnWorkMinHIdx,
+	selTempDHWIdx = 0,
+	tempTDDHWIdx,
+	curTempDHWIdx = 0,
+	dayModeDHWIdx,
+	oneTimeDHW1Idx,
+	desDHWIdx,
+	prepareDHWIdx,
+	burnWorkMinDHWIdx,
+	burnStartsDHWIdx,
+	oneTimeDHW2Idx = 0,
+	progDHWIdx = 0,
+	progPumpDHWIdx,
+	workModeDHWIdx,
+	workModePumpDHWIdx,
+	workModeTDDHWIdx,
+	dayTDDHWIdx,
+	hourTDDHWIdx,
+	selNightTempHCIdx = 0,
+	selDayTempHCIdx,
+	selHoliTempHCIdx,
+	roomTempInfHCIdx,
+	roomTempOffHCIdx,
+	workModeHCIdx,
+	sWThresTempHCIdx,
+	nightSetbackHCIdx,
+	nightOutTempHCIdx,
+	holiModHCIdx = 0,
+	summerModHCIdx,
+	dayModHCIdx,
+	pauseModHCIdx,
+	selRoomTempHCIdx,
+	programNameIdx = 42,
+	pauseTimeIdx,
+	partyTimeIdx,
+	startHolidayDayIdx,
+	startHolidayMonthIdx,
+	startHolidayYearIdx,
+	endHolidayDayIdx,
+	endHolidayMonthIdx,
+	endHolidayYearIdx,
+	startHomeHolidayDayIdx,
+	startHomeHolidayMonthIdx,
+	startHomeHolidayYearIdx,
+	endHomeHolidayDayIdx,
+	endHomeHolidayMonthIdx,
+	endHomeHolidayYearIdx,
+	selImpTempMM10Idx = 0,
+	curImpTempMM10Idx,
+	statusMM10Idx
+};
+
+
+/**
+ * List of all the available Calduino Data of type Byte: X(request, EMS Datagram ID, offset).
+ * It generates the ByteRequest enumeration, the byteRequests array and the CalduinoField
+ * accessors, so the three of them are always in sync.
+ */
+
+#define CALDUINO_BYTE_REQUESTS(X) \
+	X(year_b, RC_Datetime, 4) \
+	X(month_b, RC_Datetime, 5) \
+	X(day_b, RC_Datetime, 7) \
+	X(hour_b, RC_Datetime, 6) \
+	X(minute_b, RC_Datetime, 8) \
+	X(second_b, RC_Datetime, 9) \
+	X(selImpTemp_b, UBA_Monitor_Fast, 4) \
+	X(selBurnPow_b, UBA_Monitor_Fast, 7) \
+	X(curBurnPow_b, UBA_Monitor_Fast, 8) \
+	X(srvCode1_b, UBA_Monitor_Fast, 22) \
+	X(srvCode2_b, UBA_Monitor_Fast, 23) \
+	X(pumpMod_b, UBA_Monitor_Slow, 13) \
+	X(selTempDHW_b, UBA_Parameter_DHW, 6) \
+	X(tempTDDHW_b, UBA_Parameter_DHW, 12) \
+	X(oneTimeDHW2_b, Flags_DHW, 4) \
+	X(progDHW_b, Working_Mode_DHW, 4) \
+	X(progPumpDHW_b, Working_Mode_DHW, 5) \
+	X(workModeDHW_b, Working_Mode_DHW, 6) \
+	X(workModePumpDHW_b, Working_Mode_DHW, 7) \
+	X(dayTDDHW_b, Working_Mode_DHW, 9) \
+	X(hourTDDHW_b, Working_Mode_DHW, 10) \
+	X(workModeHC1_b, Working_Mode_HC_1, 11) \
+	X(sWThresTempHC1_b, Working_Mode_HC_1, 26) \
+	X(nightSetbackHC1_b, Working_Mode_HC_1, 29) \
+	X(workModeHC2_b, Working_Mode_HC_2, 11) \
+	X(sWThresTempHC2_b, Working_Mode_HC_2, 26) \
+	X(nightSetbackHC2_b, Working_Mode_HC_2, 29) \
+	X(workModeHC3_b, Working_Mode_HC_3, 11) \
+	X(sWThresTempHC3_b, Working_Mode_HC_3, 26) \
+	X(nightSetbackHC3_b, Working_Mode_HC_3, 29) \
+	X(workModeHC4_b, Working_Mode_HC_4, 11) \
+	X(sWThresTempHC4_b, Working_Mode_HC_4, 26) \
+	X(nightSetbackHC4_b, Working_Mode_HC_4, 29) \
+	X(programNameHC1_b, Program_1_HC_1, 88) \
+	X(pauseTimeHC1_b, Program_1_HC_1, 89) \
+	X(partyTimeHC1_b, Program_1_HC_1, 90) \
+	X(programNameHC2_b, Program_1_HC_2, 88) \
+	X(pauseTimeHC2_b, Program_1_HC_2, 89) \
+	X(partyTimeHC2_b, Program_1_HC_2, 90) \
+	X(programNameHC3_b, Program_1_HC_3, 88) \
+	X(pauseTimeHC3_b, Program_1_HC_3, 89) \
+	X(partyTimeHC3_b, Program_1_HC_3, 90) \
+	X(programNameHC4_b, Program_1_HC_4, 88) \
+	X(pauseTimeHC4_b, Program_1_HC_4, 89) \
+	X(partyTimeHC4_b, Program_1_HC_4, 90)
+
+
+/**
+ * List of all the available Calduino Data of type Float: X(request, EMS Datagram ID, offset,
+ * float bytes, float factor).
+ */
+
+#define CALDUINO_FLOAT_REQUESTS(X) \
+	X(curImpTemp_f, UBA_Monitor_Fast, 5, 2, 10) \
+	X(retTemp_f, UBA_Monitor_Fast, 17, 2, 10) \
+	X(flameCurr_f, UBA_Monitor_Fast, 19, 2, 10) \
+	X(sysPress_f, UBA_Monitor_Fast, 21, 1, 10) \
+	X(errCode_f, UBA_Monitor_Fast, 24, 2, 1) \
+	X(extTemp_f, UBA_Monitor_Slow, 4, 2, 10) \
+	X(boilTemp_f, UBA_Monitor_Slow, 6, 2, 10) \
+	X(curTempDHW_f, UBA_Monitor_DHW, 5, 2, 10) \
+	X(selNightTempHC1_f, Working_Mode_HC_1, 5, 1, 2) \
+	X(selDayTempHC1_f, Working_Mode_HC_1, 6, 1, 2) \
+	X(selHoliTempHC1_f, Working_Mode_HC_1, 7, 1, 2) \
+	X(roomTempInfHC1_f, Working_Mode_HC_1, 8, 1, 2) \
+	X(roomTempOffHC1_f, Working_Mode_HC_1, 10, 1, 2) \
+	X(nightOutTempHC1_f, Working_Mode_HC_1, 43, 1, 1) \
+	X(selNightTempHC2_f, Working_Mode_HC_2, 5, 1, 2) \
+	X(selDayTempHC2_f, Working_Mode_HC_2, 6, 1, 2) \
+	X(selHoliTempHC2_f, Working_Mode_HC_2, 7, 1, 2) \
+	X(roomTempInfHC2_f, Working_Mode_HC_2, 8, 1, 2) \
+	X(roomTempOffHC2_f, Working_Mode_HC_2, 10, 1, 2) \
+	X(nightOutTempHC2_f, Working_Mode_HC_2, 43, 1, 1) \
+	X(selNightTempHC3_f, Working_Mode_HC_3, 5, 1, 2) \
+	X(selDayTempHC3_f, Working_Mode_HC_3, 6, 1, 2) \
+	X(selHoliTempHC3_f, Working_Mode_HC_3, 7, 1, 2) \
+	X(roomTempInfHC3_f, Working_Mode_HC_3, 8, 1, 2) \
+	X(roomTempOffHC3_f, Working_Mode_HC_3, 10, 1, 2) \
+	X(nightOutTempHC3_f, Working_Mode_HC_3, 43, 1, 1) \
+	X(selNightTempHC4_f, Working_Mode_HC_4, 5, 1, 2) \
+	X(selDayTempHC4_f, Working_Mode_HC_4, 6, 1, 2) \
+	X(selHoliTempHC4_f, Working_Mode_HC_4, 7, 1, 2) \
+	X(roomTempInfHC4_f, Working_Mode_HC_4, 8, 1, 2) \
+	X(roomTempOffHC4_f, Working_Mode_HC_4, 10, 1, 2) \
+	X(nightOutTempHC4_f, Working_Mode_HC_4, 43, 1, 1) \
+	X(selRoomTempHC1_f, Monitor_HC_1, 6, 1, 2) \
+	X(selRoomTempHC2_f, Monitor_HC_2, 6, 1, 2) \
+	X(selRoomTempHC3_f, Monitor_HC_3, 6, 1, 2) \
+	X(selRoomTempHC4_f, Monitor_HC_4, 6, 1, 2) \
+	X(curImpTempMM10_f, Monitor_MM_10, 5, 2, 10)
+
+
+/**
+ * List of all the available Calduino Data of type ULong: X(request, EMS Datagram ID, offset).
+ */
+
+#define CALDUINO_ULONG_REQUESTS(X) \
+	X(uBAWorkingMin_ul, UBA_Working_Time, 4) \
+	X(burnStarts_ul, UBA_Monitor_Slow, 14) \
+	X(burnWorkMin_ul, UBA_Monitor_Slow, 17) \
+	X(burnWorkMinH_ul, UBA_Monitor_Slow, 23) \
+	X(burnStartsDHW_ul, UBA_Monitor_DHW, 17) \
+	X(burnWorkMinDHW_ul, UBA_Monitor_DHW, 14)
+
+
+/**
+ * List of all the available Calduino Data of type Bit: X(request, EMS Datagram ID, offset, bit
+ * offset).
+ */
+
+#define CALDUINO_BIT_REQUESTS(X) \
+	X(burnGas_t, UBA_Monitor_Fast, 11, 0) \
+	X(fanWork_t, UBA_Monitor_Fast, 11, 2) \
+	X(ignWork_t, UBA_Monitor_Fast, 11, 3) \
+	X(heatPmp_t, UBA_Monitor_Fast, 11, 5) \
+	X(threeWayValveDHW_t, UBA_Monitor_Fast, 11, 6) \
+	X(circDHW_t, UBA_Monitor_Fast, 11, 7) \
+	X(dayModeDHW_t, UBA_Monitor_DHW, 9, 0) \
+	X(oneTimeDHW_t, UBA_Monitor_DHW, 9, 1) \
+	X(desDHW_t, UBA_Monitor_DHW, 9, 2) \
+	X(prepareDHW_t, UBA_Monitor_DHW, 9, 3) \
+	X(holiModHC1_t, Monitor_HC_1, 4, 5) \
+	X(summerModHC1_t, Monitor_HC_1, 5, 0) \
+	X(dayModHC1_t, Monitor_HC_1, 5, 1) \
+	X(pauseModHC1_t, Monitor_HC_1, 5, 7) \
+	X(holiModHC2_t, Monitor_HC_2, 4, 5) \
+	X(summerModHC2_t, Monitor_HC_2, 5, 0) \
+	X(dayModHC2_t, Monitor_HC_2, 5, 1) \
+	X(pauseModHC2_t, Monitor_HC_2, 5, 7) \
+	X(holiModHC3_t, Monitor_HC_3, 4, 5) \
+	X(summerModHC3_t, Monitor_HC_3, 5, 0) \
+	X(dayModHC3_t, Monitor_HC_3, 5, 1) \
+	X(pauseModHC3_t, Monitor_HC_3, 5, 7) \
+	X(holiModHC4_t, Monitor_HC_4, 4, 5) \
+	X(summerModHC4_t, Monitor_HC_4, 5, 0) \
+	X(dayModHC4_t, Monitor_HC_4, 5, 1) \
+	X(pauseModHC4_t, Monitor_HC_4, 5, 7)
+
+
+/** Expands a request of the lists above to its enumerator. */
+
+#define CALDUINO_REQUEST_ENUM(request, ...) request,
+
+
+/**
+ * Enumeration containing all the available Calduino Data of type Byte. It matches byteRequests
+ * array.
+ */
+
+ enum ByteRequest {
+	CALDUINO_BYTE_REQUESTS(CALDUINO_REQUEST_ENUM)
+};
+
+
+/**
+ * Enumeration containing all the available Calduino Data of type Float. It matches floatRequests
+ * array.
+ */
+
+ enum FloatRequest {
+	CALDUINO_FLOAT_REQUESTS(CALDUINO_REQUEST_ENUM)
+};
+
+
+/**
+ * Enumeration containing all the available Calduino Data of type ULong. It matches uLongRequests
+ * array.
+ */
+
+ enum ULongRequest {
+	CALDUINO_ULONG_REQUESTS(CALDUINO_REQUEST_ENUM)
+};
+
+
+/**
+ * Enumeration containing all the available Calduino Data of type Bit. It matches bitRequests
+ * array.
+ */
+
+ enum BitRequest {
+	CALDUINO_BIT_REQUESTS(CALDUINO_REQUEST_ENUM)
+};
+
+
+/**
+ * Typed accessors of the Calduino Data, used with Calduino::get (e.g.
+ * calduino.get<CalduinoField::curImpTemp_f>()). Each field is a type with the EMS Datagram,
+ * offset, length and decoding of its Calduino Data as compile-time constants, so the getter does
+ * not read any descriptor of the Calduino Data from program memory and the fields not used leave
+ * no code behind.
+ */
+
+#define CALDUINO_BYTE_FIELD(request, eMSDatagramID, dataOffset) \
+	struct request { \
+		typedef byte Type; \
+		enum { datagram = EMSDatagramID::eMSDatagramID, offset = dataOffset, length = 1 }; \
+		static Type decode(const byte *inEMSBuffer) { return decodeEMSByte(inEMSBuffer, offset); } \
+		static Type errorValue() { return ERROR_VALUE; } \
+	};
+
+#ifdef CALDUINO_FLOAT
+#define CALDUINO_FLOAT_FIELD(request, eMSDatagramID, dataOffset, floatBytes, floatFactor) \
+	struct request { \
+		typedef float Type; \
+		enum { datagram = EMSDatagramID::eMSDatagramID, offset = dataOffset, length = floatBytes }; \
+		static Type decode(const byte *inEMSBuffer) { return decodeEMSFloat(inEMSBuffer, offset, floatBytes, floatFactor); } \
+		static int16_t decodeFixed(const byte *inEMSBuffer) { return decodeEMSFixed(inEMSBuffer, offset, floatBytes, floatFactor); } \
+		static Type errorValue() { return NAN; } \
+	};
+#else
+#define CALDUINO_FLOAT_FIELD(request, eMSDatagramID, dataOffset, floatBytes, floatFactor) \
+	struct request { \
+		typedef int16_t Type; \
+		enum { datagram = EMSDatagramID::eMSDatagramID, offset = dataOffset, length = floatBytes }; \
+		static Type decode(const byte *inEMSBuffer) { return decodeEMSFixed(inEMSBuffer, offset, floatBytes, floatFactor); } \
+		static int16_t decodeFixed(const byte *inEMSBuffer) { return decode(inEMSBuffer); } \
+		static Type errorValue() { return FIXED_ERROR_VALUE; } \
+	};
+#endif
+
+#define CALDUINO_ULONG_FIELD(request, eMSDatagramID, dataOffset) \
+	struct request { \
+		typedef unsigned long Type; \
+		enum { datagram = EMSDatagramID::eMSDatagramID, offset = dataOffset, length = 3 }; \
+		static Type decode(const byte *inEMSBuffer) { return decodeEMSULong(inEMSBuffer, offset); } \
+		static Type errorValue() { return ERROR_VALUE; } \
+	};
+
+#define CALDUINO_BIT_FIELD(request, eMSDatagramID, dataOffset, bitOffset) \
+	struct request { \
+		typedef boolean Type; \
+		enum { datagram = EMSDatagramID::eMSDatagramID, offset = dataOffset, length = 1 }; \
+		static Type decode(const byte *inEMSBuffer) { return decodeEMSBit(inEMSBuffer, offset, bitOffset); } \
+		static Type errorValue() { return false; } \
+	};
+
+namespace CalduinoField {
+	CALDUINO_BYTE_REQUESTS(CALDUINO_BYTE_FIELD)
+	CALDUINO_FLOAT_REQUESTS(CALDUINO_FLOAT_FIELD)
+	CALDUINO_ULONG_REQUESTS(CALDUINO_ULONG_FIELD)
+	CALDUINO_BIT_REQUESTS(CALDUINO_BIT_FIELD)
+}
+
+
+/**
+ * Calduino Data of the EMS Datagrams that can be decoded whole in a struct: X(name, label, encode
+ * type, unit, offset, bit offset, float bytes, float factor). They generate both the Calduino
+ * Data arrays used by printEMSDatagram and the structs filled by readUBAMonitorFast,
+ * readUBAMonitorSlow, readWorkingModeHC and readMonitorHC, so the two cannot drift.
+ */
+
+#define UBA_MONITOR_FAST_VALUES(X) \
+	X(selImpTemp, "SelImpTemp", Byte, Celsius, 4, 0, 0, 0) \
+	X(curImpTemp, "CurImpTemp", Float, Celsius, 5, 0, 2, 10) \
+	X(selBurnPow, "SelBurnPow", Byte, Percentage, 7, 0, 0, 0) \
+	X(curBurnPow, "CurBurnPow", Byte, Percentage, 8, 0, 0, 0) \
+	X(burnGas, "BurnGas", Bit, YesNo, 11, 0, 0, 0) \
+	X(fanWork, "FanWork", Bit, YesNo, 11, 2, 0, 0) \
+	X(ignWork, "IgnWork", Bit, YesNo, 11, 3, 0, 0) \
+	X(heatPmp, "HeatPmp", Bit, YesNo, 11, 5, 0, 0) \
+	X(threeWayValveDHW, "Way3ValveDHW", Bit, YesNo, 11, 6, 0, 0) \
+	X(circDHW, "CircDHW", Bit, YesNo, 11, 7, 0, 0) \
+	X(retTemp, "RetTemp", Float, Celsius, 17, 0, 2, 10) \
+	X(flameCurr, "FlameCurr", Float, MAmper, 19, 0, 2, 10) \
+	X(sysPress, "SysPress", Float, Bar, 21, 0, 1, 10) \
+	X(srvCode1, "SrvCode1", Byte, None, 22, 0, 0, 0) \
+	X(srvCode2, "SrvCode2", Byte, None, 23, 0, 0, 0) \
+	X(errCode, "ErrCode", UInt, None, 24, 0, 0, 0)
+
+
+#define UBA_MONITOR_SLOW_VALUES(X) \
+	X(extTemp, "ExtTemp", Float, Celsius, 4, 0, 2, 10) \
+	X(boilTemp, "BoilTemp", Float, Celsius, 6, 0, 2, 10) \
+	X(pumpMod, "PumpMod", Byte, Percentage, 13, 0, 0, 0) \
+	X(burnStarts, "BurnStarts", ULong, Times, 14, 0, 0, 0) \
+	X(burnWorkMin, "BurnWorkMin", ULong, Minute, 17, 0, 0, 0) \
+	X(burnWorkMinH, "BurnWorkMinH", ULong, Minute, 23, 0, 0, 0)
+
+
+#define WORKING_MODE_HC_VALUES(X) \
+	X(selNightTempHC, "SelNightTempHC", Float, Celsius, 5, 0, 1, 2) \
+	X(selDayTempHC, "SelDayTempHC", Float, Celsius, 6, 0, 1, 2) \
+	X(selHoliTempHC, "SelHoliTempHC", Float, Celsius, 7, 0, 1, 2) \
+	X(roomTempInfHC, "RoomTempInfHC", Float, Celsius, 8, 0, 1, 2) \
+	X(roomTempOffHC, "RoomTempOffHC", Float, Celsius, 10, 0, 1, 2) \
+	X(workModeHC, "WorkModeHC", Byte, None, 11, 0, 0, 0) \
+	X(sWThresTempHC, "SWThresTempHC", Byte, Celsius, 26, 0, 0, 0) \
+	X(nightSetbackHC, "NightSetbackHC", Byte, None, 29, 0, 0, 0) \
+	X(nightOutTempHC, "NightOutTempHC", Float, Celsius, 43, 0, 1, 1)
+
+
+#define MONITOR_HC_VALUES(X) \
+	X(holiModHC, "HoliModHC", Bit, YesNo, 4, 5, 0, 0) \
+	X(summerModHC, "SummerModHC", Bit, YesNo, 5, 0, 0, 0) \
+	X(dayModHC, "DayModHC", Bit, YesNo, 5, 1, 0, 0) \
+	X(pauseModHC, "PauseModHC", Bit, YesNo, 5, 7, 0, 0) \
+	X(selRoomTempHC, "SelRoomTempHC", Float, Celsius, 6, 0, 1, 2)
+
+
+/** Types of the struct members of each encode type. Float values are in fixed point (tenths). */
+typedef byte CalduinoByteMember;
+typedef boolean CalduinoBitMember;
+typedef int16_t CalduinoFloatMember;
+typedef unsigned long CalduinoULongMember;
+typedef uint16_t CalduinoUIntMember;
+
+#define CALDUINO_DATA_MEMBER(name, label, encodeType, ...) Calduino##encodeType##Member name;
+#define CALDUINO_DATA_COUNT(...) + 1
+
+struct UBAMonitorFast {
+	UBA_MONITOR_FAST_VALUES(CALDUINO_DATA_MEMBER)
+};
+
+struct UBAMonitorSlow {
+	UBA_MONITOR_SLOW_VALUES(CALDUINO_DATA_MEMBER)
+};
+
+struct WorkingModeHC {
+	WORKING_MODE_HC_VALUES(CALDUINO_DATA_MEMBER)
+};
+
+struct MonitorHC {
+	MONITOR_HC_VALUES(CALDUINO_DATA_MEMBER)
+};
+
+
+/**
+ * Calduino Value Request struct definition. It identifies a Calduino Data to be read in a batch.
+ * - Encode Type of the Calduino Data requested (Byte, Bit, Float, Fixed or ULong). Fixed gets a
+ * FloatRequest in fixed point (tenths).
+ * - Index is the ByteRequest, BitRequest, FloatRequest or ULongRequest of the Calduino Data,
+ * depending on the encode type.
+ */
+
+struct CalduinoValueRequest {
+	CalduinoEncodeType encodeType;
+	byte index;
+};
+
+
+/**
+ * Calduino Value union definition. It contains the value obtained for a Calduino Value Request,
+ * in the member corresponding to its encode type.
+ */
+
+union CalduinoValue {
+	byte byteValue;
+	boolean bitValue;
+	int16_t fixedValue;
+#ifdef CALDUINO_FLOAT
+	float floatValue;
+#endif
+	unsigned long uLongValue;
+};
+
+/**
+ * EMS Datagram struct definition. Each datagram contains:
+ * - Name in Flash string (for printing/debugging).  
+ * - MessageID.  
+ * - DeviceID.  
+ * - MessageLength is the length in bytes of the EMS Message.
+ * - DataSize contain the number of Calduino Data that this Datagram contains. It will match the
+ * array size of data.
+ * - Data is an array in PROGMEM containing the Data included in this Datagram.
+ */
+
+struct EMSDatagram {
+	prog_char* messageName;
+	MessageID messageID;
+	DeviceID destinationID;
+	byte messageLength;
+	byte dataSize;
+	const PROGMEM CalduinoData* data;
+};
+
+/** Array with all the EMS Datagrams, referenced by EMSDatagramID enumeration. */
+extern EMSDatagram* eMSDatagramIDs[];
+
+/** Tag of the operation status printed when an EMS Datagram fails. */
+extern prog_char returnTag[];
+
+
+
+/**
+ * EMS Cache slot struct definition. Each slot keeps a snapshot of a whole EMS Datagram:
+ * - EMS Datagram ID cached in the slot (ERROR_VALUE if the slot is free).
+ * - Valid is whether the buffer contains a snapshot of the EMS Datagram.
+ * - TTL is the time in milliseconds while the snapshot is considered fresh.
+ * - Timestamp is the time in milliseconds when the snapshot was refreshed.
+ * - Buffer contains the EMS Datagram bytes, in the same positions than an EMS Buffer. Only
+ * EMS Datagrams whose message (plus headers) fits in EMS_CACHE_BUFFER_SIZE can be cached.
+ */
+
+struct EMSCacheSlot {
+	byte eMSDatagramID;
+	boolean valid;
+	unsigned long ttl;
+	unsigned long timestamp;
+	byte buffer[EMS_CACHE_BUFFER_SIZE];
+};
+
+/**
+ * EMS Report slot struct definition. Each slot keeps the values last reported of an EMS
+ * Datagram printed in delta mode:
+ * - EMS Datagram ID reported in delta mode (ERROR_VALUE if the slot is free).
+ * - Valid is whether the buffer contains the values reported.
+ * - Refresh Cycles is the number of reports between two full reports.
+ * - Cycles is the number of reports since the last full report.
+ * - Buffer contains the values last reported, in the same positions than an EMS Buffer. Only
+ * EMS Datagrams whose message (plus headers) fits in EMS_CACHE_BUFFER_SIZE can be reported in
+ * delta mode.
+ */
+
+struct EMSReportSlot {
+	byte eMSDatagramID;
+	boolean valid;
+	byte refreshCycles;
+	byte cycles;
+	byte buffer[EMS_CACHE_BUFFER_SIZE];
+};
+
+typedef const PROGMEM CalduinoData Prog_CalduinoDataType;
+typedef const PROGMEM EMSDatagram Prog_EMSDatagram;
+#pragma endregion EMSDatagram
+
+/* CalduinoDebug declaration */
+#pragma region CalduinoDebug
+
+class CalduinoDebug : public Stream {
+private:
+	Stream *debugSerial;
+
+public:
+	CalduinoDebug();
+	void begin(Stream *_debugSerial);
+
+	virtual size_t write(uint8_t byte);
+	virtual int read() { return debugSerial->read(); }
+	virtual int available() { return debugSerial->available(); }
+	virtual void flush() { return debugSerial->flush(); }
+	virtual int peek() { return debugSerial->peek(); }
+
+	using Print::write;
+};
+
+#pragma endregion CalduinoDebug
+
+/* CalduinoSerializer declaration */
+#pragma region CalduinoSerializer
+
+#define SERIALIZER_DEPTH 4
+#define TELEMETRY_HEADER_SIZE 2
+#define TELEMETRY_BITMAP_SIZE(dataSize) (((dataSize) + 7) / 8)
+
+/**
+ * Calduino Serializer. It writes the EMS Datagrams and any other value directly to a Print sink
+ * in the active print format, token by token and without intermediate text buffers. Objects
+ * can be nested (up to SERIALIZER_DEPTH levels) so several EMS Datagrams are sent as a single
+ * document (e.g. a JSON object with one member per EMS Datagram). The print format is read
+ * when the outermost object begins, so it does not change in the middle of a document.
+ *
+ * In Binary format each EMS Datagram is a telemetry record, and objects and other values are
+ * not printed. A record contains:
+ * - EMS Datagram ID.  
+ * - Payload length, the number of bytes that follow.  
+ * - Bitmap of the Calduino Data present (TELEMETRY_BITMAP_SIZE bytes, bit i is the Calduino
+ * Data i of the EMS Datagram). A failed EMS Datagram has no payload at all.  
+ * - Values of the present Calduino Data in descriptor order: Byte as is, Float as its signed EMS
+ * value (before the float factor) in zigzag varint, ULong as varint and Switch Point as its two
+ * EMS bytes. Bits present up to the next value of another type are packed in bytes of 8 (first
+ * one in the least significant bit).
+ *
+ * The records are decoded with the same tables by CalduinoTelemetry.
+ */
+
+class CalduinoSerializer {
+private:
+	Print *out;
+	PrintFormat *printFormat;
+	PrintFormat format;
+	byte depth;
+	boolean firstMember;
+	const __FlashStringHelper *names[SERIALIZER_DEPTH];
+
+	void printKey(const __FlashStringHelper *name, byte index = ERROR_VALUE);
+	void printEnd(const __FlashStringHelper *name, const __FlashStringHelper *unit);
+	void printFixed(int16_t value);
+	byte printRecordByte(byte value, boolean write);
+	byte printVarint(unsigned long value, boolean write);
+	byte printRecordValues(EMSDatagram *eMSDatagram, byte *inEMSBuffer, const byte *present, boolean write);
+
+public:
+	CalduinoSerializer();
+	void begin(Print *_out, PrintFormat *_printFormat);
+
+	void beginObject(const __FlashStringHelper *name);
+	void endObject();
+	void printData(CalduinoData *calduinoData, byte *inEMSBuffer);
+	void printValue(const __FlashStringHelper *name, long value, const __FlashStringHelper *unit = NULL);
+	void printValue(const __FlashStringHelper *name, const char *value);
+	void printRecord(byte eMSDatagramID, EMSDatagram *eMSDatagram, byte *inEMSBuffer, const byte *present);
+	boolean isBinary() { return ((depth == 0) ? *printFormat : format) == PrintFormat::Binary; }
+	byte getDepth() { return depth; }
+};
+
+#pragma endregion CalduinoSerializer
+
+/* CalduinoSerial declaration */
+#pragma region CalduinoSerial
+
+class CalduinoSerial {
+private:
+	EMSSerial * calduinoSerial;
+
+public:
+	CalduinoSerial();
+	void begin(EMSSerial *_calduinoSerial);
+
+	virtual size_t write(uint8_t byte) { return calduinoSerial->write(byte); }
+	virtual int read() { return calduinoSerial->read(); }
+	virtual int available() { return calduinoSerial->available(); }
+	virtual void flush() { return calduinoSerial->flush(); }
+	virtual int peek() { return calduinoSerial->peek(); }
+	virtual void writeEOF() { return calduinoSerial->writeEOF(); }
+	virtual bool frameError() { return calduinoSerial->frameError(); }
+	virtual int frameAvailable() { return calduinoSerial->frameAvailable(); }
+	virtual int readFrame(byte *buffer, byte len, bool *crcOK = NULL) { return calduinoSerial->readFrame(buffer, len, crcOK); }
+	virtual bool writeFrame(byte *buffer, byte len) { return calduinoSerial->writeFrame(buffer, len); }
+	virtual bool txBusy() { return calduinoSerial->txBusy(); }
+	virtual bool collision() { return calduinoSerial->collision(); }
+	virtual uint16_t rxOverflows() { return calduinoSerial->rxOverflows(); }
+	virtual unsigned long getMillis() { return millis(); }
+};
+
+#pragma endregion CalduinoSerial
+
+/* Calduino declaration */
+#pragma region Calduino
+
+/**
+ * Transaction Status enumeration.
+ * - Free slot, or the handle does not correspond to any transaction.
+ * - Pending in the queue, waiting for the EMS Bus.
+ * - Running on the EMS Bus.
+ * - Succeeded or Failed, once the transaction has finished.
+ */
+
+enum TransactionStatus {
+	Free,
+	Pending,
+	Running,
+	Succeeded,
+	Failed
+};
+
+
+/**
+ * Transaction Priority enumeration. The pending transactions are started by priority and, with
+ * the same priority, in order of submission.
+ * - User Write for the set commands, issued by the user.
+ * - Interactive Read for the get commands whose result is waited for (e.g. the getters).
+ * - Background Read for the periodic refresh of EMS Datagrams. Multi-chunk background reads
+ * yield the EMS Bus between chunks to the transactions of higher priority, and do not take the
+ * last free transaction slot.
+ */
+
+enum TransactionPriority {
+	UserWrite,
+	InteractiveRead,
+	BackgroundRead
+};
+
+
+/**
+ * Callback invoked by poll() when a submitted transaction finishes. It receives the handle of
+ * the transaction, whether it succeeded and the context passed to submit().
+ */
+
+typedef void(*CalduinoCallback)(byte handle, boolean success, void *context);
+
+
+/**
+ * Calduino Transaction struct definition. It contains the state of a get (read) or set (write
+ * and read back) EMS Command executed asynchronously by poll().
+ * - Write is true for set commands. Verifying is true once the set command has been acknowledged
+ * and its value is being read back.
+ * - WaitingReply is true once the EMS Command has been sent, otherwise the transaction is waiting
+ * to be polled by the Bus Master. Probe is true if the EMS Command probes the half open breaker
+ * of its EMS device.
+ * - Offset and Length are the bytes of the EMS Message to be read or written. Data contains the
+ * bytes to be written (up to MAX_EMS_WRITE contiguous bytes).
+ * - Missing Chunks is the bitmap of the chunks not received yet. Reads longer than the maximum
+ * bytes of a reply are split in chunks, each of them requested until it is received.
+ * - Deadline is the time until which failed attempts of the current chunk are retried. Timeout is
+ * the end of the current step (waiting the poll or the reply) and Step Start its beginning.
+ * - Sequence keeps the order of submission and Priority the class of the transaction.
+ * - EMS Datagram ID is the EMS Datagram whose stats are updated (ERROR_VALUE if unknown).
+ */
+
+struct CalduinoTransaction {
+	TransactionStatus status;
+	boolean write;
+	boolean verifying;
+	boolean waitingReply;
+	boolean probe;
+	byte destinationID;
+	byte messageID;
+	byte offset;
+	byte length;
+	uint16_t missingChunks;
+	byte data[MAX_EMS_WRITE];
+	byte *inEMSBuffer;
+	unsigned long retryTime;
+	unsigned long deadline;
+	unsigned long timeout;
+	unsigned long stepStart;
+	unsigned long sequence;
+	TransactionPriority priority;
+	byte eMSDatagramID;
+	CalduinoCallback callback;
+	void *context;
+};
+
+
+/**
+ * EMS Datagram Stats struct definition. Counters of the transactions of an EMS Datagram.
+ * - Requests is the number of transactions submitted and Successes the ones that succeeded.
+ * - CRC Errors are replies received with wrong CRC, Frame Errors replies that do not correspond
+ * with the EMS Command sent (wrong length, messageID or value read back).
+ * - Timeouts are polls or replies not received in time, Retries the attempts repeated.
+ * - Poll Wait Time is the total time in milliseconds waiting to be polled by the Bus Master.
+ */
+
+struct EMSDatagramStats {
+	uint16_t requests;
+	uint16_t successes;
+	uint16_t crcErrors;
+	uint16_t frameErrors;
+	uint16_t timeouts;
+	uint16_t retries;
+	unsigned long pollWaitTime;
+};
+
+
+/**
+ * Calduino Stats struct definition. It contains the stats of every EMS Datagram and of the EMS
+ * Bus.
+ * - RX Overflows are frames discarded by the EMS Serial (reception buffer or frame queue full).
+ * - Collisions are EMS Commands aborted because of an unexpected echo.
+ * - Preemptions are background reads that yielded the EMS Bus to transactions of higher priority.
+ * - Poll Wait and Response histograms count the times waiting to be polled and waiting for the
+ * reply. Bin i counts times lower than 4 * 2^i milliseconds (and not counted in the previous
+ * bins), the last bin counts all the longer times.
+ */
+
+struct CalduinoStats {
+	EMSDatagramStats datagrams[EMS_DATAGRAMS];
+	uint16_t rxOverflows;
+	uint16_t collisions;
+	uint16_t preemptions;
+	uint16_t pollWaitHistogram[STATS_HISTOGRAM_BINS];
+	uint16_t responseHistogram[STATS_HISTOGRAM_BINS];
+};
+
+
+/**
+ * Device Status enumeration.
+ * - Unknown until the EMS device is seen on the EMS Bus or queried by discoverDevices().
+ * - Present once a telegram sent by the EMS device has been received.
+ * - Absent if it did not answer the version query of discoverDevices(). The EMS Commands
+ * addressed to an absent EMS device fail immediately, until a telegram sent by it is received
+ * or it is discovered again.
+ */
+
+enum DeviceStatus {
+	Unknown,
+	Present,
+	Absent
+};
+
+
+/**
+ * Latency Estimator struct definition. Smoothed latency of a step of the transactions (waiting
+ * the poll or the reply) and its mean deviation, from which the timeout of the step is derived.
+ * - SRTT is the smoothed latency in milliseconds, scaled by 8 (0 until the first sample).
+ * - RTT Var is the smoothed mean deviation in milliseconds, scaled by 4.
+ * - Backoff is the number of consecutive timeouts of the step, each of them doubles the timeout
+ * until the next sample.
+ */
+
+struct LatencyEstimator {
+	uint16_t srtt;
+	uint16_t rttvar;
+	byte backoff;
+};
+
+
+/**
+ * Breaker State enumeration of the circuit breaker of an EMS device.
+ * - Closed while the EMS device answers, the EMS Commands are sent as usual.
+ * - Open after BREAKER_FAILURES consecutive failed transactions, the EMS Commands fail
+ * immediately until the backoff expires.
+ * - Half Open while the first EMS Command after the backoff probes the EMS device with a single
+ * attempt. Its success closes the breaker, its failure opens it again with twice the backoff.
+ */
+
+enum BreakerState {
+	Closed,
+	Open,
+	HalfOpen
+};
+
+
+/**
+ * EMS Device struct definition. An entry of the inventory of the EMS devices on the EMS Bus:
+ * - Device ID of the EMS device.
+ * - Status is whether the EMS device is present on the EMS Bus.
+ * - Product ID, Version Major and Version Minor answered to the version query (ERROR_VALUE if
+ * not received yet).
+ * - Breaker is the state of its circuit breaker and Failures the number of consecutive failed
+ * transactions whose EMS Command was sent (reply lost or wrong).
+ * - Backoff is the time in milliseconds the breaker stays open, and Probe Time the time in
+ * milliseconds when the open breaker lets the next EMS Command probe the EMS device.
+ * - Latency is the estimator of the time the EMS device takes to answer the EMS Commands.
+ */
+
+struct EMSDevice {
+	byte deviceID;
+	DeviceStatus status;
+	byte productID;
+	byte versionMajor;
+	byte versionMinor;
+	BreakerState breaker;
+	byte failures;
+	unsigned long backoff;
+	unsigned long probeTime;
+	LatencyEstimator latency;
+};
+
+
+class Calduino {
+private:
+	uint8_t crcCalculator(byte *eMSBuffer, int len);
+	byte submitTransaction(boolean write, byte destinationID, byte messageID, byte offset, byte length, const byte *data, byte *inEMSBuffer, unsigned long retryTime, TransactionPriority priority, CalduinoCallback callback = NULL, void *context = NULL);
+	boolean waitTransaction(byte handle);
+	void waitPoll(CalduinoTransaction *transaction);
+	void sendTransactionCommand(CalduinoTransaction *transaction);
+	void processTransactionReply(CalduinoTransaction *transaction, byte *inEMSBuffer, int len, bool crcOK);
+	void retryTransaction(CalduinoTransaction *transaction);
+	EMSDatagramStats* getDatagramStats(CalduinoTransaction *transaction);
+	void finishTransaction(byte handle);
+	void startTransactions();
+	byte getRunningTransactions();
+	CalduinoTransaction* getPolledTransaction();
+	void refreshPollTimeouts(CalduinoTransaction *polled);
+	CalduinoTransaction* getReplyTransaction(byte *frame, int len, bool crcOK);
+	boolean getEMSBuffer(byte *inEMSBuffer, EMSDatagram eMSDatagram, byte length = 0, byte offset = 0);
+	boolean updateEMSDatagram(EMSDatagramID eMSDatagramID, DatagramDataIndex datagramDataIndex, byte data, byte extraOffset = 0);
+	boolean updateEMSDatagramBlock(EMSDatagramID eMSDatagramID, DatagramDataIndex datagramDataIndex, const byte *data, byte length, byte extraOffset = 0);
+	EMSCacheSlot* getCacheSlot(const EMSDatagram *pEMSDatagram);
+	boolean getCachedEMSBuffer(byte *inEMSBuffer, const EMSDatagram *pEMSDatagram, EMSDatagram eMSDatagram, byte length = 0, byte offset = 0);
+	boolean getFieldBuffer(byte *inEMSBuffer, EMSDatagramID eMSDatagramID, byte length, byte offset);
+	EMSReportSlot* getReportSlot(byte eMSDatagramID);
+#ifdef CALDUINO_REPORTS
+	boolean isDataChanged(CalduinoData *calduinoData, byte *reportedBuffer, byte *inEMSBuffer);
+#endif
+	void selectReportedData(byte eMSDatagramID, EMSDatagram *eMSDatagram, byte *inEMSBuffer, byte *present);
+	void storeTelegram(byte *telegram, int len);
+	EMSDevice* getDeviceSlot(byte deviceID);
+	void updateInventory(byte *telegram, int len);
+	boolean isDeviceAvailable(EMSDevice *device);
+	void updateBreaker(EMSDevice *device, boolean success);
+	LatencyEstimator* getReplyLatency(CalduinoTransaction *transaction);
+
+	unsigned long EMSMaxWaitTime;
+#ifdef CALDUINO_CACHE
+	EMSCacheSlot cache[EMS_CACHE_SLOTS];
+#endif
+#ifdef CALDUINO_REPORTS
+	EMSReportSlot reports[EMS_REPORT_SLOTS];
+	uint16_t deadbands[CALDUINO_UNITS];
+#endif
+	EMSDevice devices[EMS_DEVICES];
+	CalduinoTransaction transactions[CALDUINO_TRANSACTIONS];
+#ifdef CALDUINO_STATS
+	CalduinoStats stats;
+	uint16_t lastRxOverflows;
+#endif
+	LatencyEstimator pollLatency;
+	byte commandTransaction;
+	unsigned long transactionSequence;
+	CalduinoDebug debugSerial;
+	CalduinoSerial eMSSerial;
+	CalduinoSerial *calduinoSerial;
+
+public:
+	Calduino();
+
+	boolean begin(EMSSerial *_calduinoSerial, Stream *debugSerial = NULL);
+	boolean begin(CalduinoSerial *_calduinoSerial, Stream *debugSerial = NULL);
+
+	// Asynchronous EMS Transactions
+	byte submit(byte *inEMSBuffer, EMSDatagramID eMSDatagramID, CalduinoCallback callback = NULL, void *context = NULL, TransactionPriority priority = TransactionPriority::InteractiveRead);
+	byte submit(EMSDatagramID eMSDatagramID, DatagramDataIndex datagramDataIndex, byte data, CalduinoCallback callback = NULL, void *context = NULL);
+	void poll();
+	TransactionStatus getStatus(byte handle);
+
+#ifdef CALDUINO_STATS
+	// EMS Bus Stats
+	const CalduinoStats &getStats();
+	void resetStats();
+#endif
+
+	// EMS Datagram Cache
+	boolean setCacheTTL(EMSDatagramID eMSDatagramID, unsigned long ttl);
+	void invalidateCache();
+
+	// Delta Reporting
+	boolean setDeltaReport(EMSDatagramID eMSDatagramID, byte refreshCycles);
+	void setDeadband(CalduinoUnit unit, uint16_t deadband);
+	void resetDeltaReport();
+
+	// EMS Device Discovery
+	byte discoverDevices();
+	const EMSDevice *getDevice(DeviceID deviceID);
+
+	// Adaptive Timeouts
+	unsigned long getPollTimeout();
+	unsigned long getReplyTimeout(DeviceID deviceID);
+	void resetLatency();
+
+	// Get EMS Commands
+	boolean printEMSDatagram(EMSDatagramID eMSDatagramID, DatagramDataIndex datagramDataIndex = ERROR_VALUE);
+	boolean printEMSBuffer(EMSDatagramID eMSDatagramID, byte *inEMSBuffer, DatagramDataIndex datagramDataIndex = ERROR_VALUE);
+	byte getCalduinoByteValue(ByteRequest typeIdx);
+	int16_t getCalduinoFixedValue(FloatRequest typeIdx);
+#ifdef CALDUINO_FLOAT
+	float getCalduinoFloatValue(FloatRequest typeIdx);
+#endif
+	unsigned long getCalduinoUlongValue(ULongRequest typeIdx);
+	boolean getCalduinoBitValue(BitRequest typeIdx);
+	SwitchPoint getCalduinoSwitchPoint(EMSDatagramID selProgram, byte switchPointID);
+	boolean readProgram(EMSDatagramID selProgram, SwitchPoint *switchPoints);
+	boolean readValues(const CalduinoValueRequest *requests, byte count, CalduinoValue *results);
+	boolean readUBAMonitorFast(UBAMonitorFast *values);
+	boolean readUBAMonitorSlow(UBAMonitorSlow *values);
+	boolean readWorkingModeHC(byte selHC, WorkingModeHC *values);
+	boolean readMonitorHC(byte selHC, MonitorHC *values);
+
+	/**
+	 * Get a Calduino Data through its CalduinoField (e.g. get<CalduinoField::curImpTemp_f>()).
+	 * The buffer is big enough for a cached snapshot or for the bytes of the field.
+	 *
+	 * @return	The value of the Calduino Data requested, its error value otherwise.
+	 */
+
+	template<class Field> typename Field::Type get()
+	{
+		byte inEMSBuffer[(Field::offset + Field::length > EMS_CACHE_BUFFER_SIZE) ? Field::offset + Field::length : EMS_CACHE_BUFFER_SIZE];
+
+		if (!getFieldBuffer(inEMSBuffer, (EMSDatagramID)Field::datagram, Field::length, Field::offset))
+		{
+			return Field::errorValue();
+		}
+
+		return Field::decode(inEMSBuffer);
+	}
+
+	/**
+	 * Get a Calduino Data of type Float through its CalduinoField in fixed point (tenths).
+	 *
+	 * @return	The value of the Calduino Data requested, FIXED_ERROR_VALUE otherwise.
+	 */
+
+	template<class Field> int16_t getFixed()
+	{
+		byte inEMSBuffer[(Field::offset + Field::length > EMS_CACHE_BUFFER_SIZE) ? Field::offset + Field::length : EMS_CACHE_BUFFER_SIZE];
+
+		if (!getFieldBuffer(inEMSBuffer, (EMSDatagramID)Field::datagram, Field::length, Field::offset))
+		{
+			return FIXED_ERROR_VALUE;
+		}
+
+		return Field::decodeFixed(inEMSBuffer);
+	}
+
+	// Set EMS Commands
+	boolean setWorkModeHC(byte selHC, byte selMode);
+	boolean setTemperatureHC(byte selHC, byte selMode, byte selTmp);
+	boolean setProgramHC(byte selHC, byte selProgram);
+	boolean setSWThresholdTempHC(byte selHC, byte selTmp);
+	boolean setNightSetbackModeHC(byte selHC, byte selMode);
+	boolean setNightThresholdOutTempHC(byte selHC, int8_t selTmp);
+	boolean setRoomTempOffsetHC(byte selHC, int8_t selTmp);
+	boolean setPauseModeHC(byte selHC, byte duration);
+	boolean setPartyModeHC(byte selHC, byte duration);
+	boolean setHolidayModeHC(byte selHC, byte startHolidayDay, byte startHoldidayMonth, byte startHolidayYear, byte endHolidayDay, byte endHoldidayMonth, byte endHolidayYear);
+	boolean setHomeHolidayModeHC(byte selHC, byte startHomeHolidayDay, byte startHomeHoldidayMonth, byte startHomeHolidayYear, byte endHomeHolidayDay, byte endHomeHoldidayMonth, byte endHomeHolidayYear);
+	boolean setWorkModeDHW(byte selMode);
+	boolean setWorkModePumpDHW(byte selMode);
+	boolean setTemperatureDHW(byte selTmp);
+	boolean setTemperatureTDDHW(byte selTmp);
+	boolean setProgramDHW(byte selProgram);
+	boolean setProgramPumpDHW(byte selProgram);
+	boolean setOneTimeDHW(boolean selMode);
+	boolean setWorkModeTDDHW(byte selMode);
+	boolean setDayTDDHW(byte dayTherDisDHW);
+	boolean setHourTDDHW(byte hourTherDisDHW);
+	boolean setProgramSwitchPoint(EMSDatagramID selProgram, byte switchPointID, byte operationSwitchPoint, byte daySwitchPoint, byte hourSwitchPoint, byte minuteSwitchPoint);
+	boolean writeProgram(EMSDatagramID selProgram, const SwitchPoint *switchPoints);
+
+	PrintFormat printFormat;
+	boolean listenOnly;
+	byte pipelineDepth;
+	CalduinoSerializer serializer;
+};
+
+#pragma endregion Calduino
+
+#endif
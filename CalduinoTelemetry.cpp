@@ -0,0 +1,239 @@
+/*
+* Copyright (c) 2018 Daniel Macías Perea (dani.macias.perea@gmail.com)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+* Legal Notices
+* 'Bosch Group', 'Buderus', 'Nefit' and 'Worcester' are brands of Bosch Thermotechnology.
+* All other trademarks are the property of their respective owners.
+*/
+
+
+/**
+* @file CalduinoTelemetry.cpp
+*
+* @brief The decoder of the telemetry records definition.
+*/
+
+#include "CalduinoTelemetry.h"
+
+
+/**
+ * Get the length of the telemetry record at the beginning of record.
+ *
+ * @param [in]	record	- Bytes received, starting with a telemetry record.
+ * @param 	  	length	- Number of bytes received.
+ *
+ * @return	The length in bytes of the record, 0 if it is incomplete or its EMS Datagram ID is
+ * 			unknown.
+ */
+
+byte getTelemetryRecordLength(const byte *record, byte length)
+{
+	if ((length < TELEMETRY_HEADER_SIZE) || (record[0] >= EMS_DATAGRAMS)) return 0;
+
+	unsigned int recordLength = TELEMETRY_HEADER_SIZE + record[1];
+
+	return (recordLength <= length) ? recordLength : 0;
+}
+
+
+/**
+ * Read a varint of a telemetry record.
+ *
+ * @param [in]	  	record  	- The telemetry record.
+ * @param [in,out]	position	- Position of the varint, updated to the following byte.
+ * @param 		  	end	 		- Length of the record.
+ * @param [out]   	value   	- The value read.
+ *
+ * @return	True if it succeeds, false if the varint exceeds the record.
+ */
+
+static boolean readVarint(const byte *record, byte *position, byte end, unsigned long *value)
+{
+	*value = 0;
+
+	for (byte shift = 0; (*position < end) && (shift < 32); shift += 7)
+	{
+		byte data = record[(*position)++];
+		*value |= ((unsigned long)(data & 0x7F)) << shift;
+		if (!(data & 0x80)) return true;
+	}
+
+	return false;
+}
+
+
+/**
+ * Decode a telemetry record, placing the values of the Calduino Data present in an EMS Buffer
+ * at the same offsets of the EMS Datagram, so they can be decoded as if received from the EMS
+ * Bus (e.g. with CalduinoData or CalduinoField). The bytes of the Calduino Data not present are
+ * left to 0.
+ *
+ * @param [in] 	record	   	- Bytes received, starting with a telemetry record.
+ * @param 	   	length	   	- Number of bytes received.
+ * @param [out]	inEMSBuffer	- EMS Buffer of TELEMETRY_BUFFER_SIZE bytes.
+ *
+ * @return	The length in bytes of the record, 0 if it is incomplete or malformed.
+ */
+
+byte decodeTelemetryRecord(const byte *record, byte length, byte *inEMSBuffer)
+{
+	byte recordLength = getTelemetryRecordLength(record, length);
+	if (recordLength == 0) return 0;
+
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, eMSDatagramIDs[record[0]], sizeof(EMSDatagram));
+
+	memset(inEMSBuffer, 0, TELEMETRY_BUFFER_SIZE);
+	if (isTelemetryRecordFailed(record)) return recordLength;
+
+	byte position = TELEMETRY_HEADER_SIZE + TELEMETRY_BITMAP_SIZE(eMSDatagram.dataSize);
+	if (position > recordLength) return 0;
+
+	CalduinoData calduinoData;
+	byte bits = 0;
+	byte bitCount = 0;
+
+	for (byte i = 0; i < eMSDatagram.dataSize; i++)
+	{
+		if (!isTelemetryDataPresent(record, i)) continue;
+
+		memcpy_P(&calduinoData, &eMSDatagram.data[i], sizeof(CalduinoData));
+		byte offset = calduinoData.offset;
+
+		// consecutive bits are packed in one byte, a new one begins every 8 bits or after another type
+		if (calduinoData.encodeType == CalduinoEncodeType::Bit)
+		{
+			if (bitCount == 0)
+			{
+				if (position >= recordLength) return 0;
+				bits = record[position++];
+			}
+			bitWrite(inEMSBuffer[offset], calduinoData.bitOffset, bitRead(bits, bitCount));
+			bitCount = (bitCount + 1) % 8;
+			continue;
+		}
+
+		bitCount = 0;
+
+		switch (calduinoData.encodeType)
+		{
+			case CalduinoEncodeType::Byte:
+			{
+				if (position >= recordLength) return 0;
+				inEMSBuffer[offset] = record[position++];
+				break;
+			}
+			case CalduinoEncodeType::Float:
+			{
+				unsigned long zigzag;
+				if (!readVarint(record, &position, recordLength, &zigzag)) return 0;
+
+				// signed EMS value, before the float factor
+				uint16_t raw = (uint16_t)(zigzag >> 1) ^ (uint16_t)(-(int16_t)(zigzag & 1));
+				if (calduinoData.floatBytes == 2)
+				{
+					inEMSBuffer[offset] = highByte(raw);
+					inEMSBuffer[offset + 1] = lowByte(raw);
+				}
+				else
+				{
+					inEMSBuffer[offset] = lowByte(raw);
+				}
+				break;
+			}
+			case CalduinoEncodeType::ULong:
+			{
+				unsigned long value;
+				if (!readVarint(record, &position, recordLength, &value)) return 0;
+
+				inEMSBuffer[offset] = (byte)(value >> 16);
+				inEMSBuffer[offset + 1] = (byte)(value >> 8);
+				inEMSBuffer[offset + 2] = (byte)value;
+				break;
+			}
+			case CalduinoEncodeType::UInt:
+			{
+				unsigned long value;
+				if (!readVarint(record, &position, recordLength, &value)) return 0;
+
+				inEMSBuffer[offset] = (byte)(value >> 8);
+				inEMSBuffer[offset + 1] = (byte)value;
+				break;
+			}
+			case CalduinoEncodeType::SwithPoint:
+			{
+				if (position + 2 > recordLength) return 0;
+				inEMSBuffer[offset] = record[position++];
+				inEMSBuffer[offset + 1] = record[position++];
+				break;
+			}
+			case CalduinoEncodeType::Bit:
+			case CalduinoEncodeType::Fixed:
+			{
+				// bits are unpacked above, no Calduino Data is encoded as Fixed
+				break;
+			}
+		}
+	}
+
+	return recordLength;
+}
+
+
+/**
+ * Decode a telemetry record and print the Calduino Data present with their names, in the print
+ * format of the serializer (e.g. as a JSON object). A record without payload (the EMS Datagram
+ * failed) is printed with the Return tag, as printEMSDatagram does.
+ *
+ * @param [in]	  	record	  	- Bytes received, starting with a telemetry record.
+ * @param 		  	length	  	- Number of bytes received.
+ * @param [in,out]	serializer	- The serializer where the record is printed.
+ *
+ * @return	The length in bytes of the record, 0 if it is incomplete or malformed.
+ */
+
+byte printTelemetryRecord(const byte *record, byte length, CalduinoSerializer *serializer)
+{
+	byte inEMSBuffer[TELEMETRY_BUFFER_SIZE];
+
+	byte recordLength = decodeTelemetryRecord(record, length, inEMSBuffer);
+	if (recordLength == 0) return 0;
+
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, eMSDatagramIDs[record[0]], sizeof(EMSDatagram));
+
+	serializer->beginObject(FPSTR(eMSDatagram.messageName));
+
+	for (byte i = 0; i < eMSDatagram.dataSize; i++)
+	{
+		if (!isTelemetryDataPresent(record, i)) continue;
+
+		CalduinoData calduinoData;
+		memcpy_P(&calduinoData, &eMSDatagram.data[i], sizeof(CalduinoData));
+		serializer->printData(&calduinoData, inEMSBuffer);
+	}
+
+	if (isTelemetryRecordFailed(record)) serializer->printValue(FPSTR(returnTag), 0L);
+
+	serializer->endObject();
+
+	return recordLength;
+}
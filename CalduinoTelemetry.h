@@ -0,0 +1,79 @@
+/*
+* Copyright (c) 2018 Daniel Macías Perea (dani.macias.perea@gmail.com)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+* Legal Notices
+* 'Bosch Group', 'Buderus', 'Nefit' and 'Worcester' are brands of Bosch Thermotechnology.
+* All other trademarks are the property of their respective owners.
+*/
+
+
+/**
+* @file CalduinoTelemetry.h
+*
+* @brief Decoder of the telemetry records printed by Calduino in Binary print format. It uses
+* the EMS Datagram tables of Calduino, so it can run on the receiving side (e.g. on a PC with an
+* Arduino core shim providing Arduino.h) and turn the records back into named values.
+*/
+
+
+#ifndef CalduinoTelemetry_h
+#define CalduinoTelemetry_h
+
+#include <Arduino.h>
+#include "Calduino.h"
+
+/* EMS Buffer able to contain the largest EMS Datagram (Switching Program 1, 99 bytes) plus headers, CRC and break */
+#define TELEMETRY_BUFFER_SIZE 105
+
+
+/**
+ * Check whether the EMS Datagram of a telemetry record failed (the record has no payload).
+ *
+ * @param [in]	record	- The telemetry record.
+ *
+ * @return	True if the EMS Datagram failed, false otherwise.
+ */
+
+inline boolean isTelemetryRecordFailed(const byte *record)
+{
+	return record[1] == 0;
+}
+
+
+/**
+ * Check whether a Calduino Data is present in a telemetry record.
+ *
+ * @param [in]	record	- The telemetry record.
+ * @param 	  	index 	- Index of the Calduino Data in the EMS Datagram of the record.
+ *
+ * @return	True if the record contains the value of the Calduino Data, false otherwise.
+ */
+
+inline boolean isTelemetryDataPresent(const byte *record, byte index)
+{
+	return !isTelemetryRecordFailed(record) && bitRead(record[TELEMETRY_HEADER_SIZE + index / 8], index % 8);
+}
+
+byte getTelemetryRecordLength(const byte *record, byte length);
+byte decodeTelemetryRecord(const byte *record, byte length, byte *inEMSBuffer);
+byte printTelemetryRecord(const byte *record, byte length, CalduinoSerializer *serializer);
+
+#endif
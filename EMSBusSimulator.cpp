@@ -0,0 +1,565 @@
+/*
+* Copyright (c) 2018 Daniel Macías Perea (dani.macias.perea@gmail.com)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+* Legal Notices
+* 'Bosch Group', 'Buderus', 'Nefit' and 'Worcester' are brands of Bosch Thermotechnology.
+* All other trademarks are the property of their respective owners.
+*/
+
+/**
+* @file EMSBusSimulator.cpp
+*
+* @brief The EMSBusSimulator class declaration.
+*/
+
+#include "EMSBusSimulator.h"
+
+/**
+ * Default constructor. The simulated EMS Bus starts without faults, with the Bus Master polling
+ * Calduino every SIMULATOR_POLL_INTERVAL milliseconds and the UBA and RC35 broadcasting their
+ * monitors and date time.
+ */
+
+EMSBusSimulator::EMSBusSimulator()
+{
+	crcErrorRate = 0;
+	pollDropRate = 0;
+	collisionRate = 0;
+	replyDropRate = 0;
+	slowDeviceID = ERROR_VALUE;
+	slowDeviceDelay = 0;
+	absentDeviceID = ERROR_VALUE;
+	foreignPollDeviceID = ERROR_VALUE;
+	pollInterval = SIMULATOR_POLL_INTERVAL;
+	replyDelay = SIMULATOR_REPLY_DELAY;
+
+	setBroadcast(0, EMSDatagramID::UBA_Monitor_Fast, 10000);
+	setBroadcast(1, EMSDatagramID::UBA_Monitor_Slow, 60000);
+	setBroadcast(2, EMSDatagramID::RC_Datetime, 60000);
+
+	begin();
+}
+
+
+/**
+ * Reset the simulated EMS Bus: virtual clock, frames on the EMS Bus, counters and the memory of
+ * the EMS devices (filled with a deterministic pattern generated from the seed, except the
+ * switching programs, which are valid). The fault injection and timing parameters are kept.
+ *
+ * @param [in]	seed	Seed of the pseudo-random generator used for memory and faults.
+ */
+
+void EMSBusSimulator::begin(unsigned long seed)
+{
+	EMSDatagram eMSDatagram;
+	unsigned int offset = 0;
+
+	now = 0;
+	nextPoll = pollInterval;
+	randomSeed = seed;
+	pendingCollision = false;
+	overflows = 0;
+	polls = 0;
+	commands = 0;
+	telegrams = 0;
+	busBytes = 0;
+
+	for (byte i = 0; i < SIMULATOR_FRAMES; i++)
+	{
+		frames[i].length = 0;
+	}
+
+	for (byte i = 0; i < SIMULATOR_BROADCASTS; i++)
+	{
+		broadcasts[i].next = broadcasts[i].period;
+	}
+
+	// place the messages of every EMS Datagram consecutively in the memory
+	for (byte i = 0; i < EMS_DATAGRAMS; i++)
+	{
+		memcpy_P(&eMSDatagram, eMSDatagramIDs[i], sizeof(EMSDatagram));
+
+		if (offset + eMSDatagram.messageLength <= SIMULATOR_MEMORY_SIZE)
+		{
+			memoryOffset[i] = offset;
+			offset += eMSDatagram.messageLength;
+		}
+		else
+		{
+			memoryOffset[i] = SIMULATOR_MEMORY_SIZE;
+		}
+	}
+
+	for (unsigned int i = 0; i < SIMULATOR_MEMORY_SIZE; i++)
+	{
+		memory[i] = simulatorRandom();
+	}
+
+	// switching programs are valid: day from 6:00 to 22:00 every day of the week, the rest of
+	// switch points undefined
+	for (byte i = 0; i < EMS_DATAGRAMS; i++)
+	{
+		CalduinoData calduinoData;
+		memcpy_P(&eMSDatagram, eMSDatagramIDs[i], sizeof(EMSDatagram));
+		memcpy_P(&calduinoData, eMSDatagram.data, sizeof(CalduinoData));
+
+		if ((calduinoData.encodeType != CalduinoEncodeType::SwithPoint) || (getMessage((EMSDatagramID)i) == NULL)) continue;
+
+		byte *program = getMessage((EMSDatagramID)i);
+		for (byte j = 0; j < SWITCHING_POINTS; j++)
+		{
+			if (j < 14)
+			{
+				program[j * 2] = ((j / 2) << 5) | ((j % 2) == 0 ? 1 : 0);
+				program[j * 2 + 1] = ((j % 2) == 0 ? 6 : 22) * 6;
+			}
+			else
+			{
+				program[j * 2] = 0xE7;
+				program[j * 2 + 1] = 0x90;
+			}
+		}
+	}
+}
+
+
+/**
+ * Get the memory that an EMS device keeps for one of its EMS Datagrams, to read or preset the
+ * values it answers with.
+ *
+ * @param [in]	eMSDatagramID	The EMS Datagram ID.
+ *
+ * @return	Pointer to the first byte of the message, or NULL if it does not fit in the memory.
+ */
+
+byte *EMSBusSimulator::getMessage(EMSDatagramID eMSDatagramID)
+{
+	if ((eMSDatagramID >= EMS_DATAGRAMS) || (memoryOffset[eMSDatagramID] == SIMULATOR_MEMORY_SIZE))
+	{
+		return NULL;
+	}
+
+	return &memory[memoryOffset[eMSDatagramID]];
+}
+
+
+/**
+ * Configure a telegram periodically broadcast by its EMS device.
+ *
+ * @param [in]	broadcast		Index of the broadcast (0 to SIMULATOR_BROADCASTS - 1).
+ * @param [in]	eMSDatagramID	The EMS Datagram ID broadcast.
+ * @param [in]	period			Period in milliseconds between broadcasts (0 disables it).
+ */
+
+void EMSBusSimulator::setBroadcast(byte broadcast, EMSDatagramID eMSDatagramID, unsigned long period)
+{
+	if (broadcast >= SIMULATOR_BROADCASTS) return;
+
+	broadcasts[broadcast].eMSDatagramID = eMSDatagramID;
+	broadcasts[broadcast].period = period;
+	broadcasts[broadcast].next = now + period;
+}
+
+
+/**
+ * Advance the virtual clock, generating the polls and broadcasts of the period.
+ *
+ * @param [in]	ms	Milliseconds to advance.
+ */
+
+void EMSBusSimulator::advance(unsigned long ms)
+{
+	now += ms;
+	update();
+}
+
+
+/**
+ * Get the number of frames already received by Calduino. If there is none, the virtual clock is
+ * advanced one millisecond, as the time passed in a real busy wait.
+ *
+ * @return	Number of frames available.
+ */
+
+int EMSBusSimulator::frameAvailable()
+{
+	int available = 0;
+
+	update();
+
+	for (byte i = 0; i < SIMULATOR_FRAMES; i++)
+	{
+		if ((frames[i].length > 0) && ((long)(now - frames[i].time) >= 0)) available++;
+	}
+
+	if (available == 0) now++;
+
+	return available;
+}
+
+
+/**
+ * Read the oldest frame received by Calduino, in the same format as EMSSerial (with CRC and
+ * break).
+ *
+ * @param [out]	buffer	Buffer to store the frame.
+ * @param [in]	len		Size of the buffer.
+ * @param [out]	crcOK	Whether the CRC of the frame is correct (optional).
+ *
+ * @return	Number of bytes read (0 if there is no frame available).
+ */
+
+int EMSBusSimulator::readFrame(byte *buffer, byte len, bool *crcOK)
+{
+	SimulatorFrame *frame = nextFrame();
+	byte ptr;
+
+	if (frame == NULL) return 0;
+
+	for (ptr = 0; (ptr < frame->length) && (ptr < len); ptr++)
+	{
+		buffer[ptr] = frame->data[ptr];
+	}
+
+	if (crcOK != NULL)
+	{
+		uint8_t crc = 0;
+		for (byte i = 0; (frame->length > 2) && (i < frame->length - 2); i++)
+		{
+			crc = crc_update(crc, frame->data[i]);
+		}
+		*crcOK = ((frame->length > 2) && (crc == frame->data[frame->length - 2]));
+	}
+
+	frame->length = 0;
+
+	return ptr;
+}
+
+
+/** Discard the frames already received by Calduino. */
+
+void EMSBusSimulator::flush()
+{
+	SimulatorFrame *frame;
+
+	while ((frame = nextFrame()) != NULL)
+	{
+		frame->length = 0;
+	}
+}
+
+
+/**
+ * Send an EMS Command to the simulated EMS Bus. The addressed EMS device answers it after the
+ * transmission of the command plus its reply delay: read commands with the bytes requested of
+ * its memory, write commands by storing the bytes and acknowledging them (0x01).
+ *
+ * @param [in]	buffer	The EMS Command (CRC and break included, the last byte is not sent).
+ * @param [in]	len		Length of the EMS Command.
+ *
+ * @return	Always true, the simulated EMS Bus is never busy.
+ */
+
+bool EMSBusSimulator::writeFrame(byte *buffer, byte len)
+{
+	unsigned long replyTime = now + (len * SIMULATOR_BYTE_TIME) + replyDelay;
+	byte deviceID = buffer[1] & 0x7F;
+	byte eMSDatagramID = findDatagram(deviceID, buffer[2]);
+
+	commands++;
+	busBytes += len;
+
+	// the Bus Master does not poll Calduino again until the EMS Command has been answered
+	if ((long)(replyTime + pollInterval - nextPoll) > 0) nextPoll = replyTime + pollInterval;
+
+	if ((collisionRate > 0) && (simulatorRandom() % 100 < collisionRate))
+	{
+		pendingCollision = true;
+		return true;
+	}
+
+	if ((len < 6) || (deviceID == absentDeviceID)) return true;
+
+	// the EMS device may not answer (e.g. the reply is lost on the EMS Bus)
+	if ((replyDropRate > 0) && (simulatorRandom() % 100 < replyDropRate)) return true;
+
+	if (deviceID == slowDeviceID) replyTime += slowDeviceDelay;
+
+	// version query, answered by the simulated EMS devices with their product ID and version
+	if ((buffer[1] & 0x80) && (buffer[2] == MessageID::Version_ID))
+	{
+		byte version[VERSION_MESSAGE_SIZE] = { getProductID(deviceID), SIMULATOR_VERSION_MAJOR, SIMULATOR_VERSION_MINOR };
+		byte offset = (buffer[3] > VERSION_MESSAGE_SIZE ? VERSION_MESSAGE_SIZE : buffer[3]);
+		byte length = (buffer[4] > VERSION_MESSAGE_SIZE - offset ? VERSION_MESSAGE_SIZE - offset : buffer[4]);
+
+		if (version[0] != ERROR_VALUE) sendFrame(deviceID, DeviceID::PC, MessageID::Version_ID, offset, &version[offset], length, replyTime);
+		return true;
+	}
+
+	if (eMSDatagramID == ERROR_VALUE) return true;
+
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, eMSDatagramIDs[eMSDatagramID], sizeof(EMSDatagram));
+	byte *message = getMessage((EMSDatagramID)eMSDatagramID);
+	byte offset = buffer[3];
+
+	if (buffer[1] & 0x80)
+	{
+		// read command, answer with the bytes available from the offset requested
+		byte length = buffer[4];
+		if (offset > eMSDatagram.messageLength) offset = eMSDatagram.messageLength;
+		if (length > eMSDatagram.messageLength - offset) length = eMSDatagram.messageLength - offset;
+		sendTelegram(eMSDatagramID, DeviceID::PC, offset, length, replyTime);
+	}
+	else
+	{
+		// write command, store the bytes inside the message and acknowledge them
+		for (byte i = 4; i < len - 2; i++)
+		{
+			if (offset + i - 4 < eMSDatagram.messageLength) message[offset + i - 4] = buffer[i];
+		}
+
+		byte ack[] = { 0x01, 0x00 };
+		scheduleFrame(ack, 2, replyTime + 2 * SIMULATOR_BYTE_TIME);
+		telegrams++;
+	}
+
+	return true;
+}
+
+
+/**
+ * Pseudo-random generator (linear congruential) used to fill the memory and inject faults, so
+ * a simulation is repeatable with the same seed.
+ *
+ * @return	Pseudo-random byte.
+ */
+
+byte EMSBusSimulator::simulatorRandom()
+{
+	randomSeed = randomSeed * 1103515245UL + 12345UL;
+	return (byte)(randomSeed >> 16);
+}
+
+
+/**
+ * Get the product ID answered to the version query by a simulated EMS device.
+ *
+ * @param [in]	deviceID	The EMS device ID.
+ *
+ * @return	The product ID, or ERROR_VALUE if the EMS device is not simulated.
+ */
+
+byte EMSBusSimulator::getProductID(byte deviceID)
+{
+	switch (deviceID)
+	{
+	case DeviceID::UBA: return SIMULATOR_PRODUCT_UBA;
+	case DeviceID::RC_35: return SIMULATOR_PRODUCT_RC_35;
+	case DeviceID::MM_10: return SIMULATOR_PRODUCT_MM_10;
+	default: return ERROR_VALUE;
+	}
+}
+
+
+/**
+ * Find the EMS Datagram answered by an EMS device.
+ *
+ * @param [in]	deviceID	The EMS device ID.
+ * @param [in]	messageID	The EMS Message ID.
+ *
+ * @return	The EMS Datagram ID, or ERROR_VALUE if the device does not answer the message.
+ */
+
+byte EMSBusSimulator::findDatagram(byte deviceID, byte messageID)
+{
+	EMSDatagram eMSDatagram;
+
+	for (byte i = 0; i < EMS_DATAGRAMS; i++)
+	{
+		memcpy_P(&eMSDatagram, eMSDatagramIDs[i], sizeof(EMSDatagram));
+
+		if ((eMSDatagram.destinationID == deviceID) && (eMSDatagram.messageID == messageID) && (memoryOffset[i] != SIMULATOR_MEMORY_SIZE))
+		{
+			return i;
+		}
+	}
+
+	return ERROR_VALUE;
+}
+
+
+/** Generate the polls of the Bus Master and the broadcasts of the EMS devices due until now. */
+
+void EMSBusSimulator::update()
+{
+	while ((long)(now - nextPoll) >= 0)
+	{
+		// the poll (Calduino address with the MSB set + break) may be lost
+		if ((pollDropRate == 0) || (simulatorRandom() % 100 >= pollDropRate))
+		{
+			byte poll[] = { DeviceID::PC | 0x80, 0x00 };
+			scheduleFrame(poll, 2, nextPoll);
+			polls++;
+		}
+
+		// the Bus Master also polls the other EMS devices, which have nothing to send
+		if (foreignPollDeviceID != ERROR_VALUE)
+		{
+			byte foreignPoll[] = { (byte)(foreignPollDeviceID | 0x80), 0x00 };
+			scheduleFrame(foreignPoll, 2, nextPoll + pollInterval / 2);
+		}
+		nextPoll += pollInterval;
+	}
+
+	for (byte i = 0; i < SIMULATOR_BROADCASTS; i++)
+	{
+		SimulatorBroadcast *broadcast = &broadcasts[i];
+
+		while ((broadcast->period > 0) && ((long)(now - broadcast->next) >= 0))
+		{
+			EMSDatagram eMSDatagram;
+			memcpy_P(&eMSDatagram, eMSDatagramIDs[broadcast->eMSDatagramID], sizeof(EMSDatagram));
+
+			if ((eMSDatagram.destinationID != absentDeviceID) && (getMessage((EMSDatagramID)broadcast->eMSDatagramID) != NULL))
+			{
+				sendTelegram(broadcast->eMSDatagramID, 0x00, 0, eMSDatagram.messageLength, broadcast->next);
+			}
+			broadcast->next += broadcast->period;
+		}
+	}
+}
+
+
+/**
+ * Place a frame on the simulated EMS Bus. If every entry is in use the frame is lost and
+ * counted as an overflow, as EMSSerial does when its frame queue is full.
+ *
+ * @param [in]	buffer	The frame (CRC and break included).
+ * @param [in]	len		Length of the frame.
+ * @param [in]	time	Time in milliseconds when the frame is received.
+ */
+
+void EMSBusSimulator::scheduleFrame(byte *buffer, byte len, unsigned long time)
+{
+	if (len > SERIAL_BUFFER_SIZE) len = SERIAL_BUFFER_SIZE;
+
+	busBytes += len;
+
+	for (byte i = 0; i < SIMULATOR_FRAMES; i++)
+	{
+		if (frames[i].length == 0)
+		{
+			frames[i].time = time;
+			frames[i].length = len;
+			memcpy(frames[i].data, buffer, len);
+			return;
+		}
+	}
+
+	overflows++;
+}
+
+
+/**
+ * Send a telegram of an EMS device with part of one of its messages. The telegram is received
+ * once all its bytes have been transmitted, and its CRC may be corrupted by the fault injection.
+ *
+ * @param [in]	eMSDatagramID	The EMS Datagram ID of the message.
+ * @param [in]	destinationID	Destination of the telegram (PC for replies, 0x00 for broadcasts).
+ * @param [in]	offset			Offset of the first byte sent inside the message.
+ * @param [in]	length			Number of bytes sent.
+ * @param [in]	time			Time in milliseconds when the transmission starts.
+ */
+
+void EMSBusSimulator::sendTelegram(byte eMSDatagramID, byte destinationID, byte offset, byte length, unsigned long time)
+{
+	EMSDatagram eMSDatagram;
+	byte *message = getMessage((EMSDatagramID)eMSDatagramID);
+
+	memcpy_P(&eMSDatagram, eMSDatagramIDs[eMSDatagramID], sizeof(EMSDatagram));
+
+	sendFrame(eMSDatagram.destinationID, destinationID, eMSDatagram.messageID, offset, &message[offset], length, time);
+}
+
+
+/**
+ * Schedule a telegram sent by an EMS device, computing its CRC (wrong if injected).
+ *
+ * @param 	  	sourceID	 	The EMS device that sends the telegram.
+ * @param 	  	destinationID	The destination of the telegram.
+ * @param 	  	messageID	 	The EMS Message ID.
+ * @param 	  	offset		 	The offset of the data in the EMS Message.
+ * @param [in]	data		 	The data of the telegram.
+ * @param 	  	length		 	Number of bytes of data.
+ * @param 	  	time		 	Time in milliseconds when the telegram starts to be sent.
+ */
+
+void EMSBusSimulator::sendFrame(byte sourceID, byte destinationID, byte messageID, byte offset, const byte *data, byte length, unsigned long time)
+{
+	byte buffer[SERIAL_BUFFER_SIZE];
+	uint8_t crc = 0;
+
+	if (length > SERIAL_BUFFER_SIZE - SIMULATOR_TELEGRAM_OVERHEAD) length = SERIAL_BUFFER_SIZE - SIMULATOR_TELEGRAM_OVERHEAD;
+
+	buffer[0] = sourceID;
+	buffer[1] = destinationID;
+	buffer[2] = messageID;
+	buffer[3] = offset;
+	memcpy(&buffer[4], data, length);
+
+	for (byte i = 0; i < length + 4; i++)
+	{
+		crc = crc_update(crc, buffer[i]);
+	}
+
+	if ((crcErrorRate > 0) && (simulatorRandom() % 100 < crcErrorRate)) crc ^= 0x5A;
+
+	buffer[length + 4] = crc;
+	buffer[length + 5] = 0x00;
+
+	scheduleFrame(buffer, length + SIMULATOR_TELEGRAM_OVERHEAD, time + (length + SIMULATOR_TELEGRAM_OVERHEAD) * SIMULATOR_BYTE_TIME);
+	telegrams++;
+}
+
+
+/**
+ * Get the oldest frame already received by Calduino.
+ *
+ * @return	The frame, or NULL if there is none.
+ */
+
+SimulatorFrame *EMSBusSimulator::nextFrame()
+{
+	SimulatorFrame *frame = NULL;
+
+	for (byte i = 0; i < SIMULATOR_FRAMES; i++)
+	{
+		if ((frames[i].length > 0) && ((long)(now - frames[i].time) >= 0) &&
+			((frame == NULL) || ((long)(frames[i].time - frame->time) < 0)))
+		{
+			frame = &frames[i];
+		}
+	}
+
+	return frame;
+}
@@ -0,0 +1,155 @@
+/*
+* Copyright (c) 2018 Daniel Macías Perea (dani.macias.perea@gmail.com)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+* Legal Notices
+* 'Bosch Group', 'Buderus', 'Nefit' and 'Worcester' are brands of Bosch Thermotechnology.
+* All other trademarks are the property of their respective owners.
+*/
+
+/**
+* @file EMSBusSimulator.h
+*
+* @brief The EMSBusSimulator class definition. It simulates an EMS Bus with a Bus Master and the
+* UBA, RC35 and MM10 devices behind the CalduinoSerial interface, so Calduino can be run and
+* measured without a boiler (e.g. on a PC with an Arduino core shim providing Arduino.h).
+*/
+
+
+#ifndef EMSBusSimulator_h
+#define EMSBusSimulator_h
+
+#include <Arduino.h>
+#include "Calduino.h"
+
+#define SIMULATOR_FRAMES 8
+#define SIMULATOR_MEMORY_SIZE 1280
+#define SIMULATOR_BYTE_TIME 1
+#define SIMULATOR_TELEGRAM_OVERHEAD 6
+#define SIMULATOR_POLL_INTERVAL 200
+#define SIMULATOR_REPLY_DELAY 10
+#define SIMULATOR_BROADCASTS 3
+#define SIMULATOR_PRODUCT_UBA 123
+#define SIMULATOR_PRODUCT_RC_35 86
+#define SIMULATOR_PRODUCT_MM_10 69
+#define SIMULATOR_VERSION_MAJOR 2
+#define SIMULATOR_VERSION_MINOR 10
+
+
+/**
+ * Simulator Frame struct definition. A frame scheduled on the simulated EMS Bus:
+ * - Time in milliseconds when the last byte (break) of the frame is received by Calduino.
+ * - Length of the frame, including CRC and break (0 if the entry is free).
+ * - Data contains the bytes of the frame.
+ */
+
+struct SimulatorFrame {
+	unsigned long time;
+	byte length;
+	byte data[SERIAL_BUFFER_SIZE];
+};
+
+
+/**
+ * Simulator Broadcast struct definition. A telegram periodically broadcast by an EMS device:
+ * - EMS Datagram ID broadcast.
+ * - Period in milliseconds between broadcasts.
+ * - Next is the time in milliseconds of the next broadcast.
+ */
+
+struct SimulatorBroadcast {
+	byte eMSDatagramID;
+	unsigned long period;
+	unsigned long next;
+};
+
+
+/**
+ * EMS Bus Simulator. It replaces the EMSSerial of Calduino with a simulated EMS Bus driven by a
+ * virtual clock, which advances one millisecond every time Calduino checks for a frame and
+ * there is none. The Bus Master polls Calduino periodically (and foreignPollDeviceID halfway
+ * between two polls of Calduino) and the UBA, RC35 and MM10 answer
+ * the EMS Commands of the EMS Datagrams defined in eMSDatagramIDs with the values kept in their
+ * memory, and the version queries with their product ID. Faults can be injected to test the error handling of Calduino.
+ */
+
+class EMSBusSimulator : public CalduinoSerial {
+private:
+	unsigned long now;
+	unsigned long nextPoll;
+	unsigned long randomSeed;
+	boolean pendingCollision;
+	uint16_t overflows;
+	SimulatorFrame frames[SIMULATOR_FRAMES];
+	SimulatorBroadcast broadcasts[SIMULATOR_BROADCASTS];
+	unsigned int memoryOffset[EMS_DATAGRAMS];
+	byte memory[SIMULATOR_MEMORY_SIZE];
+
+	byte simulatorRandom();
+	byte getProductID(byte deviceID);
+	byte findDatagram(byte deviceID, byte messageID);
+	void update();
+	void scheduleFrame(byte *buffer, byte len, unsigned long time);
+	void sendTelegram(byte eMSDatagramID, byte destinationID, byte offset, byte length, unsigned long time);
+	void sendFrame(byte sourceID, byte destinationID, byte messageID, byte offset, const byte *data, byte length, unsigned long time);
+	SimulatorFrame *nextFrame();
+
+public:
+	/* Fault injection and timing parameters */
+	byte crcErrorRate;
+	byte pollDropRate;
+	byte collisionRate;
+	byte replyDropRate;
+	byte slowDeviceID;
+	unsigned int slowDeviceDelay;
+	byte absentDeviceID;
+	byte foreignPollDeviceID;
+	unsigned int pollInterval;
+	unsigned int replyDelay;
+
+	/* Counters of the simulated EMS Bus */
+	unsigned long polls;
+	unsigned long commands;
+	unsigned long telegrams;
+	unsigned long busBytes;
+
+	EMSBusSimulator();
+	void begin(unsigned long seed = 1);
+	byte *getMessage(EMSDatagramID eMSDatagramID);
+	void setBroadcast(byte broadcast, EMSDatagramID eMSDatagramID, unsigned long period);
+	void advance(unsigned long ms);
+
+	virtual size_t write(uint8_t byte) { return 0; }
+	virtual int read() { return -1; }
+	virtual int available() { return 0; }
+	virtual void flush();
+	virtual int peek() { return -1; }
+	virtual void writeEOF() {}
+	virtual bool frameError() { return false; }
+	virtual int frameAvailable();
+	virtual int readFrame(byte *buffer, byte len, bool *crcOK = NULL);
+	virtual bool writeFrame(byte *buffer, byte len);
+	virtual bool txBusy() { return false; }
+	virtual bool collision() { bool ret = pendingCollision; pendingCollision = false; return ret; }
+	virtual uint16_t rxOverflows() { return overflows; }
+	virtual unsigned long getMillis() { return now; }
+};
+
+#endif
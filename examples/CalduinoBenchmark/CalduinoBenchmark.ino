@@ -0,0 +1,253 @@
+/**
+*	Name:		CalduinoBenchmark.ino
+*
+*	Drives every getter and setter of Calduino, and printEMSDatagram for all the EMS Datagrams,
+*	against the EMS Bus simulator. The simulated EMS Bus is deterministic (same seed, same
+*	timing), so the results of two builds can be compared run to run. For each operation it
+*	reports, as CSV:
+*	- bus_ms: time on the (virtual) EMS Bus clock.
+*	- poll_slots: polls of the Bus Master used to send EMS Commands.
+*	- bus_bytes: bytes sent through the EMS Bus by Calduino and by the simulated devices.
+*	- retries: EMS Commands repeated by Calduino.
+*	- cycles: CPU cycles spent by Calduino (transactions, decode and formatting), excluding
+*	the time spent inside the simulator.
+*
+*	UART ports used
+*	UART_0 (Serial) -> Results
+*
+*/
+
+#include <Calduino.h>
+#include <EMSBusSimulator.h>
+
+#ifndef CALDUINO_STATS
+#error "Uncomment CALDUINO_STATS in Calduino.h"
+#endif
+
+#define DEBUG_UART_RATE 115200 // Results UART rate
+#define SIMULATOR_SEED 1 // Seed of the simulated EMS Bus
+#define CRC_ERROR_RATE 0 // Percentage of replies with wrong CRC
+#define POLL_DROP_RATE 0 // Percentage of polls lost
+#define REPLY_DROP_RATE 0 // Percentage of EMS Commands not answered
+
+/** EMS Bus simulator that measures the CPU time spent inside it. */
+class BenchmarkSimulator : public EMSBusSimulator {
+public:
+	unsigned long simulatorMicros;
+
+	int frameAvailable()
+	{
+		unsigned long start = micros();
+		int ret = EMSBusSimulator::frameAvailable();
+		simulatorMicros += micros() - start;
+		return ret;
+	}
+
+	int readFrame(byte *buffer, byte len, bool *crcOK = NULL)
+	{
+		unsigned long start = micros();
+		int ret = EMSBusSimulator::readFrame(buffer, len, crcOK);
+		simulatorMicros += micros() - start;
+		return ret;
+	}
+
+	bool writeFrame(byte *buffer, byte len)
+	{
+		unsigned long start = micros();
+		bool ret = EMSBusSimulator::writeFrame(buffer, len);
+		simulatorMicros += micros() - start;
+		return ret;
+	}
+};
+
+/** Stream that discards the output of printEMSDatagram, so only the formatting is measured. */
+class NullStream : public Stream {
+public:
+	size_t write(uint8_t c) { return 1; }
+	int available() { return 0; }
+	int read() { return -1; }
+	int peek() { return -1; }
+	void flush() {}
+};
+
+/** Counters at the beginning of an operation and totals of the run. */
+struct Sample {
+	unsigned long busMillis;
+	unsigned long pollSlots;
+	unsigned long busBytes;
+	unsigned long retries;
+	unsigned long cycles;
+	unsigned long requests;
+	unsigned long successes;
+};
+
+BenchmarkSimulator simulator;
+NullStream nullStream;
+Calduino calduino;
+Sample start, total;
+unsigned int failures = 0;
+
+/** Add the counters of every EMS Datagram. */
+void getCounters(unsigned long *retries, unsigned long *requests, unsigned long *successes)
+{
+	const CalduinoStats &stats = calduino.getStats();
+
+	*retries = *requests = *successes = 0;
+	for (byte i = 0; i < EMS_DATAGRAMS; i++)
+	{
+		*retries += stats.datagrams[i].retries;
+		*requests += stats.datagrams[i].requests;
+		*successes += stats.datagrams[i].successes;
+	}
+}
+
+void startSample()
+{
+	start.busMillis = simulator.getMillis();
+	start.pollSlots = simulator.commands;
+	start.busBytes = simulator.busBytes;
+	getCounters(&start.retries, &start.requests, &start.successes);
+	simulator.simulatorMicros = 0;
+	start.cycles = micros();
+}
+
+/** Print the counters of an operation as CSV columns. */
+void printCounters(Sample *sample)
+{
+	EMSSerial0.print(F(","));
+	EMSSerial0.print(sample->busMillis);
+	EMSSerial0.print(F(","));
+	EMSSerial0.print(sample->pollSlots);
+	EMSSerial0.print(F(","));
+	EMSSerial0.print(sample->busBytes);
+	EMSSerial0.print(F(","));
+	EMSSerial0.print(sample->retries);
+	EMSSerial0.print(F(","));
+	EMSSerial0.println(sample->cycles);
+}
+
+/** Print the CSV row of the operation. It fails if the call failed or any transaction failed. */
+void endSample(const __FlashStringHelper *operation, int index, boolean ok)
+{
+	Sample sample;
+
+	sample.cycles = (micros() - start.cycles - simulator.simulatorMicros) * (F_CPU / 1000000L);
+	sample.busMillis = simulator.getMillis() - start.busMillis;
+	sample.pollSlots = simulator.commands - start.pollSlots;
+	sample.busBytes = simulator.busBytes - start.busBytes;
+	getCounters(&sample.retries, &sample.requests, &sample.successes);
+	sample.retries -= start.retries;
+	ok = ok && (sample.requests - start.requests == sample.successes - start.successes);
+
+	total.busMillis += sample.busMillis;
+	total.pollSlots += sample.pollSlots;
+	total.busBytes += sample.busBytes;
+	total.retries += sample.retries;
+	total.cycles += sample.cycles;
+	if (!ok) failures++;
+
+	EMSSerial0.print(operation);
+	EMSSerial0.print(F(","));
+	EMSSerial0.print(index);
+	EMSSerial0.print(F(","));
+	EMSSerial0.print(ok ? 1 : 0);
+	printCounters(&sample);
+}
+
+/** Run a setter and print its CSV row. */
+#define BENCHMARK_SET(name, call) startSample(); endSample(F(name), 0, calduino.call)
+
+void setup()
+{
+	EMSSerial0.begin(DEBUG_UART_RATE);
+
+	simulator.crcErrorRate = CRC_ERROR_RATE;
+	simulator.pollDropRate = POLL_DROP_RATE;
+	simulator.replyDropRate = REPLY_DROP_RATE;
+	simulator.begin(SIMULATOR_SEED);
+	calduino.begin(&simulator, &nullStream);
+
+	memset(&total, 0, sizeof(Sample));
+	EMSSerial0.println(F("operation,index,ok,bus_ms,poll_slots,bus_bytes,retries,cycles"));
+
+	// getters
+	for (int i = 0; i <= ByteRequest::partyTimeHC4_b; i++)
+	{
+		startSample();
+		calduino.getCalduinoByteValue((ByteRequest)i);
+		endSample(F("getCalduinoByteValue"), i, true);
+	}
+
+	for (int i = 0; i <= FloatRequest::curImpTempMM10_f; i++)
+	{
+		startSample();
+		calduino.getCalduinoFloatValue((FloatRequest)i);
+		endSample(F("getCalduinoFloatValue"), i, true);
+	}
+
+	for (int i = 0; i <= ULongRequest::burnWorkMinDHW_ul; i++)
+	{
+		startSample();
+		calduino.getCalduinoUlongValue((ULongRequest)i);
+		endSample(F("getCalduinoUlongValue"), i, true);
+	}
+
+	for (int i = 0; i <= BitRequest::pauseModHC4_t; i++)
+	{
+		startSample();
+		calduino.getCalduinoBitValue((BitRequest)i);
+		endSample(F("getCalduinoBitValue"), i, true);
+	}
+
+	startSample();
+	calduino.getCalduinoSwitchPoint(EMSDatagramID::Program_1_HC_1, 0);
+	endSample(F("getCalduinoSwitchPoint"), 0, true);
+
+	SwitchPoint switchPoints[SWITCHING_POINTS];
+	startSample();
+	endSample(F("readProgram"), 0, calduino.readProgram(EMSDatagramID::Program_1_HC_1, switchPoints));
+
+	// printEMSDatagram of every EMS Datagram
+	for (int i = 0; i < EMS_DATAGRAMS; i++)
+	{
+		startSample();
+		endSample(F("printEMSDatagram"), i, calduino.printEMSDatagram((EMSDatagramID)i));
+	}
+
+	// setters
+	BENCHMARK_SET("setWorkModeHC", setWorkModeHC(1, 0));
+	BENCHMARK_SET("setTemperatureHC", setTemperatureHC(1, 0, 40));
+	BENCHMARK_SET("setProgramHC", setProgramHC(1, 1));
+	BENCHMARK_SET("setSWThresholdTempHC", setSWThresholdTempHC(1, 18));
+	BENCHMARK_SET("setNightSetbackModeHC", setNightSetbackModeHC(1, 1));
+	BENCHMARK_SET("setNightThresholdOutTempHC", setNightThresholdOutTempHC(1, 5));
+	BENCHMARK_SET("setRoomTempOffsetHC", setRoomTempOffsetHC(1, 0));
+	BENCHMARK_SET("setPauseModeHC", setPauseModeHC(1, 2));
+	BENCHMARK_SET("setPartyModeHC", setPartyModeHC(1, 2));
+	BENCHMARK_SET("setHolidayModeHC", setHolidayModeHC(1, 1, 8, 18, 15, 8, 18));
+	BENCHMARK_SET("setHomeHolidayModeHC", setHomeHolidayModeHC(1, 1, 9, 18, 15, 9, 18));
+	BENCHMARK_SET("setWorkModeDHW", setWorkModeDHW(1));
+	BENCHMARK_SET("setWorkModePumpDHW", setWorkModePumpDHW(1));
+	BENCHMARK_SET("setTemperatureDHW", setTemperatureDHW(50));
+	BENCHMARK_SET("setTemperatureTDDHW", setTemperatureTDDHW(70));
+	BENCHMARK_SET("setProgramDHW", setProgramDHW(0));
+	BENCHMARK_SET("setProgramPumpDHW", setProgramPumpDHW(0));
+	BENCHMARK_SET("setOneTimeDHW", setOneTimeDHW(true));
+	BENCHMARK_SET("setWorkModeTDDHW", setWorkModeTDDHW(0));
+	BENCHMARK_SET("setDayTDDHW", setDayTDDHW(2));
+	BENCHMARK_SET("setHourTDDHW", setHourTDDHW(3));
+	BENCHMARK_SET("setProgramSwitchPoint", setProgramSwitchPoint(EMSDatagramID::Program_1_HC_1, 0, 1, 0, 6, 30));
+
+	// rewrite the program read before with one switch point changed
+	switchPoints[1].hour = (switchPoints[1].hour + 1) % 24;
+	BENCHMARK_SET("writeProgram", writeProgram(EMSDatagramID::Program_1_HC_1, switchPoints));
+
+	// the total row is ok only if every operation was ok
+	EMSSerial0.print(F("total,0,"));
+	EMSSerial0.print(failures == 0 ? 1 : 0);
+	printCounters(&total);
+}
+
+void loop()
+{
+}
@@ -0,0 +1,117 @@
+/**
+*	Name:		CalduinoCRCBenchmark.ino
+*
+*	Compares the EMS CRC variants on the target: the bitwise calculation used originally by
+*	Calduino, the PROGMEM lookup table (crc_update) and the incremental CRC calculated by the
+*	RX interrupt path (store_char) while the bytes of a frame arrive. Reports the CPU cycles per
+*	byte of each variant. That all of them give identical results is checked on a PC by
+*	extras/host (make crc).
+*
+*	UART ports used
+*	UART_0 (Serial) -> Results
+*	UART_2 -> Not started, its EMS Serial buffers are used to feed the RX path
+*
+*/
+
+#include <Calduino.h>
+
+#define DEBUG_UART_RATE 9600 // Results UART rate
+#define BENCHMARK_LOOPS 100 // Times each telegram is processed while measuring
+
+/** Telegrams captured in the EMS Bus, the last byte is the CRC. */
+const byte rcDatetime[] = { 0x10, 0x0B, 0x06, 0x00, 0x12, 0x04, 0x0F, 0x0B, 0x1E, 0x05, 0x03, 0x00, 0x44 };
+const byte uBAMonitorFast[] = { 0x08, 0x00, 0x18, 0x00, 0x2D, 0x00, 0x12, 0x64, 0x01, 0xC3, 0x00, 0x00, 0x00, 0x01, 0x58, 0x00,
+	0x00, 0x21, 0x43, 0x80, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x02, 0x34, 0x00, 0xCB, 0x57 };
+const byte rcDatetimeRequest[] = { 0x0B, 0x90, 0x06, 0x00, 0x14, 0x58 };
+const byte uBAWorkingTime[] = { 0x08, 0x0B, 0x14, 0x00, 0x00, 0x0A, 0x2B, 0xF0, 0xAA };
+
+const byte *capturedTelegrams[] = { rcDatetime, uBAMonitorFast, rcDatetimeRequest, uBAWorkingTime };
+const byte capturedLengths[] = { sizeof(rcDatetime), sizeof(uBAMonitorFast), sizeof(rcDatetimeRequest), sizeof(uBAWorkingTime) };
+
+/** Bitwise CRC, as calculated originally by Calduino. */
+uint8_t bitwiseCRC(const byte *telegram, byte len)
+{
+	uint8_t crc = 0, d;
+	for (byte i = 0; i < len; i++)
+	{
+		d = 0;
+		if (crc & 0x80)
+		{
+			crc ^= 12;
+			d = 1;
+		}
+		crc = (crc << 1) & 0xfe;
+		crc |= d;
+		crc ^= telegram[i];
+	}
+	return crc;
+}
+
+/** Table driven CRC. */
+uint8_t tableCRC(const byte *telegram, byte len)
+{
+	uint8_t crc = 0;
+	for (byte i = 0; i < len; i++)
+	{
+		crc = crc_update(crc, telegram[i]);
+	}
+	return crc;
+}
+
+/** Feed a telegram (CRC and break included) to the RX path and return whether its CRC was correct. */
+boolean incrementalCRC(const byte *telegram, byte len)
+{
+	byte buffer[MAX_EMS_READ];
+	bool crcOK = false;
+
+	for (byte i = 0; i < len; i++)
+	{
+		store_char(telegram[i], false, &EMSSerial2);
+	}
+	store_char(0, true, &EMSSerial2);
+
+	EMSSerial2.readFrame(buffer, MAX_EMS_READ, &crcOK);
+	return crcOK;
+}
+
+void printCyclesPerByte(const __FlashStringHelper *name, unsigned long elapsedMicros, unsigned long bytes)
+{
+	EMSSerial0.print(name);
+	EMSSerial0.print(F(": "));
+	EMSSerial0.print((float)elapsedMicros * (F_CPU / 1000000L) / bytes);
+	EMSSerial0.println(F(" cycles/byte"));
+}
+
+void setup()
+{
+	EMSSerial0.begin(DEBUG_UART_RATE);
+
+	// measure each variant over the captured telegrams
+	unsigned long bytes = 0, start, bitwiseMicros = 0, tableMicros = 0, incrementalMicros = 0;
+	volatile uint8_t sink = 0;
+
+	for (byte t = 0; t < sizeof(capturedLengths); t++)
+	{
+		bytes += (unsigned long)capturedLengths[t] * BENCHMARK_LOOPS;
+
+		start = micros();
+		for (byte l = 0; l < BENCHMARK_LOOPS; l++) sink ^= bitwiseCRC(capturedTelegrams[t], capturedLengths[t]);
+		bitwiseMicros += micros() - start;
+
+		start = micros();
+		for (byte l = 0; l < BENCHMARK_LOOPS; l++) sink ^= tableCRC(capturedTelegrams[t], capturedLengths[t]);
+		tableMicros += micros() - start;
+
+		start = micros();
+		for (byte l = 0; l < BENCHMARK_LOOPS; l++) sink ^= incrementalCRC(capturedTelegrams[t], capturedLengths[t]);
+		incrementalMicros += micros() - start;
+	}
+
+	printCyclesPerByte(F("Bitwise"), bitwiseMicros, bytes);
+	printCyclesPerByte(F("Table"), tableMicros, bytes);
+	printCyclesPerByte(F("RX path (buffering and incremental CRC)"), incrementalMicros, bytes);
+}
+
+void loop()
+{
+}
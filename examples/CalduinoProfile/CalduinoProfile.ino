@@ -0,0 +1,128 @@
+/**
+*	Name:		CalduinoProfile.ino
+*
+*	Reports the CPU cycles of the hot paths of Calduino: the USART RX and TX interrupts,
+*	store_char, crcCalculator, CalduinoSerializer::printData and the objects of the serializer. The RX
+*	path is fed with telegrams recorded in the EMS Bus, and the rest with the EMS Bus simulator
+*	printing every EMS Datagram in every print format. For each section it prints, as CSV, the
+*	number of executions and the average and maximum cycles. The maximum of the interrupt
+*	sections is the worst-case time with the interrupts disabled, to be compared with the time of
+*	a byte at 9700 baud (and with the other UARTs in use, e.g. WiFly).
+*
+*	CALDUINO_PROFILE must be uncommented in Calduino.h (or defined in the build). It uses Timer 1,
+*	so its PWM pins are not available. Once the results are sent the CPU is halted, so the sketch
+*	also runs to completion under an AVR simulator: make -C extras/host profile builds it with
+*	arduino-cli, runs it under simavr and saves the CSV in extras/host/build/profile.csv. There the
+*	interrupt sections are only measured if the simulator feeds the EMS UART.
+*
+*	UART ports used
+*	UART_0 (Serial) -> Results
+*	UART_2 -> Not started, its EMS Serial buffers are used to replay the recorded telegrams
+*
+*/
+
+#include <avr/sleep.h>
+#include <Calduino.h>
+#include <EMSBusSimulator.h>
+
+#ifndef CALDUINO_PROFILE
+#error "Uncomment CALDUINO_PROFILE in Calduino.h"
+#endif
+
+#define DEBUG_UART_RATE 115200 // Results UART rate
+#define EMS_BUS_UART_RATE 9700 // EMS Bus UART rate
+#define REPLAY_LOOPS 100 // Times the recorded telegrams are replayed
+#define UART_DRAIN_TIME 10 // Milliseconds to send the last byte of the results before halting
+
+/** Telegrams recorded in the EMS Bus (poll, replies and broadcasts), the last byte is the CRC. */
+const byte poll[] = { 0x8B };
+const byte rcDatetime[] = { 0x10, 0x0B, 0x06, 0x00, 0x12, 0x04, 0x0F, 0x0B, 0x1E, 0x05, 0x03, 0x00, 0x44 };
+const byte uBAMonitorFast[] = { 0x08, 0x00, 0x18, 0x00, 0x2D, 0x00, 0x12, 0x64, 0x01, 0xC3, 0x00, 0x00, 0x00, 0x01, 0x58, 0x00,
+	0x00, 0x21, 0x43, 0x80, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x02, 0x34, 0x00, 0xCB, 0x57 };
+const byte uBAWorkingTime[] = { 0x08, 0x0B, 0x14, 0x00, 0x00, 0x0A, 0x2B, 0xF0, 0xAA };
+
+const byte *recordedTelegrams[] = { poll, rcDatetime, uBAMonitorFast, uBAWorkingTime };
+const byte recordedLengths[] = { sizeof(poll), sizeof(rcDatetime), sizeof(uBAMonitorFast), sizeof(uBAWorkingTime) };
+
+const char rxISRName[] PROGMEM = "RX ISR";
+const char txISRName[] PROGMEM = "TX ISR";
+const char storeCharName[] PROGMEM = "store_char";
+const char crcCalculatorName[] PROGMEM = "crcCalculator";
+const char printDataName[] PROGMEM = "printData";
+const char printObjectName[] PROGMEM = "printObject";
+const char *const sectionNames[PROFILE_SECTIONS] = { rxISRName, txISRName, storeCharName, crcCalculatorName, printDataName, printObjectName };
+
+/** Stream that discards the output of printEMSDatagram, so only the formatting is measured. */
+class NullStream : public Stream {
+public:
+	size_t write(uint8_t c) { return 1; }
+	int available() { return 0; }
+	int read() { return -1; }
+	int peek() { return -1; }
+	void flush() {}
+};
+
+EMSBusSimulator simulator;
+NullStream nullStream;
+Calduino calduino;
+
+void setup()
+{
+	EMSSerial0.begin(DEBUG_UART_RATE);
+	profileBegin();
+
+	// replay the recorded telegrams through the RX path, byte by byte and closed by the break
+	byte buffer[SERIAL_BUFFER_SIZE];
+
+	for (byte l = 0; l < REPLAY_LOOPS; l++)
+	{
+		for (byte t = 0; t < sizeof(recordedLengths); t++)
+		{
+			for (byte i = 0; i < recordedLengths[t]; i++)
+			{
+				store_char(recordedTelegrams[t][i], false, &EMSSerial2);
+			}
+			store_char(0, true, &EMSSerial2);
+			EMSSerial2.readFrame(buffer, SERIAL_BUFFER_SIZE);
+		}
+	}
+
+	// get and print every EMS Datagram from the simulated EMS Bus in every print format
+	calduino.begin(&simulator, &nullStream);
+
+	for (byte f = PrintFormat::Standard; f <= PrintFormat::Binary; f++)
+	{
+		calduino.printFormat = (PrintFormat)f;
+		for (byte i = 0; i < EMS_DATAGRAMS; i++)
+		{
+			calduino.printEMSDatagram((EMSDatagramID)i);
+		}
+	}
+
+	EMSSerial0.print(F("byte_time_cycles,"));
+	EMSSerial0.println((F_CPU / EMS_BUS_UART_RATE) * 11);
+	EMSSerial0.println(F("section,count,avg_cycles,max_cycles"));
+
+	for (byte s = 0; s < PROFILE_SECTIONS; s++)
+	{
+		ProfileCounter counter = getProfileCounter((ProfileSection)s);
+
+		EMSSerial0.print(FPSTR(sectionNames[s]));
+		EMSSerial0.print(F(","));
+		EMSSerial0.print(counter.count);
+		EMSSerial0.print(F(","));
+		EMSSerial0.print(counter.count > 0 ? counter.cycles / counter.count : 0);
+		EMSSerial0.print(F(","));
+		EMSSerial0.println(counter.maxCycles);
+	}
+
+	// halt with the interrupts disabled, an AVR simulator quits then
+	delay(UART_DRAIN_TIME);
+	cli();
+	sleep_enable();
+	sleep_cpu();
+}
+
+void loop()
+{
+}
@@ -6,7 +6,7 @@
 *	
 *	Hardware:	
 *	- Arduino Mega 2560  
-*	- EMS Bus  UART Interface Circuit  
+*	- EMS Bus  UART Interface Circuit  
 *	- WiFly RN 171 XV*	
 *
 *	UART ports used:
@@ -46,20 +46,20 @@
 *	
 *	Set Commands
 *	-	Set Working Mode HC			calduino/?op=30&hc=X&wm=Y		hc - Heating Circuit 1/2/3/4	wm - Working Mode 0 = night/ 1 = day/ 2 = auto  
-*	-	Set Temperature HC			calduino/?op=31&hc=X&wm=Y&tp=ZZ	hc - Heating Circuit 1/2/3/4	wm - Working Mode 0 = night/ 1 = day/ 2 = auto	tp - Desired Temperature x 2  from 6C*2 to 29C*2 with 0,5 C increments
+*	-	Set Temperature HC			calduino/?op=31&hc=X&wm=Y&tp=ZZ	hc - Heating Circuit 1/2/3/4	wm - Working Mode 0 = night/ 1 = day/ 2 = auto	tp - Desired Temperature x 2  from 6°C*2 to 29°C*2 with 0,5 °C increments
 *	-	Set Program HC				calduino/?op=32&hc=X&pr=YY		hc - Heating Circuit 1/2/3/4	pr - Program 00 = User 1/ 0x01 = Family / 0x02 = Morning / 0x03 = Early morning / 0x04 = Evening / 0x05 = Midmorning / 0x06 = Afternoon / 0x07 = Midday / 0x08 = Single / 0x09 = Senioren / 0x0A User2  
-*	-	Set S/W Threshold HC		calduino/?op=33&hc=X&tp=ZZ		hc - Heating Circuit 1/2/3/4	tp - Desired Temperature from 6C to 29C with 0,5 C increments 
+*	-	Set S/W Threshold HC		calduino/?op=33&hc=X&tp=ZZ		hc - Heating Circuit 1/2/3/4	tp - Desired Temperature from 6°C to 29°C with 0,5 °C increments 
 *	-	Set Night Setback Mode HC	calduino/?op=34&hc=X&wm=Y		hc - Heating Circuit 1/2/3/4	wm - Working Mode 0 = Shutdown / 1 = Reduced Operation / 2 = Room Setback / 3 = Outdoor Setback  
-*	-	Set Out Night Thr Temp HC	calduino/?op=35&hc=X&tp=(Z)ZZ	hc - Heating Circuit 1/2/3/4	tp - Desired Temperature from -20C to 10C with 1 C increments  
-*	-	Set Room Temp Offset HC		calduino/?op=36&hc=X&tp=(Z)ZZ	hc - Heating Circuit 1/2/3/4	tp - Desired Offset x 2 from -5C*2 to 5C*2 with 0,5 C increments   
+*	-	Set Out Night Thr Temp HC	calduino/?op=35&hc=X&tp=(Z)ZZ	hc - Heating Circuit 1/2/3/4	tp - Desired Temperature from -20°C to 10°C with 1 °C increments  
+*	-	Set Room Temp Offset HC		calduino/?op=36&hc=X&tp=(Z)ZZ	hc - Heating Circuit 1/2/3/4	tp - Desired Offset x 2 from -5°C*2 to 5°C*2 with 0,5 °C increments   
 *	-	Set Pause Mode				calduino/?op=37&hc=X&h=YY		hc - Heating Circuit 1/2/3/4	h - Desired Hours  
 *	-	Set Party Mode				calduino/?op=38&&hc=X&h=YY		hc - Heating Circuit 1/2/3/4	h - Desired Hours  
 *	-	Set Holiday Mode HC			calduino/?op=39&hc=X&sd=DD&ed=DD&sm=MM&em=MM&sy=YY&ey=YY	hc - Heating Circuit 1/2/3/4	sd/ed - Starting/Ending day	sm/em - Starting/Ending month sy/ey - Starting/Ending Year  
 *	-	Set Holiday Home Mode HC	calduino/?op=40&hc=X&sd=DD&ed=DD&sm=MM&em=MM&sy=YY&ey=YY	hc - Heating Circuit 1/2/3/4	sd/ed - Starting/Ending day	sm/em - Starting/Ending month sy/ey - Starting/Ending Year  
 *	-	Set Work Mode DHW			calduino/?op=41&wm=Y			wm - Working Mode 0 = off/ 1 = on/ 2 = auto  
 *	-	Set Work Mode Pump DHW		calduino/?op=42&wm=Y			wm - Working Mode 0 = off/ 1 = on/ 2 = auto  
-*	-	Set Temperature DHW			calduino/?op=43&tp=ZZ			tp - Desired Temperature from 30 to 80 with 1 C increments  
-*	-	Set Temperature TD DHW		calduino/?op=44&tp=ZZ			tp - Desired Temperature from 30 to 80 with 1 C increments  
+*	-	Set Temperature DHW			calduino/?op=43&tp=ZZ			tp - Desired Temperature from 30 to 80 with 1 °C increments  
+*	-	Set Temperature TD DHW		calduino/?op=44&tp=ZZ			tp - Desired Temperature from 30 to 80 with 1 °C increments  
 *	-	Set Program DHW				calduino/?op=45&pr=YYY			pr - Program 000 = Like HC1 / 255 = Own Program  
 *	-	Set Program Pump DHW		calduino/?op=46&pr=YYY			pr - Program 000 = Like HC1 / 255 = Own Program  
 *	-	Set One Time DHW			calduino/?op=47&wm=0			wm - Working Mode 0 = off/ 1 = on  
@@ -91,16 +91,12 @@
 #define DPRINTVALUE(item1, item2)
 #endif
 
-#define SEND_WIFLY_XML_S(item1, item2, item3) snprintf_P(item3, sizeof(item3), PSTR("<%S>%s</%S>"), item1, item2, item1); wifly.println(item3);
-#define SEND_WIFLY_XML_D(item1, item2, item3) snprintf_P(item3, sizeof(item3), PSTR("<%S>%d</%S>"), item1, item2, item1); wifly.println(item3);
-#define SEND_WIFLY_XML_UL(item1, item2, item3) snprintf_P(item3, sizeof(item3), PSTR("<%S>%lu</%S>"), item1, item2, item1); wifly.println(item3);
-
-
 #define RESET_PIN						40			///< Pin to reset the WiFly module
 #define WIFLY_UART_RATE					9600		///< Wifly UART rate
 #define DEBUG_UART_RATE					9600		///< Debug UART rate
 #define EMS_BUS_UART_RATE				9700		///< EMS Bus - UART Interface rate
 #define MAIN_LOOP_WAIT_TIME				1000		///< Wait time between loops
+#define MONITORS_REFRESH_TIME			60000		///< Time between background refreshes of the monitors
 #define NO_OPERATION					0xFF			
 #define HTTP_BUFFER_SIZE				80
 #define CALDUINO_FULL_STATISTICS		1
@@ -162,74 +158,131 @@ char myPassword[] = "";
 unsigned int operationsOK = 0;
 unsigned int operationsNOK = 0;
 
+// monitors refreshed in the background, sent at once by getAllMonitors
+EMSDatagramID monitors[] = {
+	EMSDatagramID::UBA_Working_Time, EMSDatagramID::UBA_Monitor_Fast, EMSDatagramID::UBA_Monitor_Slow,
+	EMSDatagramID::UBA_Parameter_DHW, EMSDatagramID::UBA_Monitor_DHW, EMSDatagramID::Working_Mode_DHW,
+	EMSDatagramID::Monitor_HC_1, EMSDatagramID::Working_Mode_HC_1, EMSDatagramID::Monitor_HC_2,
+	EMSDatagramID::Working_Mode_HC_2, EMSDatagramID::Monitor_MM_10 };
+
+#define MONITORS (sizeof(monitors) / sizeof(monitors[0]))
+
+byte monitorBuffers[MONITORS][EMS_CACHE_BUFFER_SIZE];
+boolean monitorValid[MONITORS];
+byte nextMonitor = 0;
+boolean monitorRefreshing = false;
+unsigned long lastRefresh = 0;
+
 
 /**
- * Send the stats of Calduino in XML format via WiFly module
+ * Send the stats of Calduino in the print format of Calduino via WiFly module
  *
- * @param	mode	0 = full statistics, 1 = basic data.
+ * @param	mode	1 = full statistics, 0 = basic data.
  *
  * @return	whether the operation has been correctly executed or not.
  */
 
 boolean getCalduinoStats(byte mode)
 {
-	char printXMLWiFly[SERIAL_BUFFER_SIZE];
-	
-	wifly.println(F("<Calduino>"));
+	calduino.serializer.beginObject(F("Calduino"));
 	if (mode == CALDUINO_FULL_STATISTICS)
 	{
 		char auxBuffer[20];
-		SEND_WIFLY_XML_S(F("MAC"), wifly.getMAC(auxBuffer, sizeof(auxBuffer)), printXMLWiFly);
-		SEND_WIFLY_XML_S(F("IP"), wifly.getIP(auxBuffer, sizeof(auxBuffer)), printXMLWiFly);
-		SEND_WIFLY_XML_S(F("Gateway"), wifly.getGateway(auxBuffer, sizeof(auxBuffer)), printXMLWiFly);
-		SEND_WIFLY_XML_S(F("Netmask"), wifly.getNetmask(auxBuffer, sizeof(auxBuffer)), printXMLWiFly);
-		SEND_WIFLY_XML_S(F("SSID"), wifly.getSSID(auxBuffer, sizeof(auxBuffer)), printXMLWiFly);
-		SEND_WIFLY_XML_S(F("DeviceID"), wifly.getDeviceID(auxBuffer, sizeof(auxBuffer)), printXMLWiFly);
-		SEND_WIFLY_XML_D(F("FreeMemory"), wifly.getFreeMemory(), printXMLWiFly);
+		calduino.serializer.printValue(F("MAC"), wifly.getMAC(auxBuffer, sizeof(auxBuffer)));
+		calduino.serializer.printValue(F("IP"), wifly.getIP(auxBuffer, sizeof(auxBuffer)));
+		calduino.serializer.printValue(F("Gateway"), wifly.getGateway(auxBuffer, sizeof(auxBuffer)));
+		calduino.serializer.printValue(F("Netmask"), wifly.getNetmask(auxBuffer, sizeof(auxBuffer)));
+		calduino.serializer.printValue(F("SSID"), wifly.getSSID(auxBuffer, sizeof(auxBuffer)));
+		calduino.serializer.printValue(F("DeviceID"), wifly.getDeviceID(auxBuffer, sizeof(auxBuffer)));
+		calduino.serializer.printValue(F("FreeMemory"), wifly.getFreeMemory());
 	}
 	 
-	SEND_WIFLY_XML_UL(F("UpTimeCald"), (unsigned long)wifly.getUptime(), printXMLWiFly);				//0
-	SEND_WIFLY_XML_D(F("OpRecCald"), operationsOK + operationsNOK, printXMLWiFly);						//1
-	SEND_WIFLY_XML_D(F("OpOKCald"), operationsOK, printXMLWiFly);                                       //2
-	SEND_WIFLY_XML_D(F("OpNOKCald"), operationsNOK, printXMLWiFly);										//3
-	SEND_WIFLY_XML_UL(F("RTC"), (unsigned long)wifly.getRTC(), printXMLWiFly);							//4
-	wifly.println(F("</Calduino>"));
+	calduino.serializer.printValue(F("UpTimeCald"), wifly.getUptime());					//0
+	calduino.serializer.printValue(F("OpRecCald"), operationsOK + operationsNOK);		//1
+	calduino.serializer.printValue(F("OpOKCald"), operationsOK);						//2
+	calduino.serializer.printValue(F("OpNOKCald"), operationsNOK);						//3
+	calduino.serializer.printValue(F("RTC"), wifly.getRTC());							//4
+	calduino.serializer.endObject();
 	
 	return true;
 }
 
 
 /**
- * Gets all EMS monitors
+ * Gets all EMS monitors in a single document. The monitors are sent from their last background
+ * refresh, only the names of the programs are read from the EMS Bus.
  *
  * @return	True if it succeeds, false if it fails.
  */
 
 boolean getAllMonitors()
 {
+	boolean operationStatus = true;
+
+	calduino.serializer.beginObject(F("AllMonitors"));
+
+	for (byte i = 0; i < MONITORS; i++)
+	{
+		operationStatus &= calduino.printEMSBuffer(monitors[i], (monitorValid[i] ? monitorBuffers[i] : NULL));
+
+		// the program name of each heating circuit follows its working mode
+		if (monitors[i] == EMSDatagramID::Working_Mode_HC_1)
+		{
+			operationStatus &= calduino.printEMSDatagram(EMSDatagramID::Program_1_HC_1, DatagramDataIndex::programNameIdx);
+		}
+		else if (monitors[i] == EMSDatagramID::Working_Mode_HC_2)
+		{
+			operationStatus &= calduino.printEMSDatagram(EMSDatagramID::Program_1_HC_2, DatagramDataIndex::programNameIdx);
+		}
+	}
 
-	wifly.println(F("<AllMonitors>"));
-
-	boolean operationStatus = calduino.printEMSDatagram(EMSDatagramID::UBA_Working_Time);
-	operationStatus &= calduino.printEMSDatagram(EMSDatagramID::UBA_Monitor_Fast);
-	operationStatus &= calduino.printEMSDatagram(EMSDatagramID::UBA_Monitor_Slow);
-	operationStatus &= calduino.printEMSDatagram(EMSDatagramID::UBA_Parameter_DHW);
-	operationStatus &= calduino.printEMSDatagram(EMSDatagramID::UBA_Monitor_DHW);
-	operationStatus &= calduino.printEMSDatagram(EMSDatagramID::Working_Mode_DHW);
-	operationStatus &= calduino.printEMSDatagram(EMSDatagramID::Monitor_HC_1);
-	operationStatus &= calduino.printEMSDatagram(EMSDatagramID::Working_Mode_HC_1);
-	operationStatus &= calduino.printEMSDatagram(EMSDatagramID::Program_1_HC_1, DatagramDataIndex::programNameIdx);
-	operationStatus &= calduino.printEMSDatagram(EMSDatagramID::Monitor_HC_2);
-	operationStatus &= calduino.printEMSDatagram(EMSDatagramID::Working_Mode_HC_2);
-	operationStatus &= calduino.printEMSDatagram(EMSDatagramID::Program_1_HC_2, DatagramDataIndex::programNameIdx);
-	operationStatus &= calduino.printEMSDatagram(EMSDatagramID::Monitor_MM_10);
 	operationStatus &= getCalduinoStats(0);
-	wifly.println(F("</AllMonitors>"));
+	calduino.serializer.endObject();
 
 	return operationStatus;
 }
 
 
+/**
+ * Called by Calduino when the background read of a monitor finishes.
+ *
+ * @param	handle 	The handle of the transaction.
+ * @param	success	Whether the monitor has been read.
+ * @param	context	Not used.
+ */
+
+void onMonitorRefreshed(byte handle, boolean success, void *context)
+{
+	monitorValid[nextMonitor++] = success;
+	monitorRefreshing = false;
+}
+
+
+/**
+ * Refresh the monitors every MONITORS_REFRESH_TIME milliseconds, one background read at a time
+ * executed by calduino.poll(). The set commands and the get commands requested meanwhile are
+ * sent first, a multi-chunk monitor yields the EMS Bus between chunks.
+ */
+
+void refreshMonitors()
+{
+	if (monitorRefreshing) return;
+
+	// start a new refresh once the previous one is done and its time has come
+	if (nextMonitor == MONITORS)
+	{
+		if (millis() - lastRefresh < MONITORS_REFRESH_TIME) return;
+
+		nextMonitor = 0;
+		lastRefresh = millis();
+	}
+
+	// the monitors of absent EMS devices (or whose breaker is open) are not submitted
+	monitorRefreshing = (calduino.submit(monitorBuffers[nextMonitor], monitors[nextMonitor], onMonitorRefreshed, NULL, TransactionPriority::BackgroundRead) != ERROR_VALUE);
+	if (!monitorRefreshing) monitorValid[nextMonitor++] = false;
+}
+
+
 /**
  * Searchs an string in the HTTP request received, captures the next parameterLength characters
  * and casts them to decimal.
@@ -570,6 +623,11 @@ void setup()
 		DPRINTLN(F("Setup: Unable to start Calduino."));
 	}
 
+	// find the EMS devices installed, so the monitors of the absent ones (e.g. MM10) fail immediately
+	byte devicesPresent = calduino.discoverDevices();
+	DPRINTVALUE(F("Setup: EMS devices present"), devicesPresent);
+
+	// XML by default, PrintFormat::JSON sends the same documents as compact JSON objects
 	calduino.printFormat = PrintFormat::XML;
 
 }
@@ -587,5 +645,11 @@ void loop()
 	wifly.close();
 	wifly.flush();
 
-	delay(MAIN_LOOP_WAIT_TIME);
+	// wait for the next HTTP Request while the monitors are refreshed in the background
+	unsigned long loopStart = millis();
+	while (millis() - loopStart < MAIN_LOOP_WAIT_TIME)
+	{
+		refreshMonitors();
+		calduino.poll();
+	}
 }
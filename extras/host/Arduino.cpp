@@ -0,0 +1,95 @@
+/*
+* Minimal Arduino core for building Calduino on a PC (see Arduino.h).
+*/
+
+#include "Arduino.h"
+
+uint8_t SREG;
+volatile uint8_t UBRR0H, UBRR0L, UCSR0A, UCSR0B, UCSR0C, UDR0;
+volatile uint8_t UBRR1H, UBRR1L, UCSR1A, UCSR1B, UCSR1C, UDR1;
+volatile uint8_t UBRR2H, UBRR2L, UCSR2A, UCSR2B, UCSR2C, UDR2;
+volatile uint8_t UBRR3H, UBRR3L, UCSR3A, UCSR3B, UCSR3C, UDR3;
+volatile uint16_t TCNT1;
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+
+HardwareSerial Serial;
+
+static unsigned long hostMillis = 0;
+
+unsigned long millis() { return hostMillis; }
+
+unsigned long micros() { return hostMillis * 1000UL; }
+
+void delay(unsigned long ms) { hostMillis += ms; }
+
+void delayMicroseconds(unsigned int us) {}
+
+long random(long howbig) { return (howbig == 0) ? 0 : rand() % howbig; }
+
+long random(long howsmall, long howbig) { return (howsmall >= howbig) ? howsmall : howsmall + random(howbig - howsmall); }
+
+void randomSeed(unsigned long seed) { srand(seed); }
+
+char *dtostrf(double val, signed char width, unsigned char prec, char *sout)
+{
+	sprintf(sout, "%*.*f", width, prec, val);
+	return sout;
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+	size_t n = 0;
+	while (size--) n += write(*buffer++);
+	return n;
+}
+
+size_t Print::print(long n, int base)
+{
+	if ((base == DEC) && (n < 0)) return print('-') + print((unsigned long)-n, base);
+	return print((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base)
+{
+	char buf[8 * sizeof(long) + 1];
+	char *str = &buf[sizeof(buf) - 1];
+
+	if (base < 2) base = DEC;
+	*str = '\0';
+	do {
+		char c = n % base;
+		n /= base;
+		*--str = (c < 10) ? c + '0' : c + 'A' - 10;
+	} while (n);
+
+	return write(str);
+}
+
+size_t Print::print(double n, int digits)
+{
+	char buf[32];
+	if (isnan(n)) return print("nan");
+	if (isinf(n)) return print("inf");
+	snprintf(buf, sizeof(buf), "%.*f", digits, n);
+	return write(buf);
+}
+
+int HardwareSerial::available()
+{
+	int c = peek();
+	return (c < 0) ? 0 : 1;
+}
+
+int HardwareSerial::read()
+{
+	int c = getchar();
+	return (c == EOF) ? -1 : c;
+}
+
+int HardwareSerial::peek()
+{
+	int c = getchar();
+	if (c == EOF) return -1;
+	ungetc(c, stdin);
+	return c;
+}
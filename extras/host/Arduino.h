@@ -0,0 +1,188 @@
+/*
+* Minimal Arduino core for building Calduino on a PC. It provides the types, PROGMEM helpers,
+* Print and Stream of the AVR core, plus the ATmega2560 USART and Timer 1 registers used by
+* EMSSerial, so the library, the EMS Bus simulator and the telemetry decoder compile unmodified.
+*
+* millis() is a virtual clock advanced by delay(), so a run on the host is deterministic.
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define F_CPU 16000000UL
+#define __AVR_ATmega2560__
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+/* program memory is ordinary memory on the host */
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_ptr(addr) (*(void * const *)(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define strstr_P strstr
+#define sprintf_P sprintf
+#define snprintf_P snprintf
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+#define lowByte(w) ((uint8_t)((w) & 0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define _BV(bit) (1 << (bit))
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+char *dtostrf(double val, signed char width, unsigned char prec, char *sout);
+
+/* AVR status register and interrupts */
+extern uint8_t SREG;
+#define cli()
+#define sei()
+
+/* ATmega2560 USART registers and bits */
+extern volatile uint8_t UBRR0H, UBRR0L, UCSR0A, UCSR0B, UCSR0C, UDR0;
+extern volatile uint8_t UBRR1H, UBRR1L, UCSR1A, UCSR1B, UCSR1C, UDR1;
+extern volatile uint8_t UBRR2H, UBRR2L, UCSR2A, UCSR2B, UCSR2C, UDR2;
+extern volatile uint8_t UBRR3H, UBRR3L, UCSR3A, UCSR3B, UCSR3C, UDR3;
+#define UBRR0H UBRR0H
+#define UBRR0L UBRR0L
+#define UBRR1H UBRR1H
+#define UBRR1L UBRR1L
+#define UBRR2H UBRR2H
+#define UBRR2L UBRR2L
+#define UBRR3H UBRR3H
+#define UBRR3L UBRR3L
+#define UDR0 UDR0
+#define UDR1 UDR1
+#define UDR2 UDR2
+#define UDR3 UDR3
+#define RXEN0 4
+#define TXEN0 3
+#define RXCIE0 7
+#define TXCIE0 6
+#define UDRIE0 5
+#define RXEN1 4
+#define TXEN1 3
+#define RXCIE1 7
+#define TXCIE1 6
+#define UDRIE1 5
+#define RXEN2 4
+#define TXEN2 3
+#define RXCIE2 7
+#define TXCIE2 6
+#define UDRIE2 5
+#define RXEN3 4
+#define TXEN3 3
+#define RXCIE3 7
+#define TXCIE3 6
+#define UDRIE3 5
+#define UDRE0 5
+#define TXC0 6
+#define UPM01 5
+#define FE0 4
+#define FE1 4
+#define FE2 4
+#define FE3 4
+#define DOR0 3
+#define DOR1 3
+#define DOR2 3
+#define DOR3 3
+
+/* interrupt vectors are plain functions, called by the host code to inject bytes */
+#define USART0_RX_vect USART0_RX_vect
+#define USART1_RX_vect USART1_RX_vect
+#define USART2_RX_vect USART2_RX_vect
+#define USART3_RX_vect USART3_RX_vect
+#define USART0_TX_vect USART0_TX_vect
+#define USART1_TX_vect USART1_TX_vect
+#define USART2_TX_vect USART2_TX_vect
+#define USART3_TX_vect USART3_TX_vect
+#define ISR(vector) extern "C" void vector(void)
+extern "C" void USART0_RX_vect(void);
+extern "C" void USART1_RX_vect(void);
+extern "C" void USART2_RX_vect(void);
+extern "C" void USART3_RX_vect(void);
+extern "C" void USART0_TX_vect(void);
+extern "C" void USART1_TX_vect(void);
+extern "C" void USART2_TX_vect(void);
+extern "C" void USART3_TX_vect(void);
+
+/* Timer 1, used by CALDUINO_PROFILE */
+extern volatile uint16_t TCNT1;
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+#define CS10 0
+
+class Print {
+public:
+	virtual ~Print() {}
+	virtual size_t write(uint8_t c) = 0;
+	virtual size_t write(const uint8_t *buffer, size_t size);
+	size_t write(const char *str) { return (str == NULL) ? 0 : write((const uint8_t *)str, strlen(str)); }
+	size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+
+	size_t print(const __FlashStringHelper *str) { return write((const char *)str); }
+	size_t print(const char str[]) { return write(str); }
+	size_t print(char c) { return write((uint8_t)c); }
+	size_t print(unsigned char n, int base = DEC) { return print((unsigned long)n, base); }
+	size_t print(int n, int base = DEC) { return print((long)n, base); }
+	size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+	size_t print(long n, int base = DEC);
+	size_t print(unsigned long n, int base = DEC);
+	size_t print(double n, int digits = 2);
+
+	size_t println() { return write("\r\n"); }
+	template <typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+	template <typename T> size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+};
+
+class Stream : public Print {
+public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+	virtual void flush() = 0;
+};
+
+/* Serial writes to the standard output and reads from the standard input */
+class HardwareSerial : public Stream {
+public:
+	void begin(unsigned long baud) {}
+	void end() {}
+	size_t write(uint8_t c) { return (putchar(c) == EOF) ? 0 : 1; }
+	using Print::write;
+	int available();
+	int read();
+	int peek();
+	void flush() { fflush(stdout); }
+};
+
+extern HardwareSerial Serial;
+
+#endif
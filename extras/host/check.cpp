@@ -0,0 +1,353 @@
+/*
+* Checks Calduino on a PC against the EMS Bus simulator: the asynchronous transactions (submit,
+* poll and getStatus), their priorities, also with short replies and among the polls of other EMS
+* devices, the discovery of the EMS devices, the reception of EMS frames in the RX interrupt,
+* replaying a capture of the simulated EMS Bus byte by byte through the USART1 RX vector, and the
+* circuit breakers of the EMS devices. The exit status is the number of checks failed.
+*/
+
+#include <EMSBusSimulator.h>
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+#define CHECK_POLL_LIMIT 20000
+#define CAPTURE_FRAMES 64
+#define CAPTURE_READS 4
+#define TRUNCATE_MIN_LENGTH 6
+#define PROGRAM_BUFFER_SIZE 105
+#define CHECK_CHUNK_POLLS 100
+#define CHECK_BREAKER_FAILURES 3
+
+/**
+ * Simulator that records the frames received by Calduino, like a sniffer on the EMS Bus. It can
+ * also cut the reply to the offset truncateOffset of the message truncateMessageID, once.
+ */
+class RecordingSimulator : public EMSBusSimulator {
+public:
+	SimulatorFrame capture[CAPTURE_FRAMES];
+	bool captureCRC[CAPTURE_FRAMES];
+	byte captured;
+	byte truncateMessageID;
+	byte truncateOffset;
+
+	RecordingSimulator() : captured(0), truncateMessageID(ERROR_VALUE), truncateOffset(ERROR_VALUE) {}
+
+	int readFrame(byte *buffer, byte len, bool *crcOK = NULL)
+	{
+		bool frameCRC;
+		int ret = EMSBusSimulator::readFrame(buffer, len, &frameCRC);
+
+		// a valid reply with half of its data bytes
+		if ((ret > TRUNCATE_MIN_LENGTH) && frameCRC && (buffer[1] == DeviceID::PC) && (buffer[2] == truncateMessageID) &&
+			(buffer[3] == truncateOffset))
+		{
+			ret -= (ret - TRUNCATE_MIN_LENGTH) / 2;
+			buffer[ret - 2] = 0;
+			for (byte i = 0; i < ret - 2; i++) buffer[ret - 2] = crc_update(buffer[ret - 2], buffer[i]);
+			buffer[ret - 1] = 0;
+			truncateOffset = ERROR_VALUE;
+		}
+
+		if ((ret > 0) && (captured < CAPTURE_FRAMES))
+		{
+			capture[captured].length = ret;
+			memcpy(capture[captured].data, buffer, ret);
+			captureCRC[captured++] = frameCRC;
+		}
+		if (crcOK != NULL) *crcOK = frameCRC;
+		return ret;
+	}
+};
+
+RecordingSimulator simulator;
+Calduino calduino;
+int failures = 0;
+byte callbacks = 0;
+boolean callbackSuccess = true;
+byte callbackOrder[2];
+
+void check(boolean condition, const char *expression, int line)
+{
+	if (condition) return;
+	printf("check.cpp:%d: %s failed\n", line, expression);
+	failures++;
+}
+
+void onTransaction(byte handle, boolean success, void *context)
+{
+	callbacks++;
+	callbackSuccess = callbackSuccess && success;
+	CHECK(context == &simulator);
+}
+
+/** Record the order of the callbacks, the context is the transaction submitted. */
+void onOrderedTransaction(byte handle, boolean success, void *context)
+{
+	if (callbacks < sizeof(callbackOrder)) callbackOrder[callbacks] = *(byte *)context;
+	callbacks++;
+	callbackSuccess = callbackSuccess && success;
+}
+
+/** Poll Calduino until the expected number of callbacks, or until the limit of polls. */
+void pollCallbacks(byte expected)
+{
+	for (int i = 0; (callbacks < expected) && (i < CHECK_POLL_LIMIT); i++)
+	{
+		calduino.poll();
+	}
+}
+
+/** Poll Calduino until the transaction without callback finishes, or until the limit of polls. */
+TransactionStatus pollStatus(byte handle)
+{
+	TransactionStatus status = calduino.getStatus(handle);
+
+	for (int i = 0; ((status == TransactionStatus::Pending) || (status == TransactionStatus::Running)) && (i < CHECK_POLL_LIMIT); i++)
+	{
+		calduino.poll();
+		status = calduino.getStatus(handle);
+	}
+
+	return status;
+}
+
+void checkTransactions()
+{
+	byte inEMSBuffer[EMS_CACHE_BUFFER_SIZE];
+	byte handle;
+
+	// a read succeeds, its result is kept until read and its values are those of the UBA
+	handle = calduino.submit(inEMSBuffer, EMSDatagramID::UBA_Monitor_Fast);
+	CHECK(handle != ERROR_VALUE);
+	CHECK(calduino.getStatus(handle) == TransactionStatus::Pending);
+	CHECK(pollStatus(handle) == TransactionStatus::Succeeded);
+	CHECK(calduino.getStatus(handle) == TransactionStatus::Free);
+	CHECK(memcmp(&inEMSBuffer[4], simulator.getMessage(EMSDatagramID::UBA_Monitor_Fast), 8) == 0);
+
+	// a write changes the memory of the UBA, its slot is freed before its callback
+	callbacks = 0;
+	callbackSuccess = true;
+	handle = calduino.submit(EMSDatagramID::UBA_Parameter_DHW, DatagramDataIndex::selTempDHWIdx, 55, onTransaction, &simulator);
+	CHECK(handle != ERROR_VALUE);
+	pollCallbacks(1);
+	CHECK((callbacks == 1) && callbackSuccess);
+	CHECK(calduino.getStatus(handle) == TransactionStatus::Free);
+	CHECK(calduino.getCalduinoByteValue(ByteRequest::selTempDHW_b) == 55);
+
+	// a read of an absent EMS device fails
+	simulator.absentDeviceID = DeviceID::MM_10;
+	handle = calduino.submit(inEMSBuffer, EMSDatagramID::Monitor_MM_10);
+	CHECK(pollStatus(handle) == TransactionStatus::Failed);
+	simulator.absentDeviceID = ERROR_VALUE;
+
+	// pipelined reads on a noisy EMS Bus all succeed
+	byte buffers[3][EMS_CACHE_BUFFER_SIZE];
+	calduino.pipelineDepth = 3;
+	simulator.crcErrorRate = 20;
+	callbacks = 0;
+	callbackSuccess = true;
+	calduino.submit(buffers[0], EMSDatagramID::RC_Datetime, onTransaction, &simulator);
+	calduino.submit(buffers[1], EMSDatagramID::UBA_Monitor_Slow, onTransaction, &simulator);
+	calduino.submit(buffers[2], EMSDatagramID::Working_Mode_HC_1, onTransaction, &simulator);
+	pollCallbacks(3);
+	CHECK((callbacks == 3) && callbackSuccess);
+	simulator.crcErrorRate = 0;
+	calduino.pipelineDepth = 1;
+}
+
+void checkPriorities()
+{
+	byte program[PROGRAM_BUFFER_SIZE];
+	byte buffers[CALDUINO_TRANSACTIONS][EMS_CACHE_BUFFER_SIZE];
+	byte background = 0, write = 1;
+	byte handles[CALDUINO_TRANSACTIONS];
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, eMSDatagramIDs[EMSDatagramID::Program_1_HC_1], sizeof(EMSDatagram));
+
+	// the background reads never take the last free slots, a get command can still take it
+	handles[0] = calduino.submit(buffers[0], EMSDatagramID::UBA_Monitor_Fast, NULL, NULL, TransactionPriority::BackgroundRead);
+	handles[1] = calduino.submit(buffers[1], EMSDatagramID::UBA_Monitor_Slow, NULL, NULL, TransactionPriority::BackgroundRead);
+	handles[2] = calduino.submit(buffers[2], EMSDatagramID::RC_Datetime, NULL, NULL, TransactionPriority::BackgroundRead);
+	CHECK((handles[0] != ERROR_VALUE) && (handles[1] != ERROR_VALUE) && (handles[2] != ERROR_VALUE));
+	CHECK(calduino.submit(buffers[3], EMSDatagramID::Monitor_HC_1, NULL, NULL, TransactionPriority::BackgroundRead) == ERROR_VALUE);
+	handles[3] = calduino.submit(buffers[3], EMSDatagramID::Monitor_HC_1);
+	CHECK(handles[3] != ERROR_VALUE);
+	for (byte i = 0; i < CALDUINO_TRANSACTIONS; i++) CHECK(pollStatus(handles[i]) == TransactionStatus::Succeeded);
+
+	// a set command submitted while a background read waits between chunks goes first
+#ifdef CALDUINO_STATS
+	uint16_t preemptions = calduino.getStats().preemptions;
+#endif
+	memset(program, 0xEE, sizeof(program));
+	callbacks = 0;
+	callbackSuccess = true;
+	unsigned long commands = simulator.commands;
+	CHECK(calduino.submit(program, EMSDatagramID::Program_1_HC_1, onOrderedTransaction, &background, TransactionPriority::BackgroundRead) != ERROR_VALUE);
+	for (int i = 0; (simulator.commands == commands) && (i < CHECK_POLL_LIMIT); i++) calduino.poll();
+	for (int i = 0; i < CHECK_CHUNK_POLLS; i++) calduino.poll();
+	CHECK(calduino.submit(EMSDatagramID::UBA_Parameter_DHW, DatagramDataIndex::selTempDHWIdx, 60, onOrderedTransaction, &write) != ERROR_VALUE);
+	pollCallbacks(2);
+	CHECK((callbacks == 2) && callbackSuccess);
+	CHECK((callbackOrder[0] == write) && (callbackOrder[1] == background));
+#ifdef CALDUINO_STATS
+	CHECK(calduino.getStats().preemptions == preemptions + 1);
+#endif
+
+	// the preempted read resumes from its missing chunks and completes the program
+	CHECK(memcmp(&program[4], simulator.getMessage(EMSDatagramID::Program_1_HC_1), eMSDatagram.messageLength) == 0);
+	CHECK(calduino.getCalduinoByteValue(ByteRequest::selTempDHW_b) == 60);
+}
+
+void checkShortReply()
+{
+	byte program[PROGRAM_BUFFER_SIZE];
+	EMSDatagram eMSDatagram;
+	memcpy_P(&eMSDatagram, eMSDatagramIDs[EMSDatagramID::Program_1_HC_1], sizeof(EMSDatagram));
+
+	// a reply shorter than its chunk is requested again, no stale byte is left in the buffer
+	memset(program, 0xEE, sizeof(program));
+	simulator.truncateMessageID = eMSDatagram.messageID;
+	simulator.truncateOffset = 0;
+	byte handle = calduino.submit(program, EMSDatagramID::Program_1_HC_1);
+	CHECK(pollStatus(handle) == TransactionStatus::Succeeded);
+	CHECK(simulator.truncateOffset == ERROR_VALUE);
+	CHECK(memcmp(&program[4], simulator.getMessage(EMSDatagramID::Program_1_HC_1), eMSDatagram.messageLength) == 0);
+	simulator.truncateMessageID = ERROR_VALUE;
+}
+
+void checkDiscovery()
+{
+	// a quiet Bus Master does not make the EMS devices absent, they are found once it polls again
+	simulator.pollDropRate = 100;
+	calduino.discoverDevices();
+	simulator.pollDropRate = 0;
+	CHECK(calduino.getDevice(DeviceID::UBA)->status != DeviceStatus::Absent);
+	CHECK(calduino.getDevice(DeviceID::RC_35)->status != DeviceStatus::Absent);
+	CHECK(calduino.getDevice(DeviceID::MM_10)->status == DeviceStatus::Unknown);
+	CHECK(calduino.getCalduinoByteValue(ByteRequest::selImpTemp_b) != ERROR_VALUE);
+
+	// the EMS devices that do not answer the query are absent
+	simulator.absentDeviceID = DeviceID::MM_10;
+	calduino.discoverDevices();
+	simulator.absentDeviceID = ERROR_VALUE;
+	CHECK(calduino.getDevice(DeviceID::UBA)->status == DeviceStatus::Present);
+	CHECK(calduino.getDevice(DeviceID::MM_10)->status == DeviceStatus::Absent);
+}
+
+void checkForeignPolls()
+{
+	unsigned long commands = simulator.commands;
+
+	// the polls of other EMS devices while the set command waits for its slow acknowledge are ignored
+	simulator.pollInterval = 100;
+	simulator.slowDeviceID = DeviceID::UBA;
+	simulator.slowDeviceDelay = 60;
+	simulator.foreignPollDeviceID = DeviceID::RC_35;
+	CHECK(calduino.setTemperatureDHW(50));
+	CHECK(simulator.commands - commands == 2);
+	CHECK(calduino.getCalduinoByteValue(ByteRequest::selTempDHW_b) == 50);
+	simulator.foreignPollDeviceID = ERROR_VALUE;
+	simulator.slowDeviceID = ERROR_VALUE;
+	simulator.pollInterval = SIMULATOR_POLL_INTERVAL;
+}
+
+void checkCaptureReplay()
+{
+	byte buffer[SERIAL_BUFFER_SIZE];
+	byte wrongCRC = 0;
+	bool crcOK;
+
+	// record the frames of a few reads, some of them with wrong CRC
+	simulator.captured = 0;
+	simulator.crcErrorRate = 30;
+	for (byte i = 0; i < CAPTURE_READS; i++)
+	{
+		calduino.getCalduinoByteValue(ByteRequest::selTempDHW_b);
+		calduino.getCalduinoUlongValue(ULongRequest::burnStarts_ul);
+	}
+	simulator.crcErrorRate = 0;
+	CHECK(simulator.captured > 4);
+
+	// replay them through the RX interrupt, the break is a 0 with a framing error
+	for (byte i = 0; i < simulator.captured; i++)
+	{
+		SimulatorFrame *frame = &simulator.capture[i];
+		for (byte j = 0; j < frame->length; j++)
+		{
+			UCSR1A = (j == frame->length - 1) ? _BV(FE1) : 0;
+			UDR1 = frame->data[j];
+			USART1_RX_vect();
+		}
+
+		CHECK(EMSSerial1.frameAvailable() == 1);
+		CHECK(EMSSerial1.readFrame(buffer, sizeof(buffer), &crcOK) == frame->length);
+		CHECK(memcmp(buffer, frame->data, frame->length) == 0);
+		CHECK(crcOK == simulator.captureCRC[i]);
+		if ((frame->length > 2) && !crcOK) wrongCRC++;
+	}
+	CHECK(wrongCRC > 0);
+
+	// a lone break is not a frame
+	UCSR1A = _BV(FE1);
+	UDR1 = 0;
+	USART1_RX_vect();
+	CHECK(EMSSerial1.frameAvailable() == 0);
+}
+
+/** Advance the EMS Bus until the backoff of the open breaker of the EMS device expires. */
+void waitProbeTime(const EMSDevice *device)
+{
+	while ((long)(simulator.getMillis() - device->probeTime) < 0)
+	{
+		simulator.advance(100);
+		calduino.poll();
+	}
+}
+
+void checkBreaker()
+{
+	const EMSDevice *uba = calduino.getDevice(DeviceID::UBA);
+
+	// the transactions never polled by the Bus Master are not failures of the EMS device
+	simulator.pollDropRate = 100;
+	for (byte i = 0; i < CHECK_BREAKER_FAILURES; i++) calduino.getCalduinoByteValue(ByteRequest::selImpTemp_b);
+	simulator.pollDropRate = 0;
+	CHECK((uba->breaker == BreakerState::Closed) && (uba->failures == 0));
+
+	// the EMS Commands sent and not answered open the breaker
+	simulator.absentDeviceID = DeviceID::UBA;
+	for (byte i = 0; i < CHECK_BREAKER_FAILURES; i++) calduino.getCalduinoByteValue(ByteRequest::selImpTemp_b);
+	CHECK((uba->breaker == BreakerState::Open) && (uba->failures == CHECK_BREAKER_FAILURES));
+	unsigned long backoff = uba->backoff;
+
+	// a probe never polled neither extends the backoff nor keeps the breaker half open
+	waitProbeTime(uba);
+	simulator.pollDropRate = 100;
+	calduino.getCalduinoByteValue(ByteRequest::selImpTemp_b);
+	simulator.pollDropRate = 0;
+	CHECK((uba->breaker == BreakerState::Open) && (uba->backoff == backoff));
+
+	// a probe not answered doubles the backoff, an answered one closes the breaker
+	calduino.getCalduinoByteValue(ByteRequest::selImpTemp_b);
+	CHECK((uba->breaker == BreakerState::Open) && (uba->backoff == 2 * backoff));
+	simulator.absentDeviceID = ERROR_VALUE;
+	waitProbeTime(uba);
+	CHECK(calduino.getCalduinoByteValue(ByteRequest::selImpTemp_b) != ERROR_VALUE);
+	CHECK((uba->breaker == BreakerState::Closed) && (uba->failures == 0));
+}
+
+int main()
+{
+	simulator.begin(1);
+	calduino.begin(&simulator);
+
+	checkTransactions();
+	checkPriorities();
+	checkShortReply();
+	checkDiscovery();
+	checkForeignPolls();
+	checkCaptureReplay();
+	checkBreaker();
+
+	printf("%s: %d checks failed\n", (failures == 0) ? "OK" : "FAILED", failures);
+	return failures;
+}
@@ -0,0 +1,185 @@
+/*
+* Checks on a PC that the EMS CRC variants give identical results: the bitwise calculation used
+* originally by Calduino, the PROGMEM lookup table (crc_update) and the incremental CRC calculated
+* by the RX interrupt (store_char) while the bytes of a frame arrive. The telegrams are random
+* ones, telegrams captured on a real EMS Bus and the frames of the simulated EMS Bus, each of them
+* also with a corrupted CRC. It prints the nanoseconds per byte of each variant on the PC (the
+* CalduinoCRCBenchmark example measures the cycles on the board). The exit status is the number
+* of mismatches.
+*/
+
+#include <EMSBusSimulator.h>
+#include <chrono>
+
+#define RANDOM_TELEGRAMS 10000
+#define RANDOM_SEED 1
+#define SIMULATED_FRAMES 64
+#define BENCHMARK_LOOPS 10000
+
+/** Telegrams captured on the EMS Bus, the last byte is the CRC. */
+const byte rcDatetime[] = { 0x10, 0x0B, 0x06, 0x00, 0x12, 0x04, 0x0F, 0x0B, 0x1E, 0x05, 0x03, 0x00, 0x44 };
+const byte uBAMonitorFast[] = { 0x08, 0x00, 0x18, 0x00, 0x2D, 0x00, 0x12, 0x64, 0x01, 0xC3, 0x00, 0x00, 0x00, 0x01, 0x58, 0x00,
+	0x00, 0x21, 0x43, 0x80, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x02, 0x34, 0x00, 0xCB, 0x57 };
+const byte rcDatetimeRequest[] = { 0x0B, 0x90, 0x06, 0x00, 0x14, 0x58 };
+const byte uBAWorkingTime[] = { 0x08, 0x0B, 0x14, 0x00, 0x00, 0x0A, 0x2B, 0xF0, 0xAA };
+
+const byte *capturedTelegrams[] = { rcDatetime, uBAMonitorFast, rcDatetimeRequest, uBAWorkingTime };
+const byte capturedLengths[] = { sizeof(rcDatetime), sizeof(uBAMonitorFast), sizeof(rcDatetimeRequest), sizeof(uBAWorkingTime) };
+
+/** Simulator that keeps the telegrams of the frames received by Calduino (CRC included, break removed). */
+class RecordingSimulator : public EMSBusSimulator {
+public:
+	SimulatorFrame capture[SIMULATED_FRAMES];
+	byte captured;
+
+	int readFrame(byte *buffer, byte len, bool *crcOK = NULL)
+	{
+		int ret = EMSBusSimulator::readFrame(buffer, len, crcOK);
+		if ((ret > 2) && (captured < SIMULATED_FRAMES))
+		{
+			capture[captured].length = ret - 1;
+			memcpy(capture[captured++].data, buffer, ret - 1);
+		}
+		return ret;
+	}
+};
+
+RecordingSimulator simulator;
+Calduino calduino;
+unsigned long telegrams = 0;
+int mismatches = 0;
+
+/** Bitwise CRC, as calculated originally by Calduino. */
+uint8_t bitwiseCRC(const byte *telegram, byte len)
+{
+	uint8_t crc = 0, d;
+	for (byte i = 0; i < len; i++)
+	{
+		d = 0;
+		if (crc & 0x80)
+		{
+			crc ^= 12;
+			d = 1;
+		}
+		crc = (crc << 1) & 0xfe;
+		crc |= d;
+		crc ^= telegram[i];
+	}
+	return crc;
+}
+
+/** Table driven CRC. */
+uint8_t tableCRC(const byte *telegram, byte len)
+{
+	uint8_t crc = 0;
+	for (byte i = 0; i < len; i++)
+	{
+		crc = crc_update(crc, telegram[i]);
+	}
+	return crc;
+}
+
+/** Feed a telegram (CRC included) and its break to the RX path and return whether its CRC was correct. */
+bool incrementalCRC(const byte *telegram, byte len)
+{
+	byte buffer[SERIAL_BUFFER_SIZE];
+	bool crcOK = false;
+
+	for (byte i = 0; i < len; i++)
+	{
+		store_char(telegram[i], false, &EMSSerial2);
+	}
+	store_char(0, true, &EMSSerial2);
+
+	EMSSerial2.readFrame(buffer, sizeof(buffer), &crcOK);
+	return crcOK;
+}
+
+/** Check that the three variants agree on a telegram whose last byte is the CRC, and on a corrupted copy. */
+void checkTelegram(const byte *telegram, byte len, const char *source)
+{
+	byte corrupted[SERIAL_BUFFER_SIZE];
+
+	for (byte c = 0; c < 2; c++)
+	{
+		memcpy(corrupted, telegram, len);
+		corrupted[len - 1] ^= c;
+
+		uint8_t crc = bitwiseCRC(corrupted, len - 1);
+		telegrams++;
+
+		if ((tableCRC(corrupted, len - 1) != crc) || (incrementalCRC(corrupted, len) != (corrupted[len - 1] == crc)))
+		{
+			printf("%s telegram of %d bytes: CRC mismatch\n", source, len);
+			mismatches++;
+		}
+	}
+}
+
+/** Print the nanoseconds per byte of a CRC variant over the captured telegrams. */
+void benchmark(const char *name, uint8_t (*crc)(const byte *, byte))
+{
+	unsigned long bytes = 0;
+	volatile uint8_t sink = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int l = 0; l < BENCHMARK_LOOPS; l++)
+	{
+		for (byte t = 0; t < sizeof(capturedLengths); t++)
+		{
+			sink ^= crc(capturedTelegrams[t], capturedLengths[t]);
+			bytes += capturedLengths[t];
+		}
+	}
+
+	double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	printf("%s: %.2f ns/byte\n", name, ns / bytes);
+}
+
+int main()
+{
+	byte telegram[SERIAL_BUFFER_SIZE];
+
+	// the captured telegrams must also have a correct CRC
+	for (byte t = 0; t < sizeof(capturedLengths); t++)
+	{
+		if (bitwiseCRC(capturedTelegrams[t], capturedLengths[t] - 1) != capturedTelegrams[t][capturedLengths[t] - 1])
+		{
+			printf("captured telegram %d: wrong CRC\n", t);
+			mismatches++;
+		}
+		checkTelegram(capturedTelegrams[t], capturedLengths[t], "captured");
+	}
+
+	// the frames of the simulated EMS Bus: polls, replies and broadcasts
+	simulator.begin(RANDOM_SEED);
+	calduino.begin(&simulator);
+	simulator.captured = 0;
+	calduino.printEMSDatagram(EMSDatagramID::Program_1_HC_1);
+	calduino.printEMSDatagram(EMSDatagramID::UBA_Monitor_Fast);
+	calduino.getCalduinoByteValue(ByteRequest::selTempDHW_b);
+	for (byte f = 0; f < simulator.captured; f++)
+	{
+		checkTelegram(simulator.capture[f].data, simulator.capture[f].length, "simulated");
+	}
+	if (simulator.captured == 0)
+	{
+		printf("no frame received from the simulated EMS Bus\n");
+		mismatches++;
+	}
+
+	// random telegrams of random length, up to the longest frame of the EMS Bus
+	srand(RANDOM_SEED);
+	for (int t = 0; t < RANDOM_TELEGRAMS; t++)
+	{
+		byte len = 3 + rand() % (MAX_EMS_READ - 3);
+		for (byte i = 0; i < len; i++) telegram[i] = rand();
+		checkTelegram(telegram, len, "random");
+	}
+
+	benchmark("Bitwise", bitwiseCRC);
+	benchmark("Table", tableCRC);
+
+	printf("%s: %d mismatches in %lu telegrams\n", (mismatches == 0) ? "OK" : "FAILED", mismatches, telegrams);
+	return mismatches;
+}
@@ -0,0 +1,62 @@
+/*
+* Reads the telemetry records printed by Calduino in Binary print format from the standard input
+* and prints them, one per line, as JSON or in the print format given. The exit status is the
+* number of bytes skipped because they did not start a valid record.
+*
+* Usage: decode [standard|nounit|xml|json] < records
+*/
+
+#include <CalduinoTelemetry.h>
+
+#define DECODE_BUFFER_SIZE 255
+
+int main(int argc, char *argv[])
+{
+	PrintFormat format = PrintFormat::JSON;
+	CalduinoSerializer serializer;
+	byte buffer[DECODE_BUFFER_SIZE];
+	byte length = 0;
+	boolean eof = false;
+	int skipped = 0;
+
+	if (argc > 1)
+	{
+		if (strcmp(argv[1], "standard") == 0) format = PrintFormat::Standard;
+		else if (strcmp(argv[1], "nounit") == 0) format = PrintFormat::NoUnit;
+		else if (strcmp(argv[1], "xml") == 0) format = PrintFormat::XML;
+		else if (strcmp(argv[1], "json") != 0)
+		{
+			fprintf(stderr, "usage: %s [standard|nounit|xml|json] < records\n", argv[0]);
+			return -1;
+		}
+	}
+
+	serializer.begin(&Serial, &format);
+
+	while (true)
+	{
+		// keep the buffer full, a record never exceeds it
+		while (!eof && (length < DECODE_BUFFER_SIZE))
+		{
+			int c = Serial.read();
+			if (c < 0) eof = true;
+			else buffer[length++] = c;
+		}
+
+		if (length == 0) break;
+
+		byte recordLength = printTelemetryRecord(buffer, length, &serializer);
+		if (recordLength == 0)
+		{
+			// malformed or truncated, resynchronize on the next byte
+			recordLength = 1;
+			skipped++;
+		}
+
+		length -= recordLength;
+		memmove(buffer, buffer + recordLength, length);
+	}
+
+	Serial.flush();
+	return skipped;
+}
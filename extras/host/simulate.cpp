@@ -0,0 +1,46 @@
+/*
+* Runs Calduino against the EMS Bus simulator on a PC and prints every EMS Datagram, as text or
+* as binary telemetry records (-b) to be read by decode. The counters of the simulated EMS Bus
+* are printed on the standard error. The exit status is the number of EMS Datagrams not read.
+*
+* Usage: simulate [-b] [seed [crcErrorRate [pollDropRate [replyDropRate]]]]
+*/
+
+#include <Calduino.h>
+#include <EMSBusSimulator.h>
+
+EMSBusSimulator simulator;
+Calduino calduino;
+
+int main(int argc, char *argv[])
+{
+	boolean binary = (argc > 1) && (strcmp(argv[1], "-b") == 0);
+	int failures = 0;
+
+	if (binary)
+	{
+		argc--;
+		argv++;
+	}
+
+	unsigned long seed = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1;
+
+	simulator.crcErrorRate = (argc > 2) ? atoi(argv[2]) : 0;
+	simulator.pollDropRate = (argc > 3) ? atoi(argv[3]) : 0;
+	simulator.replyDropRate = (argc > 4) ? atoi(argv[4]) : 0;
+	simulator.begin(seed);
+	calduino.begin(&simulator, &Serial);
+	if (binary) calduino.printFormat = PrintFormat::Binary;
+
+	for (int i = 0; i < EMS_DATAGRAMS; i++)
+	{
+		if (!calduino.printEMSDatagram((EMSDatagramID)i)) failures++;
+		if (!binary) Serial.println();
+	}
+
+	Serial.flush();
+	fprintf(stderr, "bus_ms=%lu polls=%lu commands=%lu telegrams=%lu bus_bytes=%lu failures=%d\n",
+		simulator.getMillis(), simulator.polls, simulator.commands, simulator.telegrams, simulator.busBytes, failures);
+
+	return failures;
+}
@@ -0,0 +1,17 @@
+/*
+* Minimal Arduino core for building Calduino on a PC (see Arduino.h).
+*/
+
+#ifndef WiringPrivate_h
+#define WiringPrivate_h
+
+#include "Arduino.h"
+
+#ifndef cbi
+#define cbi(sfr, bit) (sfr &= ~_BV(bit))
+#endif
+#ifndef sbi
+#define sbi(sfr, bit) (sfr |= _BV(bit))
+#endif
+
+#endif